@@ -5,28 +5,109 @@
 
 # Add inputs and outputs from these tool invocations to the build variables 
 C_SRCS += \
+../Src/active.c \
+../Src/boot.c \
+../Src/budget.c \
+../Src/coroutine.c \
+../Src/crash.c \
+../Src/dsp.c \
+../Src/dsp_bench.c \
+../Src/dvfs.c \
+../Src/idle.c \
+../Src/irq.c \
 ../Src/it.c \
+../Src/latency_bench.c \
 ../Src/led.c \
+../Src/libc.c \
 ../Src/main.c \
+../Src/mempool.c \
+../Src/notify.c \
+../Src/notify_bench.c \
 ../Src/queue.c \
+../Src/queueset.c \
+../Src/record.c \
+../Src/sched.c \
+../Src/semaphore.c \
+../Src/snapshot.c \
+../Src/snapshot_bench.c \
+../Src/streambuf.c \
 ../Src/syscalls.c \
-../Src/sysmem.c 
+../Src/sysmem.c \
+../Src/task.c \
+../Src/tlsf.c \
+../Src/uart.c \
+../Src/workqueue.c \
+../Src/yield_bench.c 
 
 OBJS += \
+./Src/active.o \
+./Src/boot.o \
+./Src/budget.o \
+./Src/coroutine.o \
+./Src/crash.o \
+./Src/dsp.o \
+./Src/dsp_bench.o \
+./Src/dvfs.o \
+./Src/idle.o \
+./Src/irq.o \
 ./Src/it.o \
+./Src/latency_bench.o \
 ./Src/led.o \
+./Src/libc.o \
 ./Src/main.o \
+./Src/mempool.o \
+./Src/notify.o \
+./Src/notify_bench.o \
 ./Src/queue.o \
+./Src/queueset.o \
+./Src/record.o \
+./Src/sched.o \
+./Src/semaphore.o \
+./Src/snapshot.o \
+./Src/snapshot_bench.o \
+./Src/streambuf.o \
 ./Src/syscalls.o \
-./Src/sysmem.o 
+./Src/sysmem.o \
+./Src/task.o \
+./Src/tlsf.o \
+./Src/uart.o \
+./Src/workqueue.o \
+./Src/yield_bench.o 
 
 C_DEPS += \
+./Src/active.d \
+./Src/boot.d \
+./Src/budget.d \
+./Src/coroutine.d \
+./Src/crash.d \
+./Src/dsp.d \
+./Src/dsp_bench.d \
+./Src/dvfs.d \
+./Src/idle.d \
+./Src/irq.d \
 ./Src/it.d \
+./Src/latency_bench.d \
 ./Src/led.d \
+./Src/libc.d \
 ./Src/main.d \
+./Src/mempool.d \
+./Src/notify.d \
+./Src/notify_bench.d \
 ./Src/queue.d \
+./Src/queueset.d \
+./Src/record.d \
+./Src/sched.d \
+./Src/semaphore.d \
+./Src/snapshot.d \
+./Src/snapshot_bench.d \
+./Src/streambuf.d \
 ./Src/syscalls.d \
-./Src/sysmem.d 
+./Src/sysmem.d \
+./Src/task.d \
+./Src/tlsf.d \
+./Src/uart.d \
+./Src/workqueue.d \
+./Src/yield_bench.d 
 
 
 # Each subdirectory must supply rules for building sources it contributes
@@ -36,7 +117,7 @@ Src/%.o Src/%.su: ../Src/%.c Src/subdir.mk
 clean: clean-Src
 
 clean-Src:
-	-$(RM) ./Src/it.d ./Src/it.o ./Src/it.su ./Src/led.d ./Src/led.o ./Src/led.su ./Src/main.d ./Src/main.o ./Src/main.su ./Src/queue.d ./Src/queue.o ./Src/queue.su ./Src/syscalls.d ./Src/syscalls.o ./Src/syscalls.su ./Src/sysmem.d ./Src/sysmem.o ./Src/sysmem.su
+	-$(RM) ./Src/active.d ./Src/active.o ./Src/active.su ./Src/boot.d ./Src/boot.o ./Src/boot.su ./Src/budget.d ./Src/budget.o ./Src/budget.su ./Src/coroutine.d ./Src/coroutine.o ./Src/coroutine.su ./Src/crash.d ./Src/crash.o ./Src/crash.su ./Src/dsp.d ./Src/dsp.o ./Src/dsp.su ./Src/dsp_bench.d ./Src/dsp_bench.o ./Src/dsp_bench.su ./Src/dvfs.d ./Src/dvfs.o ./Src/dvfs.su ./Src/idle.d ./Src/idle.o ./Src/idle.su ./Src/irq.d ./Src/irq.o ./Src/irq.su ./Src/it.d ./Src/it.o ./Src/it.su ./Src/latency_bench.d ./Src/latency_bench.o ./Src/latency_bench.su ./Src/led.d ./Src/led.o ./Src/led.su ./Src/libc.d ./Src/libc.o ./Src/libc.su ./Src/main.d ./Src/main.o ./Src/main.su ./Src/mempool.d ./Src/mempool.o ./Src/mempool.su ./Src/notify.d ./Src/notify.o ./Src/notify.su ./Src/notify_bench.d ./Src/notify_bench.o ./Src/notify_bench.su ./Src/queue.d ./Src/queue.o ./Src/queue.su ./Src/queueset.d ./Src/queueset.o ./Src/queueset.su ./Src/record.d ./Src/record.o ./Src/record.su ./Src/sched.d ./Src/sched.o ./Src/sched.su ./Src/semaphore.d ./Src/semaphore.o ./Src/semaphore.su ./Src/snapshot.d ./Src/snapshot.o ./Src/snapshot.su ./Src/snapshot_bench.d ./Src/snapshot_bench.o ./Src/snapshot_bench.su ./Src/streambuf.d ./Src/streambuf.o ./Src/streambuf.su ./Src/syscalls.d ./Src/syscalls.o ./Src/syscalls.su ./Src/sysmem.d ./Src/sysmem.o ./Src/sysmem.su ./Src/task.d ./Src/task.o ./Src/task.su ./Src/tlsf.d ./Src/tlsf.o ./Src/tlsf.su ./Src/uart.d ./Src/uart.o ./Src/uart.su ./Src/workqueue.d ./Src/workqueue.o ./Src/workqueue.su ./Src/yield_bench.d ./Src/yield_bench.o ./Src/yield_bench.su
 
 .PHONY: clean-Src
 
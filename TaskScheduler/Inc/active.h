@@ -0,0 +1,91 @@
+/**
+ ******************************************************************************
+ * @file           : active.h
+ * @author         : Noam Yakar
+ * @brief          : Header file of the active objects module. This file contains
+ * 					 macros, structures definitions and functions prototypes.
+ ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion ---------------------------------*/
+
+#ifndef ACTIVE_H_
+#define ACTIVE_H_
+
+/* Includes ----------------------------------------------------------------- */
+
+#include "main.h"
+
+/* Macros ------------------------------------------------------------------- */
+
+/* Number of active object priorities. Each active object has a unique priority, a higher value is
+ * more urgent */
+#define ACTIVE_MAX_PRIORITY      32U
+
+/* Reserved signals. Application signals start at ACTIVE_SIG_USER */
+#define ACTIVE_SIG_INIT          0U        /* First event dispatched to every active object */
+#define ACTIVE_SIG_USER          1U
+
+/* Period of a one-shot time event */
+#define ACTIVE_ONE_SHOT          0U
+
+/* Types -------------------------------------------------------------------- */
+
+/* Active objects functions status */
+typedef enum
+{
+	ACTIVE_OK,                     /*!< The object was started or the event was posted */
+	ACTIVE_FULL,                   /*!< The object's event queue is full, the event was dropped */
+	ACTIVE_INVALID                 /*!< Invalid queue size, or the priority is taken */
+} ActiveStatus_e;
+
+/* Event structure definition. Events are copied into the object's event queue */
+typedef struct
+{
+	uint32_t signal;                /*!< Specifies what happened, ACTIVE_SIG_INIT or an application signal */
+	uint32_t param;                 /*!< Event parameter, its meaning depends on the signal */
+} ActiveEvent_t;
+
+struct ActiveObject;
+
+/* Dispatch function of an active object. Runs each event to completion and must not block */
+typedef void (*ActiveDispatch_t)(struct ActiveObject *pAo, const ActiveEvent_t *pEvent);
+
+/* Active object structure definition. An event-driven state machine with its own event queue,
+ * dispatched by the active objects task. */
+typedef struct ActiveObject
+{
+	uint8_t priority;               /*!< Specifies the object's priority, 0 to ACTIVE_MAX_PRIORITY - 1 */
+	ActiveEvent_t *queue;           /*!< Pointer to the event queue storage */
+	uint32_t size;                  /*!< Number of events the queue can hold, a power of 2 */
+	volatile uint32_t head;         /*!< Next position to be written by Active_Post() */
+	volatile uint32_t tail;         /*!< Next position to be dispatched */
+	volatile uint32_t dropped;      /*!< Number of events dropped because the queue was full */
+	ActiveDispatch_t dispatch;      /*!< Pointer to the object's dispatch function */
+	void *context;                  /*!< Pointer to the object's private data, the state machine's state */
+} ActiveObject_t;
+
+/* Time event structure definition. Posts its signal to an active object when it expires. */
+typedef struct ActiveTimeEvent
+{
+	ActiveObject_t *target;         /*!< Pointer to the active object the signal is posted to */
+	uint32_t signal;                /*!< Specifies the signal posted on expiry */
+	uint32_t expire_tick;           /*!< Specifies the tick count the time event expires at */
+	uint32_t period;                /*!< Specifies the re-arm period in ticks, or ACTIVE_ONE_SHOT */
+	uint8_t armed;                  /*!< 1 while the time event is in the armed list */
+	struct ActiveTimeEvent *next;   /*!< Pointer to the next armed time event */
+} ActiveTimeEvent_t;
+
+/* Functions prototypes ------------------------------------------------------ */
+
+ActiveStatus_e Active_Start(ActiveObject_t *pAo, uint8_t Priority, ActiveEvent_t *pQueue, uint32_t QueueSize,
+		ActiveDispatch_t Dispatch, void *pContext);
+ActiveStatus_e Active_Post(ActiveObject_t *pAo, uint32_t Signal, uint32_t Param);
+void Active_TimeEvent_Init(ActiveTimeEvent_t *pTe, ActiveObject_t *pAo, uint32_t Signal);
+void Active_TimeEvent_Arm(ActiveTimeEvent_t *pTe, uint32_t Ticks, uint32_t Period);
+void Active_TimeEvent_Disarm(ActiveTimeEvent_t *pTe);
+void Active_Tick(void);
+uint32_t Active_Ticks_To_Next_Event(uint32_t Limit);
+void Active_Task_Handler(void);
+
+#endif /* ACTIVE_H_ */
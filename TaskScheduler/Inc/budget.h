@@ -0,0 +1,33 @@
+/**
+ ******************************************************************************
+ * @file           : budget.h
+ * @author         : Noam Yakar
+ * @brief          : Header file of Budget module. This file contains functions
+ *                   prototypes for CPU budget enforcement.
+ ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+
+#ifndef BUDGET_H_
+#define BUDGET_H_
+
+/* Includes ----------------------------------------------------------------- */
+
+#include "main.h"
+
+/* Macros ------------------------------------------------------------------- */
+
+/* Budget value of a task that is not limited */
+#define BUDGET_UNLIMITED         0U
+
+/* Return values of Budget_Set() */
+#define BUDGET_OK                0U
+#define BUDGET_INVALID           1U
+
+/* Functions prototypes ------------------------------------------------------ */
+
+uint8_t Budget_Set(TaskControlBlock_t *pTask, uint32_t Budget, uint32_t Period, void (*pOverrunHandler)(TaskControlBlock_t *pTask));
+void Budget_Charge(void);
+
+#endif /* BUDGET_H_ */
@@ -0,0 +1,83 @@
+/**
+ ******************************************************************************
+ * @file           : coroutine.h
+ * @author         : Noam Yakar
+ * @brief          : Header file of Coroutine module. This file contains macros,
+ *                   structures definitions and functions prototypes of the
+ *                   stackless coroutines.
+ ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+
+#ifndef COROUTINE_H_
+#define COROUTINE_H_
+
+/* Includes ----------------------------------------------------------------- */
+
+#include "main.h"
+
+/* Macros ------------------------------------------------------------------- */
+
+/* Coroutine body macros. A coroutine is a function that returns at every wait point and resumes
+ * from the same point on the next call, using a switch statement on the saved line number.
+ * Local variables are not preserved across wait points, state that must survive a wait should
+ * be kept in the coroutine's context. A switch statement can't be used across wait points, and
+ * only one wait point can be placed on a line. */
+
+/* Starts the coroutine body */
+#define CO_BEGIN(pCo)                switch((pCo)->lc) { case 0:
+
+/* Ends the coroutine body, the coroutine is removed from the coroutine task */
+#define CO_END(pCo)                  } (pCo)->lc = 0; (pCo)->state = COROUTINE_DONE; return
+
+/* Gives the other coroutines a chance to run */
+#define CO_YIELD(pCo)                do { (pCo)->lc = __LINE__; return; case __LINE__: ; } while(0)
+
+/* Polls a condition every time the coroutine task passes over the coroutine */
+#define CO_WAIT_UNTIL(pCo, Cond)     do { (pCo)->lc = __LINE__; case __LINE__: if(!(Cond)) { return; } } while(0)
+
+/* Sleeps for a number of SysTick ticks */
+#define CO_DELAY(pCo, Ticks)         do { Coroutine_Delay((pCo), (Ticks)); (pCo)->lc = __LINE__; return; case __LINE__: ; } while(0)
+
+/* Sleeps until the event is signaled */
+#define CO_WAIT_EVENT(pCo, pEvent)   do { Coroutine_Wait_Event((pCo), (pEvent)); (pCo)->lc = __LINE__; return; case __LINE__: ; } while(0)
+
+/* Types -------------------------------------------------------------------- */
+
+/* Coroutine states */
+typedef enum
+{
+	COROUTINE_READY,               /*!< The coroutine runs on the next pass of the coroutine task */
+	COROUTINE_DELAYED,             /*!< The coroutine sleeps until wake_tick */
+	COROUTINE_WAITING_EVENT,       /*!< The coroutine sleeps until its event is signaled */
+	COROUTINE_DONE                 /*!< The coroutine reached CO_END and is removed */
+} CoroutineState_e;
+
+/* Event a coroutine can wait for. Signaling an event that nobody waits for is remembered. */
+typedef struct
+{
+	volatile uint32_t count;        /*!< Number of signals not consumed yet */
+} CoroutineEvent_t;
+
+/* Coroutine structure definition. */
+typedef struct Coroutine
+{
+	uint16_t lc;                    /*!< Local continuation - the line the coroutine resumes from */
+	uint8_t state;                  /*!< Specifies the coroutine's state. This parameter can be any value of @ref CoroutineState_e */
+	uint32_t wake_tick;             /*!< Specifies the tick count the coroutine wakes up at, if it's DELAYED */
+	CoroutineEvent_t *event;        /*!< Pointer to the event the coroutine waits for, if it's WAITING_EVENT */
+	void (*handler)(struct Coroutine *pCo); /*!< Pointer to the coroutine's function */
+	void *context;                  /*!< Pointer to the coroutine's private data */
+	struct Coroutine *next;         /*!< Pointer to the next coroutine of the coroutine task */
+} Coroutine_t;
+
+/* Functions prototypes ------------------------------------------------------ */
+
+void Coroutine_Create(Coroutine_t *pCo, void (*pHandler)(Coroutine_t *pCo), void *pContext);
+void Coroutine_Delay(Coroutine_t *pCo, uint32_t DelayTickCount);
+void Coroutine_Wait_Event(Coroutine_t *pCo, CoroutineEvent_t *pEvent);
+void Coroutine_Event_Signal(CoroutineEvent_t *pEvent);
+void Coroutine_Task_Handler(void);
+
+#endif /* COROUTINE_H_ */
@@ -0,0 +1,82 @@
+/**
+ ******************************************************************************
+ * @file           : crash.h
+ * @author         : Noam Yakar
+ * @brief          : Header file of Crash module. This file contains macros,
+ *                   structures and functions prototypes of the post-mortem
+ *                   crash capture. The fault handlers write a crash record to
+ *                   no-init RAM and reset, the record is reported on the next
+ *                   boot and decoded on the host by Tools/crash_decode.
+ ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+
+#ifndef CRASH_H_
+#define CRASH_H_
+
+/* Includes ----------------------------------------------------------------- */
+
+#include "main.h"
+#include "record.h"
+
+/* Macros ------------------------------------------------------------------- */
+
+/* Set to 0 for fault handlers that print the exception and halt, to debug in place */
+#ifndef CRASH_CAPTURE
+#define CRASH_CAPTURE            1
+#endif
+
+/* Identifies a valid crash record in no-init RAM, "CRSH" */
+#define CRASH_MAGIC              0x48535243U
+
+/* Number of scheduler events copied from the recorder's log into the crash record, the latest
+ * context-switches, delays, blocks and wakeups */
+#define CRASH_TRACE_SIZE         16U
+
+/* Prefix of the line the crash record is printed on, in hex words, for Tools/crash_decode */
+#define CRASH_LINE_PREFIX        "CRASH:"
+
+/* Indices of the stacked exception frame */
+#define CRASH_FRAME_R0           0U
+#define CRASH_FRAME_R1           1U
+#define CRASH_FRAME_R2           2U
+#define CRASH_FRAME_R3           3U
+#define CRASH_FRAME_R12          4U
+#define CRASH_FRAME_LR           5U
+#define CRASH_FRAME_PC           6U
+#define CRASH_FRAME_XPSR         7U
+#define CRASH_FRAME_WORDS        8U
+
+/* CFSR stacking errors, the exception frame wasn't written */
+#define CRASH_CFSR_STACKING      ( ( 1 << 4) | ( 1 << 12) )
+
+/* Types -------------------------------------------------------------------- */
+
+/* Crash record structure definition. Placed in .noinit, it survives the reset. All the fields are
+ * words, so the record is printed and dumped as is */
+typedef struct
+{
+	uint32_t magic;                 /*!< CRASH_MAGIC */
+	uint32_t size;                  /*!< sizeof(CrashRecord_t) */
+	uint32_t exception;             /*!< Exception number of the fault: 3 HardFault, 4 MemManage, 5 BusFault, 6 UsageFault */
+	uint32_t exc_return;            /*!< EXC_RETURN of the fault, selects the stack the frame was pushed to */
+	uint32_t frame[CRASH_FRAME_WORDS]; /*!< Stacked R0-R3, R12, LR, PC, xPSR. Zeros after a stacking error */
+	uint32_t sp;                    /*!< Stack pointer before the exception entry */
+	uint32_t cfsr;                  /*!< Configurable Fault Status Register */
+	uint32_t hfsr;                  /*!< HardFault Status Register */
+	uint32_t mmfar;                 /*!< MemManage Fault Address Register, valid if CFSR.MMARVALID */
+	uint32_t bfar;                  /*!< BusFault Address Register, valid if CFSR.BFARVALID */
+	uint32_t task_id;               /*!< ID of the running task, RECORD_NO_TASK before the first one */
+	uint32_t tick;                  /*!< Tick count of the fault */
+	uint32_t trace_count;           /*!< Number of valid entries in the trace */
+	RecordEntry_t trace[CRASH_TRACE_SIZE]; /*!< The latest entries of the recorder's log, oldest first */
+	uint32_t checksum;              /*!< Complement of the sum of the words above */
+} CrashRecord_t;
+
+/* Functions prototypes ----------------------------------------------------- */
+
+void Crash_Capture(uint32_t *pFrame, uint32_t ExcReturn);
+void Crash_Report(void);
+
+#endif /* CRASH_H_ */
@@ -0,0 +1,73 @@
+/**
+ ******************************************************************************
+ * @file           : dsp.h
+ * @author         : Noam Yakar
+ * @brief          : Header file of DSP module. This file contains macros,
+ *                   structures and functions prototypes of the FIR and biquad
+ *                   filter kernels, in soft-float, hard-float and Q15 SIMD
+ *                   variants.
+ ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+
+#ifndef DSP_H_
+#define DSP_H_
+
+/* Includes ----------------------------------------------------------------- */
+
+#include "main.h"
+
+/* Macros ------------------------------------------------------------------- */
+
+/* Number of samples processed by the benchmark in each call to a kernel */
+#define DSP_BLOCK_SIZE           64U
+
+/* Number of taps of the benchmark's FIR filter, even for the Q15 kernel */
+#define DSP_FIR_TAPS             32U
+
+/* Number of blocks measured for each kernel by the benchmark */
+#define DSP_BENCHMARK_ROUNDS     50U
+
+/* Types -------------------------------------------------------------------- */
+
+/* Biquad section, direct form I. y = b0*x0 + b1*x1 + b2*x2 - a1*y1 - a2*y2 */
+typedef struct
+{
+	float b0;
+	float b1;
+	float b2;
+	float a1;
+	float a2;
+	float x1;
+	float x2;
+	float y1;
+	float y2;
+} BiquadF32_t;
+
+/* Biquad section, direct form I, Q15 samples and Q14 coefficients. The coefficients are
+ * packed in pairs to match the sample pairs consumed by SMLAD */
+typedef struct
+{
+	uint32_t b0_b1;                 /*!< b0 in the low half-word, b1 in the high half-word */
+	uint32_t b2_na1;                /*!< b2 in the low half-word, -a1 in the high half-word */
+	int16_t na2;                    /*!< -a2 */
+	int16_t x1;
+	int16_t x2;
+	int16_t y1;
+	int16_t y2;
+} BiquadQ15_t;
+
+/* Functions prototypes ----------------------------------------------------- */
+
+void Fir_F32(const float *pCoeffs, float *pState, uint32_t NumTaps, const float *pIn, float *pOut, uint32_t BlockSize);
+void Fir_F32_Soft(const float *pCoeffs, float *pState, uint32_t NumTaps, const float *pIn, float *pOut, uint32_t BlockSize);
+void Fir_Q15(const int16_t *pCoeffs, int16_t *pState, uint32_t NumTaps, const int16_t *pIn, int16_t *pOut, uint32_t BlockSize);
+void Biquad_F32_Init(BiquadF32_t *pBiquad, float b0, float b1, float b2, float a1, float a2);
+void Biquad_F32(BiquadF32_t *pBiquad, const float *pIn, float *pOut, uint32_t BlockSize);
+void Biquad_F32_Soft(BiquadF32_t *pBiquad, const float *pIn, float *pOut, uint32_t BlockSize);
+void Biquad_Q15_Init(BiquadQ15_t *pBiquad, float b0, float b1, float b2, float a1, float a2);
+void Biquad_Q15(BiquadQ15_t *pBiquad, const int16_t *pIn, int16_t *pOut, uint32_t BlockSize);
+void Dsp_Benchmark_Task_Handler(void);
+
+#endif /* DSP_H_ */
@@ -0,0 +1,87 @@
+/**
+ ******************************************************************************
+ * @file           : dvfs.h
+ * @author         : Noam Yakar
+ * @brief          : Header file of DVFS module. This file contains macros,
+ *                   structures and functions prototypes of the operating points
+ *                   (system clock source and AHB/APB prescalers) and of the
+ *                   load-driven governor that switches between them.
+ ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+
+#ifndef DVFS_H_
+#define DVFS_H_
+
+/* Includes ----------------------------------------------------------------- */
+
+#include "main.h"
+
+/* Macros ------------------------------------------------------------------- */
+
+/* Set to 0 to keep the boot operating point. The benchmarks program their timers for the HSI
+ * clock, so the governor is off by default when one of them is built */
+#ifndef DVFS_GOVERNOR
+#if (NOTIFY_BENCHMARK == 1) || (SNAPSHOT_BENCHMARK == 1) || (LATENCY_BENCHMARK == 1) || \
+    (YIELD_BENCHMARK == 1)
+#define DVFS_GOVERNOR            0
+#else
+#define DVFS_GOVERNOR            1
+#endif
+#endif
+
+/* Operating points, from the slowest to the fastest */
+#define DVFS_POINT_4MHZ          0U    /* HSI / 4 */
+#define DVFS_POINT_16MHZ         1U    /* HSI, the reset clock */
+#define DVFS_POINT_84MHZ         2U    /* PLL / 2 */
+#define DVFS_POINT_168MHZ        3U    /* PLL */
+#define DVFS_NUMBER_OF_POINTS    4U
+#define DVFS_BOOT_POINT          DVFS_POINT_16MHZ
+
+/* Governor: the busy ratio is sampled every window. A window above the up threshold switches to
+ * the fastest point at once, DVFS_DOWN_WINDOWS consecutive windows below the down threshold step
+ * down one point. Thresholds in hundredths of a percent, as returned by Idle_Get_Utilisation() */
+#define DVFS_WINDOW_TICKS        100U
+#define DVFS_UP_THRESHOLD        8000U
+#define DVFS_DOWN_THRESHOLD      3000U
+#define DVFS_DOWN_WINDOWS        3U
+
+/* Maximum number of clock change hooks */
+#define DVFS_MAX_HOOKS           4U
+
+/* Types -------------------------------------------------------------------- */
+
+/* Operating point structure definition. */
+typedef struct
+{
+	uint32_t hclk_hz;               /*!< Core and AHB clock */
+	uint32_t apb1_hz;               /*!< APB1 clock, 42MHz at most */
+	uint32_t apb2_hz;               /*!< APB2 clock, 84MHz at most */
+	uint8_t pll;                    /*!< 1 if the system clock is the PLL, 0 if it's the HSI */
+	uint8_t hpre;                   /*!< RCC_CFGR HPRE field */
+	uint8_t ppre1;                  /*!< RCC_CFGR PPRE1 field */
+	uint8_t ppre2;                  /*!< RCC_CFGR PPRE2 field */
+	uint8_t flash_latency;          /*!< Flash wait states at 2.7-3.6V */
+} DvfsPoint_t;
+
+/* Clock change hook, called after every switch with the new operating point. Drivers that
+ * derive a rate from a bus clock reprogram it here */
+typedef void (*DvfsHook_t)(const DvfsPoint_t *pPoint);
+
+/* Governor statistics */
+typedef struct
+{
+	uint32_t switches;              /*!< Number of operating point switches. */
+	uint32_t ticks[DVFS_NUMBER_OF_POINTS]; /*!< Ticks spent at each operating point. */
+} DvfsStats_t;
+
+/* Functions prototypes ----------------------------------------------------- */
+
+void Dvfs_Init(void);
+uint8_t Dvfs_Register_Hook(DvfsHook_t Hook);
+void Dvfs_Set_Point(uint32_t Point);
+const DvfsPoint_t *Dvfs_Get_Point(void);
+void Dvfs_Tick(void);
+
+#endif /* DVFS_H_ */
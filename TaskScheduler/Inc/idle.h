@@ -0,0 +1,80 @@
+/**
+ ******************************************************************************
+ * @file           : idle.h
+ * @author         : Noam Yakar
+ * @brief          : Header file of Idle module. This file contains macros,
+ *                   structures and functions prototypes of the idle hooks, the
+ *                   low-power modes entered by the idle task and the idle-time
+ *                   statistics.
+ ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+
+#ifndef IDLE_H_
+#define IDLE_H_
+
+/* Includes ----------------------------------------------------------------- */
+
+#include "main.h"
+
+/* Macros ------------------------------------------------------------------- */
+
+/* Deepest low-power mode the idle task may enter */
+#define IDLE_MODE_BUSY           0U    /* Busy loop */
+#define IDLE_MODE_SLEEP          1U    /* Sleep mode (WFI), woken up by any interrupt, the SysTick included */
+#define IDLE_MODE_STOP           2U    /* Stop mode when the next wakeup is far enough, woken up by the RTC */
+#ifndef IDLE_LOW_POWER_MODE
+#define IDLE_LOW_POWER_MODE      IDLE_MODE_STOP
+#endif
+
+/* Clock of the RTC that wakes the core from Stop mode and measures the Stop periods. The LSE
+ * crystal is accurate to a few ppm, the LSI varies by up to 40% between parts and with the
+ * temperature, so it's calibrated against the system clock at init. The 32.768KHz crystal isn't
+ * fitted on the STM32F4DISCOVERY */
+#define IDLE_RTC_CLOCK_LSE       0U
+#define IDLE_RTC_CLOCK_LSI       1U
+#ifndef IDLE_RTC_CLOCK
+#define IDLE_RTC_CLOCK           IDLE_RTC_CLOCK_LSI
+#endif
+
+/* Maximum number of idle hooks */
+#define IDLE_MAX_HOOKS           4U
+
+/* Stop mode is entered only if the next timed wakeup is at least this many ticks away, it costs
+ * the regulator and the clocks start-up time on the way out */
+#define IDLE_STOP_MIN_TICKS      10U
+
+/* Longest Stop period in ticks, also used when no task waits for a timeout */
+#define IDLE_STOP_MAX_TICKS      10000U
+
+/* Types -------------------------------------------------------------------- */
+
+/* Idle hook, called by the idle task before it enters a low-power mode */
+typedef void (*IdleHook_t)(void);
+
+/* Idle-time statistics, in ticks */
+typedef struct
+{
+	uint32_t total_ticks;           /*!< Ticks since the statistics were reset. */
+	uint32_t idle_ticks;            /*!< Ticks in which the idle task was running, Stop periods included. */
+	uint32_t sleep_entries;         /*!< Number of Sleep mode entries. */
+	uint32_t stop_entries;          /*!< Number of Stop mode entries. */
+	uint32_t stop_ticks;            /*!< Ticks spent in Stop mode. */
+	uint32_t early_wakeups;         /*!< Stop periods ended by an interrupt other than the RTC. */
+} IdleStats_t;
+
+/* Functions prototypes ----------------------------------------------------- */
+
+void Idle_Init(void);
+uint8_t Idle_Register_Hook(IdleHook_t Hook);
+void Idle_Run_Hooks(void);
+void Idle_Enter_Low_Power(void);
+void Idle_Stop_Inhibit(void);
+void Idle_Stop_Allow(void);
+void Idle_Account_Tick(void);
+void Idle_Stats_Reset(void);
+uint32_t Idle_Get_Utilisation(void);
+void RTC_WKUP_IRQHandler(void);
+
+#endif /* IDLE_H_ */
@@ -0,0 +1,71 @@
+/**
+ ******************************************************************************
+ * @file           : irq.h
+ * @author         : Noam Yakar
+ * @brief          : Header file of IRQ module. This file contains macros, types
+ *                   and functions prototypes of the RAM vector table, the
+ *                   runtime registration of interrupt handlers and the NVIC
+ *                   priorities.
+ ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+
+#ifndef IRQ_H_
+#define IRQ_H_
+
+/* Includes ----------------------------------------------------------------- */
+
+#include "main.h"
+
+/* Macros ------------------------------------------------------------------- */
+
+/* System Control Block registers */
+#define SCB_VTOR                 0xE000ED08U
+#define SCB_SHPR3                0xE000ED20U
+
+/* NVIC registers, each is an array indexed by IRQ number */
+#define NVIC_ICER0               0xE000E180U
+#define NVIC_ISPR0               0xE000E200U
+#define NVIC_ICPR0               0xE000E280U
+#define NVIC_IPR0                0xE000E400U
+
+/* Vector table: 16 system exceptions followed by the STM32F407 interrupts */
+#define IRQ_COUNT                82U
+#define IRQ_VECTOR_COUNT         (16U + (IRQ_COUNT))
+
+/* VTOR requires the table to be aligned to its size rounded up to a power of 2 */
+#define IRQ_VECTOR_TABLE_ALIGN   512U
+
+/* Priorities, 0 is the highest. Kernel-aware priorities are IRQ_KERNEL_PRIORITY to
+ * IRQ_PRIORITY_LOWEST, lower values are zero-latency. SysTick and PendSV run at the lowest
+ * priority, and interrupts that weren't given a priority at IRQ_PRIORITY_DEFAULT */
+#define IRQ_PRIORITY_HIGHEST     0U
+#define IRQ_PRIORITY_LOWEST      ((1U << (IRQ_PRIORITY_BITS)) - 1U)
+#define IRQ_PRIORITY_DEFAULT     ((IRQ_PRIORITY_LOWEST) - 1U)
+
+/* Return values */
+#define IRQ_OK                   0U
+#define IRQ_INVALID              1U
+
+/* Types -------------------------------------------------------------------- */
+
+/* Handler installed directly in the vector table */
+typedef void (*IrqHandler_t)(void);
+
+/* Handler of a kernel-aware interrupt. Returns 1 to request a context-switch once it returns */
+typedef uint8_t (*IrqKernelHandler_t)(void *pArg);
+
+/* Functions prototypes ----------------------------------------------------- */
+
+void Irq_Init(void);
+uint8_t Irq_Register(uint32_t Irq, IrqHandler_t Handler, uint32_t Priority);
+uint8_t Irq_Register_Kernel(uint32_t Irq, IrqKernelHandler_t Handler, void *pArg, uint32_t Priority);
+uint8_t Irq_Set_Priority(uint32_t Irq, uint32_t Priority);
+void Irq_Enable(uint32_t Irq);
+void Irq_Disable(uint32_t Irq);
+void Irq_Set_Pending(uint32_t Irq);
+void Irq_Clear_Pending(uint32_t Irq);
+void Irq_Kernel_Dispatch(void);
+
+#endif /* IRQ_H_ */
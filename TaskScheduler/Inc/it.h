@@ -15,14 +15,22 @@
 /* Includes ----------------------------------------------------------------- */
 
 #include "main.h"
+#include "crash.h"
 
 /* Functions prototypes ----------------------------------------------------- */
 
 __attribute__((naked)) void PendSV_Handler(void);
 void SysTick_Handler(void);
+#if (CRASH_CAPTURE == 1)
+__attribute__((naked)) void HardFault_Handler(void);
+__attribute__((naked)) void MemManage_Handler(void);
+__attribute__((naked)) void BusFault_Handler(void);
+__attribute__((naked)) void UsageFault_Handler(void);
+#else
 void HardFault_Handler(void);
 void MemManage_Handler(void);
 void BusFault_Handler(void);
 void UsageFault_Handler(void);
+#endif
 
 #endif /* IT_H_ */
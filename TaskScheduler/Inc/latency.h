@@ -0,0 +1,60 @@
+/**
+ ******************************************************************************
+ * @file           : latency.h
+ * @author         : Noam Yakar
+ * @brief          : Header file of the interrupt-to-task latency harness. This
+ *                   file contains the harness configuration and functions
+ *                   prototypes. Enabled by LATENCY_BENCHMARK in task_config.h.
+ ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+
+#ifndef LATENCY_H_
+#define LATENCY_H_
+
+/* Includes ----------------------------------------------------------------- */
+
+#include "main.h"
+
+/* Macros ------------------------------------------------------------------- */
+
+/* Timestamp source: DWT CYCCNT on the board, SysTick on QEMU which doesn't implement the DWT */
+#define LATENCY_CLOCK_DWT        0
+#define LATENCY_CLOCK_SYSTICK    1
+#ifndef LATENCY_CLOCK
+#define LATENCY_CLOCK            LATENCY_CLOCK_DWT
+#endif
+
+/* Set to 1 to print the results over semihosting and exit through it (QEMU -semihosting, or a
+ * debugger with semihosting enabled), 0 to print them with printf (ITM) */
+#ifndef LATENCY_SEMIHOSTING
+#define LATENCY_SEMIHOSTING      0
+#endif
+
+/* Number of measured wakeups */
+#ifndef LATENCY_SAMPLES
+#define LATENCY_SAMPLES          10000U
+#endif
+
+/* Period of the timer interrupt in timer clocks. Not a multiple of the tick period, so the
+ * interrupt sweeps all the phases of SysTick */
+#define LATENCY_PERIOD           23993U
+
+/* Histogram: LATENCY_BUCKETS buckets of LATENCY_BUCKET_CYCLES cycles, the last one also counts
+ * the longer samples */
+#define LATENCY_BUCKET_CYCLES    16U
+#define LATENCY_BUCKETS          64U
+
+/* Wakeups slower than this many cycles fail the run, 0 for no limit */
+#ifndef LATENCY_MAX_CYCLES
+#define LATENCY_MAX_CYCLES       0U
+#endif
+
+/* Functions prototypes ----------------------------------------------------- */
+
+void Latency_Benchmark_Task_Handler(void);
+void Latency_Stamp_Switch(void);
+void TIM3_IRQHandler(void);
+
+#endif /* LATENCY_H_ */
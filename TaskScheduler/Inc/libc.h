@@ -0,0 +1,33 @@
+/**
+ ******************************************************************************
+ * @file           : libc.h
+ * @author         : Noam Yakar
+ * @brief          : Header file of Libc module. This file contains macros and
+ *                   functions prototypes of the C library (newlib) port: the
+ *                   per-task reentrancy structures and the retargetable locks.
+ ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+
+#ifndef LIBC_H_
+#define LIBC_H_
+
+/* Includes ----------------------------------------------------------------- */
+
+#include "main.h"
+
+/* Macros ------------------------------------------------------------------- */
+
+/* Maximum number of locks created at runtime by the C library, one for each open stream. A
+ * stream created when they are all taken isn't locked */
+#define LIBC_MAX_LOCKS           16U
+
+/* Functions prototypes ----------------------------------------------------- */
+
+void Libc_Init(void);
+void Libc_Reent_Init(TaskControlBlock_t *pTask);
+void Libc_Reent_Reclaim(void);
+void Libc_Switch(void);
+
+#endif /* LIBC_H_ */
@@ -17,38 +17,75 @@
 #include <stdio.h>
 #include <stdint.h>
 #include "led.h"
+#include "stack_sizes.h"
+#include "task_config.h"
+#if defined(_NEWLIB_VERSION)
+#include <sys/reent.h>
+#endif
 
 /* Macros --------------------------------------------------------------- */
 
 /* SysTick registers */
 #define SYST_CSR                 0xE000E010
 #define SYST_RVR                 0xE000E014
+#define SYST_CVR                 0xE000E018
 
 /* System Control Block registers */
 #define ICSR                     0xE000ED04
+#define AIRCR                    0xE000ED0C
 #define SHCRS                    0xE000ED24
-
-/* Stack sizes */
-#define SIZE_TASK_STACK          1024U
-#define SIZE_SCHEDULER_STACK     1024U
+#define CFSR                     0xE000ED28
+#define HFSR                     0xE000ED2C
+#define MMFAR                    0xE000ED34
+#define BFAR                     0xE000ED38
+
+/* NVIC registers */
+#define NVIC_ISER0               0xE000E100
+
+/* Debug and DWT registers, used for cycle counting */
+#define DEMCR                    0xE000EDFC
+#define DWT_CTRL                 0xE0001000
+#define DWT_CYCCNT               0xE0001004
+
+/* Set to 1 for the cooperative mode: tasks are never preempted, the tick and the interrupts only
+ * advance time and make tasks ready. A task is switched out only by Task_Yield(), Task_Delay(), a
+ * blocking call or Task_Exit(), through a plain function call (Sched_Switch()) rather than the
+ * PendSV exception. Compare both modes with YIELD_BENCHMARK (task_config.h) */
+#ifndef SCHED_COOPERATIVE
+#define SCHED_COOPERATIVE        0
+#endif
+
+/* Size of the initial stack frame of a task: xPSR, PC, LR, R12, R0-R3 stacked by the exception
+ * entry, and R4-R11 stacked by PendSV_Handler. In a hard-float build PendSV_Handler also stacks
+ * the task's EXC_RETURN.
+ * In the cooperative mode the frame is the one of Sched_Switch(): R3-R11 and the return address,
+ * preceded by S16-S31 in a hard-float build. The caller-saved registers aren't part of it */
+#if (SCHED_COOPERATIVE == 1) && defined(__ARM_FP)
+#define TASK_INITIAL_FRAME_WORDS 26U
+#elif (SCHED_COOPERATIVE == 1)
+#define TASK_INITIAL_FRAME_WORDS 10U
+#elif defined(__ARM_FP)
+#define TASK_INITIAL_FRAME_WORDS 17U
+#else
+#define TASK_INITIAL_FRAME_WORDS 16U
+#endif
 
 /* SRAM boundaries */
 #define SRAM_START               0x20000000U
 #define SIZE_SRAM                ( (128) * (1024))
 #define SRAM_END                 ((SRAM_START) + (SIZE_SRAM) )
 
-/* Stack boundaries */
-#define T1_STACK_START           SRAM_END
-#define T2_STACK_START           ( (SRAM_END) - (1 * SIZE_TASK_STACK) )
-#define T3_STACK_START           ( (SRAM_END) - (2 * SIZE_TASK_STACK) )
-#define T4_STACK_START           ( (SRAM_END) - (3 * SIZE_TASK_STACK) )
-#define IDLE_STACK_START         ( (SRAM_END) - (4 * SIZE_TASK_STACK) )
-#define SCHEDULER_STACK_START    ( (SRAM_END) - (5 * SIZE_TASK_STACK) )
+/* Stack boundaries. The tasks' stacks are placed by the linker in .noinit, or in the .task_stacks
+ * section of .data without the fast start (boot.h). The scheduler (MSP) stack is at the end of
+ * SRAM, reserved by _Min_Stack_Size in the linker script */
+#define SCHEDULER_STACK_START    SRAM_END
 
 /* Clocking */
 #define TICK_HZ                  1000U
-#define HSI_CLOCK                16000000U
-#define SYSTICK_TIM_CLK          HSI_CLOCK
+#define HSI_CLOCK                16000000U   /* The reset clock, the core clock is switched by dvfs.c */
+
+/* Timeout value of Task_Block() for blocking until the task is explicitly unblocked */
+#define TASK_BLOCK_FOREVER       0U
 
 /* Dummy value for xPSR register */
 #define DUMMY_XPSR               0x01000000U       /* Maintain T-bit (bit 24) as 1 */
@@ -58,20 +95,61 @@
 #define EXC_RETURN_THREAD_MSP    (0xFFFFFFF9UL)    /* return to Thread mode, use MSP after return  */
 #define EXC_RETURN_THREAD_PSP    (0xFFFFFFFDUL)    /* return to Thread mode, use PSP after return  */
 
-/* Interrupts Enable/Disable */
-#define INTERRUPT_DISABLE()  do{__asm volatile ("MOV R0,#0x1"); asm volatile("MSR PRIMASK,R0"); } while(0)
-#define INTERRUPT_ENABLE()   do{__asm volatile ("MOV R0,#0x0"); asm volatile("MSR PRIMASK,R0"); } while(0)
+/* Set to 1 to give each task its own C library reentrancy structure (errno, stdio streams,
+ * strtok state...), switched by PendSV_Handler, and to serialize the C library with kernel
+ * locks (libc.c). Only available with newlib */
+#ifndef LIBC_REENT
+#if defined(_NEWLIB_VERSION)
+#define LIBC_REENT               1
+#else
+#define LIBC_REENT               0
+#endif
+#endif
+
+/* Initial LR of a task. A task handler that returns lands in Task_Exit() */
+#define TASK_EXIT_ADDRESS        ((uint32_t)Task_Exit)
+
+/* Interrupt priorities. The NVIC implements the upper IRQ_PRIORITY_BITS bits of each priority.
+ * Interrupts with a priority value below IRQ_KERNEL_PRIORITY are zero-latency: they are never
+ * masked by the kernel and must not call kernel functions. Used in assembly, no suffixes */
+#define IRQ_PRIORITY_BITS        4
+#define IRQ_KERNEL_PRIORITY      5
+#define IRQ_PRIORITY_TO_REG(Priority)  ((Priority) << (8 - (IRQ_PRIORITY_BITS)))
+#define KERNEL_BASEPRI           IRQ_PRIORITY_TO_REG(IRQ_KERNEL_PRIORITY)
+
+/* Interrupts Enable/Disable. Kernel critical sections mask the kernel-aware interrupts only, using
+ * BASEPRI, so the zero-latency interrupts keep running */
+#if defined(__arm__)
+#define INTERRUPT_DISABLE()  do{__asm volatile ("MSR BASEPRI_MAX,%0\n\tISB" : : "r" (KERNEL_BASEPRI) : "memory"); } while(0)
+#define INTERRUPT_ENABLE()   do{__asm volatile ("MSR BASEPRI,%0" : : "r" (0) : "memory"); } while(0)
+
+/* Interrupts Disable/Restore. Nestable version, the previous BASEPRI value is kept in State */
+#define INTERRUPT_SAVE_AND_DISABLE(State)  do{__asm volatile ("MRS %0,BASEPRI" : "=r" (State)); INTERRUPT_DISABLE(); } while(0)
+#define INTERRUPT_RESTORE(State)           do{__asm volatile ("MSR BASEPRI,%0" : : "r" (State) : "memory"); } while(0)
+
+/* Masks all the interrupts, zero-latency ones included, using PRIMASK. For WFI, which a pending
+ * interrupt masked by PRIMASK still wakes, and for measurements */
+#define INTERRUPT_MASK_ALL_SAVE(State)     do{__asm volatile ("MRS %0,PRIMASK" : "=r" (State)); __asm volatile ("CPSID I" : : : "memory"); } while(0)
+#define INTERRUPT_MASK_ALL_RESTORE(State)  do{__asm volatile ("MSR PRIMASK,%0" : : "r" (State) : "memory"); } while(0)
+#else
+/* Host builds of the scheduler core (Tools/) are single-threaded */
+#define INTERRUPT_DISABLE()                do{ } while(0)
+#define INTERRUPT_ENABLE()                 do{ } while(0)
+#define INTERRUPT_SAVE_AND_DISABLE(State)  do{ (State) = 0; } while(0)
+#define INTERRUPT_RESTORE(State)           do{ (void)(State); } while(0)
+#define INTERRUPT_MASK_ALL_SAVE(State)     do{ (State) = 0; } while(0)
+#define INTERRUPT_MASK_ALL_RESTORE(State)  do{ (void)(State); } while(0)
+#endif
 
 /* Types --------------------------------------------------------------- */
 
-/* Task IDs */
+/* Task IDs, one for each line of the static tasks table */
+#define TASK_ID(Id, Entry, StackSize, Deadline)  Id,
 typedef enum TaskID
 {
-	IDLE_TASK,
-	TASK1,
-	TASK2,
-	TASK3,
-	TASK4
+	TASK_TABLE(TASK_ID)
+	NUMBER_OF_STATIC_TASKS,
+	DYNAMIC_TASK = NUMBER_OF_STATIC_TASKS  /* ID of the tasks created at runtime by Task_Create() */
 } TaskID_e;
 
 /* Task states */
@@ -79,9 +157,30 @@ typedef enum TaskState
 {
 	TASK_READY_STATE,
 	TASK_BLOCKED_STATE,
+	TASK_THROTTLED_STATE,           /* Blocked until its CPU budget is replenished */
 	TASK_TERMINATED_STATE
 } TaskState_e;
 
+/* CPU budget (reservation) of a task. A task with budget 0 is not limited */
+struct TCB;
+typedef struct TaskBudget
+{
+	uint32_t budget;                /*!< Specifies the number of ticks the task may run in each replenishment period */
+	uint32_t period;                /*!< Specifies the replenishment period in ticks */
+	uint32_t used;                  /*!< Number of ticks the task ran in the current period */
+	uint32_t replenish_tick;        /*!< Specifies the tick count at which the current period ends */
+	uint32_t overruns;              /*!< Number of periods in which the task exhausted its budget */
+	void (*overrun_handler)(struct TCB *pTask); /*!< Optional function called from SysTick when the task is throttled */
+} TaskBudget_t;
+
+/* Task notification states */
+typedef enum TaskNotifyState
+{
+	NOTIFY_NOT_WAITING,             /* The task doesn't wait for a notification */
+	NOTIFY_WAITING,                 /* The task is blocked waiting for a notification */
+	NOTIFY_PENDING                  /* A notification was sent and not taken yet */
+} TaskNotifyState_e;
+
 /* Task Control Block (TCB) structure definition. Contains private information of a task. */
 typedef struct TCB
 {
@@ -89,8 +188,22 @@ typedef struct TCB
 	uint32_t *psp_value;            /*!< Specifies the task's private stack pointer. */
 	uint32_t block_count;           /*!< Specifies the task's block duration if it's in BLOCKED state */
 	TaskState_e current_state;      /*!< Specifies the task's state. This parameter can be any value of @ref TaskState_e */
+	uint32_t relative_deadline;     /*!< Specifies the deadline of each job of the task, in ticks after it becomes ready */
+	uint32_t absolute_deadline;     /*!< Specifies the tick count by which the task's current job should complete */
+	uint32_t deadline_misses;       /*!< Number of jobs of the task that completed after their deadline */
+	uint8_t job_done;               /*!< Set when the task's current job completed, its next wakeup releases a new job */
+	TaskBudget_t budget;            /*!< Specifies the task's CPU budget. */
+	volatile uint32_t notify_value; /*!< Specifies the task's notification value */
+	volatile uint8_t notify_state;  /*!< Specifies the task's notification state. This parameter can be any value of @ref TaskNotifyState_e */
+	struct TCB *wait_next;          /*!< Pointer to the next task waiting for the same kernel object */
+	uint32_t sched_lock;            /*!< Scheduler lock nesting count, the task isn't switched out while it's not 0 */
+	uint8_t flags;                  /*!< Lifecycle flags, see TASK_FLAG_* in task.h */
+	struct TCB *joiner;             /*!< Pointer to the task waiting in Task_Join() for this task to terminate */
 	void (*task_handler)(void);     /*!< Pointer to the task's handler function. */
 	struct TCB *next;               /*!< Pointer to the next task's TCB in a queue */
+#if (LIBC_REENT == 1)
+	struct _reent reent;            /*!< The task's C library reentrancy structure, see libc.c */
+#endif
 } TaskControlBlock_t;
 
 /* Functions prototypes --------------------------------------------------------- */
@@ -100,7 +213,7 @@ void Task1_Handler(void);
 void Task2_Handler(void);
 void Task3_Handler(void);
 void Task4_Handler(void);
-void Schedule(void);
+void Task_Frames_Init(void);
 void SysTick_Init(uint32_t TickHz);
 __attribute__((naked)) void Scheduler_Stack_Init(uint32_t SchedulerStackStart);
 void Task_Init(TaskControlBlock_t *pTask, TaskID_e TaskID, uint32_t *pPSPValue, void (*pTaskHandler)(void));
@@ -109,8 +222,16 @@ uint32_t Get_PSP_Value(void);
 void Save_PSP_Value(uint32_t CurrentPSPValue);
 __attribute__((naked)) void Switch_SP_To_PSP(void);
 void Pend_PendSV(void);
+#if (SCHED_COOPERATIVE == 1)
+__attribute__((naked)) void Sched_Switch(void);
+__attribute__((naked)) void Sched_Task_Start(void);
+#endif
+void Task_Yield(void);
 void Task_Delay(uint32_t DelayTickCount);
 void Increment_Global_Tick_Count(void);
 void Unblock_Tasks(void);
+void Task_Block(uint32_t TimeoutTickCount);
+void Task_Unblock(TaskControlBlock_t *pTask);
+void Cycle_Counter_Init(void);
 
 #endif /* MAIN_H_ */
@@ -0,0 +1,64 @@
+/**
+ ******************************************************************************
+ * @file           : mempool.h
+ * @author         : Noam Yakar
+ * @brief          : Header file of MemPool module. This file contains macros,
+ *                   structures and functions prototypes of the fixed-block
+ *                   memory pools.
+ ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+
+#ifndef MEMPOOL_H_
+#define MEMPOOL_H_
+
+/* Includes ----------------------------------------------------------------- */
+
+#include "main.h"
+
+/* Macros ------------------------------------------------------------------- */
+
+/* Alignment of the blocks of a pool */
+#define MEMPOOL_ALIGN            8U
+
+/* Size of a block of a pool, rounded up to hold the free-list link and keep the alignment */
+#define MEMPOOL_BLOCK_SIZE(BlockSize)  ( ((BlockSize) + (MEMPOOL_ALIGN) - 1U) & ~((MEMPOOL_ALIGN) - 1U) )
+
+/* Maximum number of blocks of a pool. The free-list head holds a 16 bit block index */
+#define MEMPOOL_MAX_BLOCKS       0xFFFFU
+
+/* Allocates the storage of a pool of NumBlocks blocks of BlockSize bytes, passed to MemPool_Init() */
+#define MEMPOOL_STORAGE(Name, BlockSize, NumBlocks) \
+	static uint8_t Name[MEMPOOL_BLOCK_SIZE(BlockSize) * (NumBlocks)] __attribute__((aligned(MEMPOOL_ALIGN)))
+
+/* Types -------------------------------------------------------------------- */
+
+/* Block release status */
+typedef enum
+{
+	MEMPOOL_OK,                    /*!< The block was returned to the pool */
+	MEMPOOL_INVALID                /*!< The pointer is not a block of the pool */
+} MemPoolStatus_e;
+
+/* Fixed-block memory pool structure definition. The free blocks form a lock-free LIFO list, linked
+ * by the index of the next free block kept in the first word of each free block. */
+typedef struct
+{
+	uint8_t *storage;               /*!< Start of the pool's blocks. */
+	uint32_t block_size;            /*!< Size of a block in bytes, a multiple of MEMPOOL_ALIGN. */
+	uint32_t num_blocks;            /*!< Number of blocks in the pool. */
+	volatile uint32_t head;         /*!< Free-list head: index of the first free block in the low half-word,
+	                                     modification tag in the high half-word (prevents ABA). */
+	volatile uint32_t used;         /*!< Number of allocated blocks. */
+	volatile uint32_t peak;         /*!< Highest number of allocated blocks. */
+	volatile uint32_t failures;     /*!< Number of allocations that failed because the pool was empty. */
+} MemPool_t;
+
+/* Functions prototypes ----------------------------------------------------- */
+
+void MemPool_Init(MemPool_t *pPool, void *pStorage, uint32_t BlockSize, uint32_t NumBlocks);
+void *MemPool_Alloc(MemPool_t *pPool);
+MemPoolStatus_e MemPool_Free(MemPool_t *pPool, void *pBlock);
+
+#endif /* MEMPOOL_H_ */
@@ -0,0 +1,45 @@
+/**
+ ******************************************************************************
+ * @file           : notify.h
+ * @author         : Noam Yakar
+ * @brief          : Header file of Notify module. This file contains
+ *                   enumerations, macros and functions prototypes of the
+ *                   direct-to-task notifications.
+ ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+
+#ifndef NOTIFY_H_
+#define NOTIFY_H_
+
+/* Includes ----------------------------------------------------------------- */
+
+#include "main.h"
+
+/* Macros ------------------------------------------------------------------- */
+
+/* Number of wakeups measured for each primitive by the benchmark */
+#define NOTIFY_BENCHMARK_ROUNDS  100U
+
+/* Types -------------------------------------------------------------------- */
+
+/* The way a notification updates the notification value of the task */
+typedef enum
+{
+	NOTIFY_NO_ACTION,              /*!< The value isn't changed, the task is only woken up */
+	NOTIFY_SET_BITS,               /*!< The value is ORed with the given bits */
+	NOTIFY_INCREMENT,              /*!< The value is incremented, like giving a counting semaphore */
+	NOTIFY_OVERWRITE,              /*!< The value is overwritten, even if a previous notification is pending */
+	NOTIFY_WRITE_IF_TAKEN          /*!< The value is written only if no notification is pending */
+} NotifyAction_e;
+
+/* Functions prototypes ------------------------------------------------------ */
+
+uint8_t Task_Notify(TaskControlBlock_t *pTask, uint32_t Value, NotifyAction_e Action);
+void Task_Notify_Give(TaskControlBlock_t *pTask);
+uint32_t Task_Notify_Take(uint8_t ClearOnExit, uint32_t TimeoutTickCount);
+uint8_t Task_Notify_Wait(uint32_t ClearBitsOnEntry, uint32_t ClearBitsOnExit, uint32_t *pValue, uint32_t TimeoutTickCount);
+void Notify_Benchmark_Task_Handler(void);
+
+#endif /* NOTIFY_H_ */
@@ -31,9 +31,11 @@ typedef enum
 	REGULAR_ENQUEUE,               /*!< The new task is inserted at the end of the queue */
 	ENQUEUE_WITH_REAR_IDLE_TASK,   /*!< The new task is inserted one item before the end of
 	                                    the queue. At the end there's the idle task */
-	ENQUEUE_SORTED                 /*!< The queue is actually a sorted linked list, sorted by the
+	ENQUEUE_SORTED,                /*!< The queue is actually a sorted linked list, sorted by the
                                         block_count property, and the new task is placed according
                                         to its block_count value */
+	ENQUEUE_AT_FRONT               /*!< The new task is inserted at the beginning of the queue, so
+                                        it is the next one to be scheduled */
 } EnqueueMode_e;
 
 /* The method in which a task is dequeued from a queue */
@@ -61,5 +63,6 @@ typedef struct
 
 void Enqueue(TaskControlBlock_t **pHead, TaskControlBlock_t *pTask, EnqueueMode_e EnqueueMode);
 TaskControlBlock_t* Dequeue(TaskControlBlock_t **pHead, DequeueMode_e DequeueMode);
+uint8_t Queue_Remove(TaskControlBlock_t **pHead, TaskControlBlock_t *pTask);
 
 #endif /* QUEUE_H_ */
@@ -0,0 +1,66 @@
+/**
+ ******************************************************************************
+ * @file           : queueset.h
+ * @author         : Noam Yakar
+ * @brief          : Header file of QueueSet module. This file contains macros,
+ *                   enumerations, structures definitions and functions
+ *                   prototypes of the queue sets, which let a task block on
+ *                   several semaphores and stream buffers at once.
+ ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+
+#ifndef QUEUESET_H_
+#define QUEUESET_H_
+
+/* Includes ----------------------------------------------------------------- */
+
+#include "main.h"
+#include "semaphore.h"
+#include "streambuf.h"
+
+/* Macros ------------------------------------------------------------------- */
+
+/* Maximum number of members of a set */
+#define QUEUESET_MAX_MEMBERS     8U
+
+/* Return values of QueueSet_Add() */
+#define QUEUESET_OK              0U
+#define QUEUESET_INVALID         1U
+
+/* Types -------------------------------------------------------------------- */
+
+/* Kernel objects that can be members of a set */
+typedef enum
+{
+	QUEUESET_SEMAPHORE,            /*!< Ready while it has a token */
+	QUEUESET_STREAMBUF             /*!< Ready while it has bytes to read */
+} QueueSetMemberType_e;
+
+/* Member of a set */
+typedef struct
+{
+	uint8_t type;                   /*!< Specifies the member's type. This parameter can be any value of @ref QueueSetMemberType_e */
+	void *handle;                   /*!< Pointer to the Semaphore_t or the StreamBuf_t */
+} QueueSetMember_t;
+
+/* Queue set structure definition. A member belongs to one set at most, and is read only by the
+ * task that selects on the set, so a member it selects stays ready until it's read. */
+typedef struct QueueSet
+{
+	QueueSetMember_t members[QUEUESET_MAX_MEMBERS]; /*!< The members, in the order they were added */
+	uint32_t count;                 /*!< Number of members */
+	uint32_t next;                  /*!< Member the next scan starts from, so a busy member doesn't starve the others */
+	TaskControlBlock_t *waiters;    /*!< Tasks waiting for a member to become ready, linked by wait_next */
+} QueueSet_t;
+
+/* Functions prototypes ----------------------------------------------------- */
+
+void QueueSet_Init(QueueSet_t *pSet);
+uint8_t QueueSet_Add(QueueSet_t *pSet, QueueSetMemberType_e Type, void *pHandle);
+void QueueSet_Remove(QueueSet_t *pSet, void *pHandle);
+void* QueueSet_Select(QueueSet_t *pSet, uint32_t TimeoutTickCount);
+void QueueSet_Post(QueueSet_t *pSet);
+
+#endif /* QUEUESET_H_ */
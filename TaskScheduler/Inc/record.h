@@ -0,0 +1,98 @@
+/**
+ ******************************************************************************
+ * @file           : record.h
+ * @author         : Noam Yakar
+ * @brief          : Header file of Record module. This file contains macros,
+ *                   structures and functions prototypes of the recorder of the
+ *                   scheduler's nondeterministic inputs, replayed on the host by
+ *                   Tools/sched_replay.
+ ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+
+#ifndef RECORD_H_
+#define RECORD_H_
+
+/* Includes ----------------------------------------------------------------- */
+
+#include "main.h"
+
+/* Macros ------------------------------------------------------------------- */
+
+/* Set to 0 to compile the recorder out */
+#ifndef RECORD_ENABLE
+#define RECORD_ENABLE            1
+#endif
+
+/* Number of entries of the circular log. Must be a power of 2. A checkpoint of the scheduler's
+ * state is logged at the start of each half of the log, so a dump always holds a checkpoint to
+ * start the replay from */
+#define RECORD_SIZE              512U
+#define RECORD_MASK              ( (RECORD_SIZE) - 1U )
+#define RECORD_HALF              ( (RECORD_SIZE) / 2U )
+
+/* Identifies the log in a memory dump, "SREC" */
+#define RECORD_MAGIC             0x43455253U
+
+/* Task ID logged when there is no running task yet */
+#define RECORD_NO_TASK           0xFFU
+
+/* Position logged for a task that's not in the ready structure or in the blocked queue */
+#define RECORD_NO_POSITION       0xFFU
+
+/* Logs an event. Called before the event changes the scheduler's state */
+#if (RECORD_ENABLE == 1)
+#define RECORD(Type, TaskId, Aux, Arg)  Record_Event((Type), (TaskId), (Aux), (Arg))
+#else
+#define RECORD(Type, TaskId, Aux, Arg)  do { } while(0)
+#endif
+
+/* Types -------------------------------------------------------------------- */
+
+/* Log entry types */
+typedef enum
+{
+	RECORD_SCHEDULE,               /*!< Schedule() runs. task: the running task */
+	RECORD_DELAY,                  /*!< Task_Delay(). task: the running task, arg: the delay */
+	RECORD_BLOCK,                  /*!< Task_Block(). task: the running task, aux: 1 if the task
+	                                    completed its job, arg: the timeout */
+	RECORD_WAKEUP,                 /*!< Task_Unblock() of a blocked task. task: the woken task,
+	                                    aux: the active exception number, 0 from a task */
+	RECORD_THROTTLE,               /*!< The running task exhausted its CPU budget. arg: the replenish tick */
+	RECORD_EXIT,                   /*!< Task_Exit(). task: the running task */
+	RECORD_CHECKPOINT,             /*!< Start of a checkpoint. task: the running task, aux: the
+	                                    scheduling policy, arg: number of tasks that follow */
+	RECORD_CHECKPOINT_TASK,        /*!< Checkpoint of a task. aux: position in the ready structure
+	                                    (low byte) and in the blocked queue (high byte), arg: block_count */
+	RECORD_CHECKPOINT_STATE,       /*!< Checkpoint of a task. aux: current_state, arg: relative_deadline */
+	RECORD_CHECKPOINT_DEADLINE     /*!< Checkpoint of a task. aux: job_done, arg: absolute_deadline */
+} RecordType_e;
+
+/* Log entry structure definition. */
+typedef struct
+{
+	uint32_t tick;                  /*!< The tick count when the event took place. The ticks themselves
+	                                     aren't logged, the replay runs the ticks between the entries */
+	uint8_t type;                   /*!< Specifies the entry's type. This parameter can be any value of @ref RecordType_e */
+	uint8_t task_id;                /*!< Specifies the task the entry refers to */
+	uint16_t aux;                   /*!< Type specific */
+	uint32_t arg;                   /*!< Type specific */
+} RecordEntry_t;
+
+/* Circular log structure definition. Dumped as is from the target, e.g. with GDB:
+ * dump binary value record.bin gRecordLog */
+typedef struct
+{
+	uint32_t magic;                 /*!< RECORD_MAGIC */
+	uint32_t size;                  /*!< RECORD_SIZE */
+	volatile uint32_t head;         /*!< Number of entries logged since boot, the next entry is written
+	                                     at head & RECORD_MASK */
+	RecordEntry_t entries[RECORD_SIZE]; /*!< The last RECORD_SIZE entries */
+} RecordLog_t;
+
+/* Functions prototypes ------------------------------------------------------ */
+
+void Record_Event(RecordType_e Type, uint8_t TaskId, uint16_t Aux, uint32_t Arg);
+
+#endif /* RECORD_H_ */
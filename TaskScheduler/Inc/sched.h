@@ -0,0 +1,79 @@
+/**
+ ******************************************************************************
+ * @file           : sched.h
+ * @author         : Noam Yakar
+ * @brief          : Header file of Sched module. This file contains enumerations,
+ *                   macros, structures definitions and functions prototypes of
+ *                   the scheduling policies.
+ ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+
+#ifndef SCHED_H_
+#define SCHED_H_
+
+/* Includes ----------------------------------------------------------------- */
+
+#include "main.h"
+#include "queue.h"
+
+/* Macros ------------------------------------------------------------------- */
+
+/* Scheduling policies. Preprocessor values, so the selection can be tested by #if */
+#define SCHED_POLICY_ROUND_ROBIN 0U     /*!< Round-robin over the ready queue, the idle task is kept at the back */
+#define SCHED_POLICY_EDF         1U     /*!< Earliest deadline first, ready tasks are kept in a deadline heap */
+
+/* Scheduling policy selection. This parameter can be SCHED_POLICY_ROUND_ROBIN or SCHED_POLICY_EDF */
+#define SCHED_POLICY             SCHED_POLICY_ROUND_ROBIN
+
+/* Maximum number of tasks, static and created by Task_Create(), the size of the EDF deadline heap */
+#define SCHED_MAX_TASKS          16U
+
+/* Relative deadline of a task that has no deadline. It is scheduled by EDF after any task that
+ * has a deadline, and it never counts deadline misses */
+#define SCHED_NO_DEADLINE        0U
+#define SCHED_FAR_DEADLINE       0x7FFFFFFFU
+
+/* Number of round trips between the two tasks of the yield benchmark (yield_bench.c) */
+#define YIELD_BENCHMARK_ROUNDS   1000U
+
+/* Types -------------------------------------------------------------------- */
+
+/* Pointers to functions */
+typedef void (*sched_init)(void);
+typedef void (*sched_ready)(TaskControlBlock_t*, EnqueueMode_e);
+typedef void (*sched_schedule)(void);
+
+/* Scheduling policy structure definition. */
+typedef struct
+{
+	uint8_t policy_type;            /*!< Specifies the policy's type, SCHED_POLICY_ROUND_ROBIN or SCHED_POLICY_EDF */
+	sched_init INIT;                /*!< Pointer to the function that builds the policy's ready structure from the ready queue. */
+	sched_ready READY;              /*!< Pointer to the function that inserts a ready task to the policy's
+	                                     ready structure. The enqueue mode is a hint for queue based policies. */
+	sched_schedule SCHEDULE;        /*!< Pointer to the function that updates the current running task. */
+} SchedPolicy_t;
+
+/* Global variables --------------------------------------------------------- */
+
+extern SchedPolicy_t gRoundRobinPolicy;
+extern SchedPolicy_t gEdfPolicy;
+extern SchedPolicy_t *gpSchedPolicy;
+
+/* Functions prototypes ------------------------------------------------------ */
+
+void Schedule(void);
+void Sched_Set_Deadline(TaskControlBlock_t *pTask, uint32_t RelativeDeadline);
+void Sched_Ready(TaskControlBlock_t *pTask, EnqueueMode_e EnqueueMode);
+void Sched_Job_Complete(TaskControlBlock_t *pTask);
+void Sched_Lock(void);
+void Sched_Unlock(void);
+uint8_t Sched_Is_Locked(void);
+uint8_t Sched_Defer_Switch(void);
+uint32_t Sched_Ready_Tasks(TaskControlBlock_t **pTasks, uint32_t MaxTasks);
+uint8_t Sched_Task_Ready(void);
+void Yield_Benchmark_Task_Handler(void);
+void Yield_Partner_Task_Handler(void);
+
+#endif /* SCHED_H_ */
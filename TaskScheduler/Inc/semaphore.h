@@ -0,0 +1,45 @@
+/**
+ ******************************************************************************
+ * @file           : semaphore.h
+ * @author         : Noam Yakar
+ * @brief          : Header file of Semaphore module. This file contains
+ *                   enumerations, structures definitions and functions
+ *                   prototypes.
+ ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+
+#ifndef SEMAPHORE_H_
+#define SEMAPHORE_H_
+
+/* Includes ----------------------------------------------------------------- */
+
+#include "main.h"
+
+/* Types -------------------------------------------------------------------- */
+
+/* Semaphore operation status */
+typedef enum
+{
+	SEMAPHORE_OK,                  /*!< The semaphore was taken */
+	SEMAPHORE_TIMEOUT              /*!< The timeout expired before the semaphore was given */
+} SemaphoreStatus_e;
+
+struct QueueSet;
+
+/* Counting semaphore structure definition. */
+typedef struct
+{
+	volatile uint32_t count;        /*!< Number of available tokens. */
+	TaskControlBlock_t *waiters;    /*!< Pointer to the first task waiting for a token, linked by wait_next in FIFO order. */
+	struct QueueSet *set;           /*!< The queue set the semaphore is a member of, NULL if none. */
+} Semaphore_t;
+
+/* Functions prototypes ------------------------------------------------------ */
+
+void Semaphore_Init(Semaphore_t *pSem, uint32_t InitialCount);
+void Semaphore_Give(Semaphore_t *pSem);
+SemaphoreStatus_e Semaphore_Take(Semaphore_t *pSem, uint32_t TimeoutTickCount);
+
+#endif /* SEMAPHORE_H_ */
@@ -0,0 +1,52 @@
+/**
+ ******************************************************************************
+ * @file           : snapshot.h
+ * @author         : Noam Yakar
+ * @brief          : Header file of Snapshot module. This file contains macros,
+ *                   structures and functions prototypes of the seqlock-protected
+ *                   shared snapshots.
+ ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+
+#ifndef SNAPSHOT_H_
+#define SNAPSHOT_H_
+
+/* Includes ----------------------------------------------------------------- */
+
+#include "main.h"
+
+/* Macros ------------------------------------------------------------------- */
+
+/* Allocates the storage of a snapshot of Size bytes, passed to Snapshot_Init(). A snapshot keeps
+ * two copies of the data */
+#define SNAPSHOT_STORAGE(Name, Size) \
+	static uint32_t Name[2U * (((Size) + 3U) / 4U)]
+
+/* Number of reads measured with each method by the benchmark */
+#define SNAPSHOT_BENCHMARK_ROUNDS  1000U
+
+/* Types -------------------------------------------------------------------- */
+
+/* Snapshot structure definition. Shared data with a single writer, typically an ISR, and any
+ * number of readers. The writer never waits and the readers never disable interrupts: a reader
+ * copies the data and retries if the sequence number changed meanwhile. The data is kept in two
+ * copies and the writer updates them one after the other, so a reader always has a stable copy
+ * to read, even a reader that preempts the writer. */
+typedef struct
+{
+	volatile uint32_t sequence;     /*!< Incremented before each copy is updated. Its lowest bit
+	                                     selects the copy the readers read */
+	uint8_t *data[2];               /*!< Pointers to the two copies of the data */
+	uint32_t size;                  /*!< Size of the data in bytes */
+} Snapshot_t;
+
+/* Functions prototypes ------------------------------------------------------ */
+
+void Snapshot_Init(Snapshot_t *pSnap, void *pStorage, uint32_t Size, const void *pInitial);
+void Snapshot_Write(Snapshot_t *pSnap, const void *pData);
+uint32_t Snapshot_Read(Snapshot_t *pSnap, void *pData);
+void Snapshot_Benchmark_Task_Handler(void);
+
+#endif /* SNAPSHOT_H_ */
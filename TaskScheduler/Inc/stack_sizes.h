@@ -0,0 +1,45 @@
+/**
+ ******************************************************************************
+ * @file           : stack_sizes.h
+ * @author         : Generated by Tools/stack_usage/stack_usage.py
+ * @brief          : Worst-case stack sizes of the tasks and of the scheduler
+ *                   (MSP) stack. Do not edit, regenerate with "make stack-sizes"
+ *                   from the Debug directory.
+ ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+
+#ifndef STACK_SIZES_H_
+#define STACK_SIZES_H_
+
+/* Macros ------------------------------------------------------------------- */
+
+/* Task1_Handler: worst case 140 bytes, Task1_Handler -> Task_Delay -> Enqueue */
+#define STACK_SIZE_T1                1024U
+
+/* Task2_Handler: worst case 140 bytes, Task2_Handler -> Task_Delay -> Enqueue */
+#define STACK_SIZE_T2                1024U
+
+/* Task3_Handler: worst case 140 bytes, Task3_Handler -> Task_Delay -> Enqueue */
+#define STACK_SIZE_T3                1024U
+
+/* Task4_Handler: worst case 140 bytes, Task4_Handler -> Task_Delay -> Enqueue */
+#define STACK_SIZE_T4                1024U
+
+/* WorkQueue_Task_Handler: worst case 324 bytes, WorkQueue_Task_Handler */
+#define STACK_SIZE_WORKQUEUE         1024U
+
+/* Coroutine_Task_Handler: worst case 324 bytes, Coroutine_Task_Handler */
+#define STACK_SIZE_COROUTINE         1024U
+
+/* Active_Task_Handler: worst case 324 bytes, Active_Task_Handler */
+#define STACK_SIZE_ACTIVE            1024U
+
+/* IdleTask_Handler: worst case 72 bytes, IdleTask_Handler */
+#define STACK_SIZE_IDLE              1024U
+
+/* main + handlers: worst case 1652 bytes, main -> Schedule -> Edf_Schedule -> [15] SysTick_Handler -> Unblock_Tasks -> Dequeue -> iprintf -> [0] MemManage_Handler -> puts -> [-1] HardFault_Handler -> puts */
+#define STACK_SIZE_SCHEDULER         1720U
+
+#endif /* STACK_SIZES_H_ */
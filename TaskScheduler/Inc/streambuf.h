@@ -0,0 +1,61 @@
+/**
+ ******************************************************************************
+ * @file           : streambuf.h
+ * @author         : Noam Yakar
+ * @brief          : Header file of Stream Buffer module. This file contains
+ *                   structures and functions prototypes of the byte stream
+ *                   buffers, read and written by tasks with blocking timeouts
+ *                   and by ISRs and DMA without blocking.
+ ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+
+#ifndef STREAMBUF_H_
+#define STREAMBUF_H_
+
+/* Includes ----------------------------------------------------------------- */
+
+#include "main.h"
+
+/* Macros ------------------------------------------------------------------- */
+
+/* Return values of StreamBuf_Init() */
+#define STREAMBUF_OK             0U
+#define STREAMBUF_INVALID        1U
+
+/* Types -------------------------------------------------------------------- */
+
+struct StreamBuf;
+struct QueueSet;
+
+/* Called after bytes were written to the buffer, to start a consumer that isn't a task (DMA) */
+typedef void (*StreamBufHook_t)(struct StreamBuf *pSb);
+
+/* Byte stream buffer structure definition. A single producer and a single consumer run at a time:
+ * tasks are serialized with the scheduler lock, ISRs must not share a side with other ISRs. */
+typedef struct StreamBuf
+{
+	uint8_t *buffer;                /*!< Storage, its size is a power of 2. */
+	uint32_t size;                  /*!< Size of the storage in bytes. */
+	volatile uint32_t head;         /*!< Free-running write index, advanced by the producer. */
+	volatile uint32_t tail;         /*!< Free-running read index, advanced by the consumer. */
+	TaskControlBlock_t *readers;    /*!< Tasks waiting for data, linked by wait_next. */
+	TaskControlBlock_t *writers;    /*!< Tasks waiting for space, linked by wait_next. */
+	StreamBufHook_t send_hook;      /*!< Called after bytes were written, can be NULL. */
+	uint32_t dropped;               /*!< Bytes dropped by StreamBuf_Send_From_Isr() on a full buffer. */
+	struct QueueSet *set;           /*!< The queue set the buffer is a member of, NULL if none. */
+} StreamBuf_t;
+
+/* Functions prototypes ----------------------------------------------------- */
+
+uint8_t StreamBuf_Init(StreamBuf_t *pSb, uint8_t *pStorage, uint32_t Size, StreamBufHook_t SendHook);
+uint32_t StreamBuf_Send(StreamBuf_t *pSb, const void *pData, uint32_t Length, uint32_t TimeoutTickCount);
+uint32_t StreamBuf_Receive(StreamBuf_t *pSb, void *pData, uint32_t Length, uint32_t TimeoutTickCount);
+uint32_t StreamBuf_Send_From_Isr(StreamBuf_t *pSb, const void *pData, uint32_t Length);
+uint32_t StreamBuf_Read_Pointer(StreamBuf_t *pSb, uint8_t **ppData);
+void StreamBuf_Consume(StreamBuf_t *pSb, uint32_t Length);
+uint32_t StreamBuf_Available(const StreamBuf_t *pSb);
+uint32_t StreamBuf_Space(const StreamBuf_t *pSb);
+
+#endif /* STREAMBUF_H_ */
@@ -0,0 +1,45 @@
+/**
+ ******************************************************************************
+ * @file           : task.h
+ * @author         : Noam Yakar
+ * @brief          : Header file of Task module. This file contains macros and
+ *                   functions prototypes of the tasks lifecycle: creation of
+ *                   tasks at runtime, termination, joining and reclamation of
+ *                   the memory of terminated tasks.
+ ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+
+#ifndef TASK_H_
+#define TASK_H_
+
+/* Includes ----------------------------------------------------------------- */
+
+#include "main.h"
+
+/* Macros ------------------------------------------------------------------- */
+
+/* Task_Create() flags */
+#define TASK_JOINABLE            0x00U    /* Reclaimed once another task joined it */
+#define TASK_DETACHED            0x01U    /* Reclaimed as soon as it terminates, can't be joined */
+
+/* TCB flags, kept in the flags field of the TCB */
+#define TASK_FLAG_DETACHED       TASK_DETACHED
+#define TASK_FLAG_DYNAMIC        0x02U    /* The TCB and the stack were allocated by Task_Create() */
+
+/* Smallest stack of a task created at runtime */
+#define TASK_MIN_STACK_SIZE      256U
+
+/* Return values */
+#define TASK_OK                  0U
+#define TASK_INVALID             1U
+
+/* Functions prototypes ----------------------------------------------------- */
+
+TaskControlBlock_t *Task_Create(void (*pTaskHandler)(void), uint32_t StackSize, uint32_t RelativeDeadline, uint8_t Flags);
+__attribute__((noreturn)) void Task_Exit(void);
+uint8_t Task_Join(TaskControlBlock_t *pTask);
+void Task_Reclaim(void);
+
+#endif /* TASK_H_ */
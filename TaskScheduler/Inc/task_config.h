@@ -0,0 +1,95 @@
+/**
+ ******************************************************************************
+ * @file           : task_config.h
+ * @author         : Noam Yakar
+ * @brief          : Declarative description of the application's static tasks.
+ *                   The table is expanded at build time into the TaskID_e
+ *                   enumeration, the tasks' stacks with their initial exception
+ *                   frames, the TCBs and the initial ready queue.
+ ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+
+#ifndef TASK_CONFIG_H_
+#define TASK_CONFIG_H_
+
+/* Macros ------------------------------------------------------------------- */
+
+/* Set to 1 to replace Tasks 1 and 2 with the context-switch cost and yield throughput benchmark
+ * (yield_bench.c). Build it with SCHED_COOPERATIVE (main.h) set to 0 and to 1 to compare the modes */
+#ifndef YIELD_BENCHMARK
+#define YIELD_BENCHMARK          0
+#endif
+
+/* Entry points of Tasks 1 and 2 */
+#if (YIELD_BENCHMARK == 1)
+#define TASK1_ENTRY              Yield_Benchmark_Task_Handler
+#define TASK2_ENTRY              Yield_Partner_Task_Handler
+#else
+#define TASK1_ENTRY              Task1_Handler
+#define TASK2_ENTRY              Task2_Handler
+#endif
+
+/* Set to 1 to replace Task 3 with the DSP kernels (soft-float / hard-float / SIMD) benchmark */
+#ifndef DSP_BENCHMARK
+#define DSP_BENCHMARK            0
+#endif
+
+/* Set to 1 to replace Task 4 with the notification vs. semaphore wakeup benchmark */
+#ifndef NOTIFY_BENCHMARK
+#define NOTIFY_BENCHMARK         0
+#endif
+
+/* Set to 1 to replace Task 3 with the snapshot vs. critical section benchmark (snapshot_bench.c) */
+#ifndef SNAPSHOT_BENCHMARK
+#define SNAPSHOT_BENCHMARK       0
+#endif
+
+/* Entry point of Task 3 */
+#if (DSP_BENCHMARK == 1) && (SNAPSHOT_BENCHMARK == 1)
+#error "DSP_BENCHMARK and SNAPSHOT_BENCHMARK both replace Task 3"
+#elif (DSP_BENCHMARK == 1)
+#define TASK3_ENTRY              Dsp_Benchmark_Task_Handler
+#elif (SNAPSHOT_BENCHMARK == 1)
+#define TASK3_ENTRY              Snapshot_Benchmark_Task_Handler
+#else
+#define TASK3_ENTRY              Task3_Handler
+#endif
+
+/* Set to 1 to replace Task 4 with the interrupt-to-task latency harness (latency_bench.c) */
+#ifndef LATENCY_BENCHMARK
+#define LATENCY_BENCHMARK        0
+#endif
+
+/* Entry point of Task 4 */
+#if (NOTIFY_BENCHMARK == 1) && (LATENCY_BENCHMARK == 1)
+#error "NOTIFY_BENCHMARK and LATENCY_BENCHMARK both replace Task 4"
+#elif (NOTIFY_BENCHMARK == 1)
+#define TASK4_ENTRY              Notify_Benchmark_Task_Handler
+#elif (LATENCY_BENCHMARK == 1)
+#define TASK4_ENTRY              Latency_Benchmark_Task_Handler
+#else
+#define TASK4_ENTRY              Task4_Handler
+#endif
+
+/* Static tasks table. Each line describes a task:
+ * TASK(Id, Entry, StackSize, Deadline)
+ *     Id        - The task's ID, becomes a value of @ref TaskID_e
+ *     Entry     - The task's handler function
+ *     StackSize - The task's stack size in bytes, a multiple of 8 (see stack_sizes.h)
+ *     Deadline  - The task's relative deadline in ticks, the period of a periodic task,
+ *                 or SCHED_NO_DEADLINE
+ * The tasks start in the ready queue in the order of the table. The idle task must be the
+ * last one. */
+#define TASK_TABLE(TASK) \
+	TASK(TASK1,          TASK1_ENTRY,            STACK_SIZE_T1,         DELAY_1S)           \
+	TASK(TASK2,          TASK2_ENTRY,            STACK_SIZE_T2,         DELAY_500MS)        \
+	TASK(TASK3,          TASK3_ENTRY,            STACK_SIZE_T3,         DELAY_250MS)        \
+	TASK(TASK4,          TASK4_ENTRY,            STACK_SIZE_T4,         DELAY_125MS)        \
+	TASK(WORKQUEUE_TASK, WorkQueue_Task_Handler, STACK_SIZE_WORKQUEUE,  WORKQUEUE_DEADLINE) \
+	TASK(COROUTINE_TASK, Coroutine_Task_Handler, STACK_SIZE_COROUTINE,  SCHED_NO_DEADLINE)  \
+	TASK(ACTIVE_TASK,    Active_Task_Handler,    STACK_SIZE_ACTIVE,     SCHED_NO_DEADLINE)  \
+	TASK(IDLE_TASK,      IdleTask_Handler,       STACK_SIZE_IDLE,       SCHED_NO_DEADLINE)
+
+#endif /* TASK_CONFIG_H_ */
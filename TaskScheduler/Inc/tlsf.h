@@ -0,0 +1,75 @@
+/**
+ ******************************************************************************
+ * @file           : tlsf.h
+ * @author         : Noam Yakar
+ * @brief          : Header file of TLSF module. This file contains macros,
+ *                   structures and functions prototypes of the two-level
+ *                   segregated fit allocator of variable size blocks.
+ ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+
+#ifndef TLSF_H_
+#define TLSF_H_
+
+/* Includes ----------------------------------------------------------------- */
+
+#include <stddef.h>
+#include "main.h"
+
+/* Macros ------------------------------------------------------------------- */
+
+/* Set to 1 to serve newlib's malloc family from a TLSF heap instead of _sbrk */
+#ifndef TLSF_MALLOC
+#define TLSF_MALLOC              1
+#endif
+
+/* Alignment of the allocated blocks */
+#define TLSF_ALIGN_LOG2          3U
+#define TLSF_ALIGN               (1U << (TLSF_ALIGN_LOG2))
+
+/* Number of second level lists of each first level range, as a power of 2 */
+#define TLSF_SL_INDEX_COUNT_LOG2 4U
+#define TLSF_SL_INDEX_COUNT      (1U << (TLSF_SL_INDEX_COUNT_LOG2))
+
+/* Blocks smaller than (1 << TLSF_FL_INDEX_SHIFT) are all kept in the first level range 0 */
+#define TLSF_FL_INDEX_SHIFT      ( (TLSF_SL_INDEX_COUNT_LOG2) + (TLSF_ALIGN_LOG2) )
+
+/* Largest block is below (1 << (TLSF_FL_INDEX_MAX + 1)) bytes */
+#define TLSF_FL_INDEX_MAX        20U
+#define TLSF_FL_INDEX_COUNT      ( (TLSF_FL_INDEX_MAX) - (TLSF_FL_INDEX_SHIFT) + 2U )
+
+/* Types -------------------------------------------------------------------- */
+
+/* Block header. The links to the neighbour free blocks are only valid in a free block and are
+ * kept in its payload */
+typedef struct TlsfBlock
+{
+	struct TlsfBlock *prev_phys;    /*!< Previous block in memory, valid if it is free. */
+	size_t size;                    /*!< Payload size, bit 0: block is free, bit 1: previous block is free. */
+	struct TlsfBlock *next_free;    /*!< Next block in the free list. */
+	struct TlsfBlock *prev_free;    /*!< Previous block in the free list. */
+} TlsfBlock_t;
+
+/* Allocator control structure definition. */
+typedef struct
+{
+	uint32_t fl_bitmap;             /*!< Bit per first level range with a non-empty list. */
+	uint32_t sl_bitmap[TLSF_FL_INDEX_COUNT]; /*!< Bit per non-empty second level list. */
+	TlsfBlock_t *blocks[TLSF_FL_INDEX_COUNT][TLSF_SL_INDEX_COUNT]; /*!< Free lists heads. */
+	size_t total;                   /*!< Payload bytes available in the heap. */
+	size_t used;                    /*!< Bytes allocated, including block headers. */
+	size_t peak;                    /*!< Highest number of bytes allocated. */
+	uint32_t failures;              /*!< Number of allocations that failed. */
+} Tlsf_t;
+
+/* Functions prototypes ----------------------------------------------------- */
+
+void Tlsf_Init(Tlsf_t *pTlsf, void *pMemory, size_t Size);
+void *Tlsf_Malloc(Tlsf_t *pTlsf, size_t Size);
+void Tlsf_Free(Tlsf_t *pTlsf, void *pMemory);
+void *Tlsf_Realloc(Tlsf_t *pTlsf, void *pMemory, size_t Size);
+size_t Tlsf_Block_Size(void *pMemory);
+
+#endif /* TLSF_H_ */
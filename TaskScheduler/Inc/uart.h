@@ -0,0 +1,50 @@
+/**
+ ******************************************************************************
+ * @file           : uart.h
+ * @author         : Noam Yakar
+ * @brief          : Header file of UART module. This file contains macros and
+ *                   functions prototypes of the DMA driven USART2 driver.
+ ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+
+#ifndef UART_H_
+#define UART_H_
+
+/* Includes ----------------------------------------------------------------- */
+
+#include "main.h"
+
+/* Macros ------------------------------------------------------------------- */
+
+/* Set to 1 to retarget _write()/_read(), so printf and the C library's stdin use the UART
+ * instead of ITM */
+#ifndef UART_CONSOLE
+#define UART_CONSOLE             0
+#endif
+
+/* Line settings: 8 data bits, no parity, 1 stop bit */
+#define UART_BAUD_RATE           115200U
+
+/* Sizes of the stream buffers, powers of 2, and of the circular RX DMA buffer. The RX DMA buffer
+ * is drained at half and full transfer and when the line goes idle */
+#define UART_TX_BUFFER_SIZE      1024U
+#define UART_RX_BUFFER_SIZE      256U
+#define UART_RX_DMA_SIZE         64U
+
+/* Priority of the USART2 and DMA interrupts, kernel-aware */
+#define UART_IRQ_PRIORITY        IRQ_PRIORITY_DEFAULT
+
+/* Functions prototypes ----------------------------------------------------- */
+
+void Uart_Init(void);
+uint32_t Uart_Write(const void *pData, uint32_t Length, uint32_t TimeoutTickCount);
+uint32_t Uart_Read(void *pData, uint32_t Length, uint32_t TimeoutTickCount);
+void Uart_Write_Polled(const void *pData, uint32_t Length);
+uint32_t Uart_Rx_Dropped(void);
+void USART2_IRQHandler(void);
+void DMA1_Stream5_IRQHandler(void);
+void DMA1_Stream6_IRQHandler(void);
+
+#endif /* UART_H_ */
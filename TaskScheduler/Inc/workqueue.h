@@ -0,0 +1,70 @@
+/**
+ ******************************************************************************
+ * @file           : workqueue.h
+ * @author         : Noam Yakar
+ * @brief          : Header file of WorkQueue module. This file contains macros,
+ *                   structures definitions and functions prototypes.
+ ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+
+#ifndef WORKQUEUE_H_
+#define WORKQUEUE_H_
+
+/* Includes ----------------------------------------------------------------- */
+
+#include "main.h"
+
+/* Macros ------------------------------------------------------------------- */
+
+/* Number of work items the queue can hold. Must be a power of 2 */
+#define WORKQUEUE_SIZE           32U
+#define WORKQUEUE_MASK           ( (WORKQUEUE_SIZE) - 1U )
+
+/* Maximum number of work items the work task executes before checking for other ready tasks */
+#define WORKQUEUE_BATCH_SIZE     8U
+
+/* Relative deadline of the work task in ticks, makes it the most urgent task for the EDF policy */
+#define WORKQUEUE_DEADLINE       1U
+
+/* Types -------------------------------------------------------------------- */
+
+/* Deferred work function, called in the context of the work task */
+typedef void (*WorkHandler_t)(uint32_t Arg);
+
+/* Work posting status */
+typedef enum
+{
+	WORKQUEUE_OK,                  /*!< The work item was posted */
+	WORKQUEUE_FULL                 /*!< The queue is full, the work item was dropped */
+} WorkQueueStatus_e;
+
+/* Work item structure definition. */
+typedef struct
+{
+	volatile uint32_t sequence;     /*!< Slot sequence number, tells producers and the consumer whether
+	                                     the slot is free or holds a committed work item */
+	WorkHandler_t handler;          /*!< Pointer to the deferred work function. */
+	uint32_t arg;                   /*!< Argument passed to the deferred work function. */
+} WorkItem_t;
+
+/* Work queue structure definition. A bounded lock-free queue with multiple producers (ISRs) and a
+ * single consumer (the work task). */
+typedef struct
+{
+	WorkItem_t items[WORKQUEUE_SIZE]; /*!< Work items ring buffer. */
+	volatile uint32_t head;         /*!< Next position to be reserved by a producer. */
+	uint32_t tail;                  /*!< Next position to be consumed by the work task. */
+	volatile uint32_t dropped;      /*!< Number of work items dropped because the queue was full. */
+	uint32_t processed;             /*!< Number of work items executed by the work task. */
+	uint32_t batches;               /*!< Number of batches executed by the work task. */
+} WorkQueue_t;
+
+/* Functions prototypes ------------------------------------------------------ */
+
+void WorkQueue_Init(void);
+WorkQueueStatus_e WorkQueue_Post(WorkHandler_t Handler, uint32_t Arg);
+void WorkQueue_Task_Handler(void);
+
+#endif /* WORKQUEUE_H_ */
@@ -0,0 +1,308 @@
+/**
+ ******************************************************************************
+ * @file           : active.c
+ * @author         : Noam Yakar
+ * @brief          : This file contains function definitions for the active
+ *                   objects. Every active object is an event-driven state machine
+ *                   with its own event queue. All the active objects are
+ *                   dispatched by the active objects task and share its stack:
+ *                   the task runs one event of the highest priority object that
+ *                   has pending events to completion, then picks the next one.
+ ******************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------- */
+
+#include "active.h"
+
+/* Global variables --------------------------------------------------------- */
+
+/* Kernel objects, allocated in main.c */
+extern TaskControlBlock_t *pActiveTask;
+extern uint32_t gTickCount;
+
+/* The started active objects, indexed by priority */
+static ActiveObject_t *gActiveTable[ACTIVE_MAX_PRIORITY];
+
+/* Bit n is set while the active object of priority n has events in its queue */
+static volatile uint32_t gActiveReadySet = 0;
+
+/* The armed time events, serviced by Active_Tick() */
+static ActiveTimeEvent_t *gpTimeEventList = NULL;
+
+/* Functions definitions ---------------------------------------------------- */
+
+/**
+  * @brief  Starts an active object. The object's dispatch function receives ACTIVE_SIG_INIT before
+  * 		any other event.
+  * @param  pAo - Pointer to the active object. Must stay allocated while the object runs.
+  * @param  Priority - Specifies the object's priority, 0 to ACTIVE_MAX_PRIORITY - 1. Each active
+  * 		object must have a unique priority.
+  * @param  pQueue - Pointer to the event queue storage.
+  * @param  QueueSize - Number of events the queue can hold, a power of 2.
+  * @param  Dispatch - Pointer to the object's dispatch function.
+  * @param  pContext - Pointer to the object's private data, can be NULL.
+  * @retval ACTIVE_OK, or ACTIVE_INVALID if the queue size is not a power of 2 or the priority is
+  * 		invalid or taken.
+  */
+ActiveStatus_e Active_Start(ActiveObject_t *pAo, uint8_t Priority, ActiveEvent_t *pQueue, uint32_t QueueSize,
+		ActiveDispatch_t Dispatch, void *pContext)
+{
+	uint32_t PrimaskState;
+
+	if((pQueue == NULL) || (QueueSize == 0U) || ((QueueSize & (QueueSize - 1U)) != 0U) ||
+			(Priority >= ACTIVE_MAX_PRIORITY) || (gActiveTable[Priority] != NULL))
+	{
+		return ACTIVE_INVALID;
+	}
+
+	pAo->priority = Priority;
+	pAo->queue = pQueue;
+	pAo->size = QueueSize;
+	pAo->head = 0;
+	pAo->tail = 0;
+	pAo->dropped = 0;
+	pAo->dispatch = Dispatch;
+	pAo->context = pContext;
+
+	/* Disable interrupts, the active objects task may be looking for the next object */
+	INTERRUPT_SAVE_AND_DISABLE(PrimaskState);
+
+	gActiveTable[Priority] = pAo;
+
+	/* Restore interrupts */
+	INTERRUPT_RESTORE(PrimaskState);
+
+	return Active_Post(pAo, ACTIVE_SIG_INIT, 0);
+}
+
+/**
+  * @brief  Posts an event to an active object and wakes up the active objects task.
+  * @note   Can be called from ISRs, from tasks and from the dispatch functions.
+  * @param  pAo - Pointer to the active object.
+  * @param  Signal - Specifies the event's signal.
+  * @param  Param - Specifies the event's parameter.
+  * @retval ACTIVE_OK, or ACTIVE_FULL if the object's event queue is full.
+  */
+ActiveStatus_e Active_Post(ActiveObject_t *pAo, uint32_t Signal, uint32_t Param)
+{
+	uint32_t PrimaskState;
+	ActiveEvent_t *pEvent;
+
+	/* Disable interrupts */
+	INTERRUPT_SAVE_AND_DISABLE(PrimaskState);
+
+	if((pAo->head - pAo->tail) == pAo->size)
+	{
+		pAo->dropped++;
+
+		/* Restore interrupts */
+		INTERRUPT_RESTORE(PrimaskState);
+
+		return ACTIVE_FULL;
+	}
+
+	pEvent = &(pAo->queue[pAo->head & (pAo->size - 1U)]);
+	pEvent->signal = Signal;
+	pEvent->param = Param;
+	pAo->head++;
+
+	/* Mark the object ready and wake up the active objects task */
+	gActiveReadySet |= (1U << pAo->priority);
+	Task_Unblock(pActiveTask);
+
+	/* Restore interrupts */
+	INTERRUPT_RESTORE(PrimaskState);
+
+	return ACTIVE_OK;
+}
+
+/**
+  * @brief  Initializes a time event. The time event is disarmed.
+  * @param  pTe - Pointer to the time event. Must stay allocated while it's armed.
+  * @param  pAo - Pointer to the active object the signal is posted to.
+  * @param  Signal - Specifies the signal posted when the time event expires.
+  * @retval None
+  */
+void Active_TimeEvent_Init(ActiveTimeEvent_t *pTe, ActiveObject_t *pAo, uint32_t Signal)
+{
+	pTe->target = pAo;
+	pTe->signal = Signal;
+	pTe->expire_tick = 0;
+	pTe->period = ACTIVE_ONE_SHOT;
+	pTe->armed = 0;
+	pTe->next = NULL;
+}
+
+/**
+  * @brief  Arms a time event. Re-arming an armed time event restarts it.
+  * @note   Can be called from ISRs, from tasks and from the dispatch functions.
+  * @param  pTe - Pointer to the time event.
+  * @param  Ticks - Specifies the number of SysTick ticks until the time event expires, at least 1.
+  * @param  Period - Specifies the period in ticks the time event expires at afterwards, or
+  * 		ACTIVE_ONE_SHOT.
+  * @retval None
+  */
+void Active_TimeEvent_Arm(ActiveTimeEvent_t *pTe, uint32_t Ticks, uint32_t Period)
+{
+	uint32_t PrimaskState;
+
+	if(Ticks == 0U)
+	{
+		Ticks = 1U;
+	}
+
+	/* Disable interrupts, Active_Tick() may be passing over the list */
+	INTERRUPT_SAVE_AND_DISABLE(PrimaskState);
+
+	pTe->expire_tick = gTickCount + Ticks;
+	pTe->period = Period;
+
+	if(!pTe->armed)
+	{
+		pTe->armed = 1;
+		pTe->next = gpTimeEventList;
+		gpTimeEventList = pTe;
+	}
+
+	/* Restore interrupts */
+	INTERRUPT_RESTORE(PrimaskState);
+}
+
+/**
+  * @brief  Disarms a time event. An event it already posted stays in the object's queue.
+  * @param  pTe - Pointer to the time event.
+  * @retval None
+  */
+void Active_TimeEvent_Disarm(ActiveTimeEvent_t *pTe)
+{
+	uint32_t PrimaskState;
+	ActiveTimeEvent_t **pLink;
+
+	/* Disable interrupts */
+	INTERRUPT_SAVE_AND_DISABLE(PrimaskState);
+
+	if(pTe->armed)
+	{
+		for(pLink = &gpTimeEventList; *pLink != NULL; pLink = &((*pLink)->next))
+		{
+			if(*pLink == pTe)
+			{
+				*pLink = pTe->next;
+				break;
+			}
+		}
+		pTe->armed = 0;
+	}
+
+	/* Restore interrupts */
+	INTERRUPT_RESTORE(PrimaskState);
+}
+
+/**
+  * @brief  Posts the signals of the expired time events and re-arms the periodic ones. Called by
+  * 		SysTick_Handler() every tick, after the tick count is incremented.
+  * @param  None
+  * @retval None
+  */
+void Active_Tick(void)
+{
+	ActiveTimeEvent_t **pLink;
+	ActiveTimeEvent_t *pTe;
+
+	pLink = &gpTimeEventList;
+	while((pTe = *pLink) != NULL)
+	{
+		if((int32_t)(gTickCount - pTe->expire_tick) >= 0)
+		{
+			(void)Active_Post(pTe->target, pTe->signal, 0);
+
+			if(pTe->period != ACTIVE_ONE_SHOT)
+			{
+				pTe->expire_tick += pTe->period;
+			}
+			else
+			{
+				/* Remove the one-shot time event from the list */
+				*pLink = pTe->next;
+				pTe->armed = 0;
+				continue;
+			}
+		}
+		pLink = &(pTe->next);
+	}
+}
+
+/**
+  * @brief  Returns the number of ticks until the earliest armed time event expires. Called by the
+  * 		idle task with interrupts disabled, to bound its Stop mode period.
+  * @param  Limit - The largest number of ticks returned.
+  * @retval Ticks until the earliest expiry, 0 if one is due, Limit if none is armed or all
+  * 		expire later.
+  */
+uint32_t Active_Ticks_To_Next_Event(uint32_t Limit)
+{
+	ActiveTimeEvent_t *pTe;
+	uint32_t Ticks = Limit;
+
+	for(pTe = gpTimeEventList; pTe != NULL; pTe = pTe->next)
+	{
+		int32_t Remaining = (int32_t)(pTe->expire_tick - gTickCount);
+		if(Remaining <= 0)
+		{
+			return 0U;
+		}
+		if((uint32_t)Remaining < Ticks)
+		{
+			Ticks = (uint32_t)Remaining;
+		}
+	}
+
+	return Ticks;
+}
+
+/**
+  * @brief  Handler of the active objects task. Takes the oldest event of the highest priority
+  * 		active object that has pending events and dispatches it to completion. Blocks while
+  * 		no active object has pending events.
+  * @note   An event posted to a higher priority object while a dispatch function runs is
+  * 		dispatched after it returns. The active objects task is preempted by the other tasks
+  * 		like any task, so active objects and blocking tasks can be mixed.
+  * @param  None
+  * @retval None
+  */
+void Active_Task_Handler(void)
+{
+	ActiveObject_t *pAo;
+	ActiveEvent_t Event;
+	uint32_t Priority;
+
+	while(1)
+	{
+		INTERRUPT_DISABLE();
+
+		/* Block until an event is posted */
+		if(gActiveReadySet == 0U)
+		{
+			Task_Block(TASK_BLOCK_FOREVER);
+			INTERRUPT_ENABLE();
+			continue;
+		}
+
+		/* Take the oldest event of the highest priority ready object. The event is copied, so
+		 * its slot can be reused by Active_Post() while the dispatch function runs */
+		Priority = 31U - (uint32_t)__builtin_clz(gActiveReadySet);
+		pAo = gActiveTable[Priority];
+		Event = pAo->queue[pAo->tail & (pAo->size - 1U)];
+		pAo->tail++;
+		if(pAo->tail == pAo->head)
+		{
+			gActiveReadySet &= ~(1U << Priority);
+		}
+
+		INTERRUPT_ENABLE();
+
+		/* Run the event to completion */
+		pAo->dispatch(pAo, &Event);
+	}
+}
@@ -0,0 +1,69 @@
+/**
+ ******************************************************************************
+ * @file           : boot.c
+ * @author         : Noam Yakar
+ * @brief          : This file contains the boot-time profile. The reset handler
+ *                   starts the DWT cycle counter and timestamps the startup
+ *                   phases, main() timestamps its own, and the report prints
+ *                   each phase and the time to the first task.
+ ******************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------- */
+
+#include "boot.h"
+
+#if (BOOT_PROFILE == 1)
+
+/* Global variables --------------------------------------------------------- */
+
+/* Written by the startup code before .bss is zeroed */
+BootProfile_t gBootProfile __attribute__((section(".noinit")));
+
+static const char *gBootPhaseNames[BOOT_NUMBER_OF_PHASES] =
+{
+	[BOOT_PHASE_SYSTEM_INIT]  = "SystemInit  ",
+	[BOOT_PHASE_DATA]         = ".data copy  ",
+	[BOOT_PHASE_BSS]          = ".bss zero   ",
+	[BOOT_PHASE_LIBC_INIT]    = "libc init   ",
+	[BOOT_PHASE_KERNEL_INIT]  = "kernel init ",
+	[BOOT_PHASE_DRIVERS_INIT] = "drivers init",
+	[BOOT_PHASE_FIRST_TASK]   = "first task  ",
+};
+
+/* Functions definitions ---------------------------------------------------- */
+
+/**
+  * @brief  Timestamps the end of a boot phase with the DWT cycle counter.
+  * @param  Phase - The boot phase, a BOOT_PHASE_* value.
+  * @retval None
+  */
+void Boot_Timestamp(uint32_t Phase)
+{
+	gBootProfile.cycles[Phase] = *(volatile uint32_t*)DWT_CYCCNT;
+}
+
+/**
+  * @brief  Prints the duration of each boot phase and the time from the reset handler to the
+  * 		first task, in cycles and in microseconds at the HSI boot clock.
+  * @note   Call before anything else restarts the cycle counter (Cycle_Counter_Init()).
+  * @param  None
+  * @retval None
+  */
+void Boot_Report(void)
+{
+	uint32_t Previous = 0;
+
+	printf("Boot phases, cycles at %luMHz:\n", (unsigned long)(HSI_CLOCK / 1000000U));
+	for(uint32_t i = 0 ; i < BOOT_NUMBER_OF_PHASES ; i++)
+	{
+		uint32_t Cycles = gBootProfile.cycles[i] - Previous;
+		printf("  %s %7lu  %5luus\n", gBootPhaseNames[i], (unsigned long)Cycles,
+		       (unsigned long)(Cycles / (HSI_CLOCK / 1000000U)));
+		Previous = gBootProfile.cycles[i];
+	}
+	printf("Time to first task: %lu cycles, %luus\n", (unsigned long)Previous,
+	       (unsigned long)(Previous / (HSI_CLOCK / 1000000U)));
+}
+
+#endif /* BOOT_PROFILE */
@@ -0,0 +1,124 @@
+/**
+ ******************************************************************************
+ * @file           : budget.c
+ * @author         : Noam Yakar
+ * @brief          : This file contains function definitions for CPU budget
+ *                   enforcement. Each tick is charged to the running task, and
+ *                   a task that exhausts its budget is throttled until the
+ *                   end of its replenishment period.
+ ******************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------- */
+
+#include "budget.h"
+#include "queue.h"
+#include "record.h"
+
+/* Global variables --------------------------------------------------------- */
+
+/* Kernel objects, allocated in main.c */
+extern Queue_t gBlockedQueue;
+extern TaskControlBlock_t *gpCurrentRunningTask;
+extern uint32_t gTickCount;
+
+/* Functions definitions ---------------------------------------------------- */
+
+/**
+  * @brief  Sets the CPU budget of a task. The first replenishment period starts now.
+  * @param  pTask - Pointer to the task.
+  * @param  Budget - Number of ticks the task may run in each period, or BUDGET_UNLIMITED.
+  * @param  Period - Replenishment period in ticks, not less than the budget. Not used for an
+  * 		unlimited task.
+  * @param  pOverrunHandler - Optional function called from SysTick when the task is throttled,
+  * 		can be NULL.
+  * @retval BUDGET_OK, or BUDGET_INVALID if the period is 0 or shorter than the budget.
+  */
+uint8_t Budget_Set(TaskControlBlock_t *pTask, uint32_t Budget, uint32_t Period, void (*pOverrunHandler)(TaskControlBlock_t *pTask))
+{
+	uint32_t PrimaskState;
+
+	/* Budget_Charge() divides by the period */
+	if((Budget != BUDGET_UNLIMITED) && ((Period == 0U) || (Budget > Period)))
+	{
+		return BUDGET_INVALID;
+	}
+
+	/* Disable interrupts, SysTick may charge the task in the middle of the update */
+	INTERRUPT_SAVE_AND_DISABLE(PrimaskState);
+
+	pTask->budget.budget = Budget;
+	pTask->budget.period = Period;
+	pTask->budget.used = 0;
+	pTask->budget.replenish_tick = gTickCount + Period;
+	pTask->budget.overrun_handler = pOverrunHandler;
+
+	/* Restore interrupts */
+	INTERRUPT_RESTORE(PrimaskState);
+
+	return BUDGET_OK;
+}
+
+/**
+  * @brief  Charges the tick that just elapsed to the current running task. Called by the SysTick
+  * 		handler before the global tick count is incremented.
+  * 		Once the task exhausts its budget it is put in THROTTLED state and inserted to the
+  * 		blocked queue until the end of its replenishment period, so Unblock_Tasks() makes it
+  * 		ready again on time. In the cooperative mode the overrun is only reported.
+  * @param  None
+  * @retval None
+  */
+void Budget_Charge(void)
+{
+	TaskControlBlock_t *pTask = gpCurrentRunningTask;
+	TaskBudget_t *pBudget = &(pTask->budget);
+
+	/* Unlimited tasks and tasks that blocked themselves but weren't switched out yet aren't charged */
+	if((pBudget->budget == BUDGET_UNLIMITED) || (pTask->current_state != TASK_READY_STATE))
+	{
+		return;
+	}
+
+	/* The replenishment period has ended, start a new one. The periods are kept aligned to the
+	 * tick at which the budget was set */
+	if((int32_t)(gTickCount - pBudget->replenish_tick) >= 0)
+	{
+		pBudget->used = 0;
+		pBudget->replenish_tick += (((gTickCount - pBudget->replenish_tick) / pBudget->period) + 1) * pBudget->period;
+	}
+
+	pBudget->used++;
+
+#if (SCHED_COOPERATIVE == 1)
+	/* A running task can't be switched out by an interrupt in the cooperative mode. The overrun is
+	 * reported once per period and the task runs on until it yields */
+	if(pBudget->used == pBudget->budget)
+	{
+		pBudget->overruns++;
+
+		RECORD(RECORD_THROTTLE, pTask->task_id, 0, pBudget->replenish_tick);
+
+		if(pBudget->overrun_handler != NULL)
+		{
+			pBudget->overrun_handler(pTask);
+		}
+	}
+#else
+	/* The budget is exhausted, throttle the task until its replenishment */
+	if(pBudget->used >= pBudget->budget)
+	{
+		pBudget->overruns++;
+
+		RECORD(RECORD_THROTTLE, pTask->task_id, 0, pBudget->replenish_tick);
+
+		pTask->current_state = TASK_THROTTLED_STATE;
+		pTask->block_count = pBudget->replenish_tick;
+		gBlockedQueue.ENQUEUE(&(gBlockedQueue.head), pTask, ENQUEUE_SORTED);
+
+		if(pBudget->overrun_handler != NULL)
+		{
+			pBudget->overrun_handler(pTask);
+		}
+	}
+#endif /* SCHED_COOPERATIVE */
+}
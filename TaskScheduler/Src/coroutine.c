@@ -0,0 +1,206 @@
+/**
+ ******************************************************************************
+ * @file           : coroutine.c
+ * @author         : Noam Yakar
+ * @brief          : This file contains function definitions for the stackless
+ *                   coroutines. All coroutines run inside the coroutine task and
+ *                   share its stack, a context-switch between coroutines is a
+ *                   function return and a function call.
+ ******************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------- */
+
+#include "coroutine.h"
+
+/* Global variables --------------------------------------------------------- */
+
+/* Kernel objects, allocated in main.c */
+extern TaskControlBlock_t *pCoroutineTask;
+extern uint32_t gTickCount;
+
+/* The coroutines run by the coroutine task */
+static Coroutine_t *gpCoroutineList = NULL;
+
+/* Set when a coroutine is added or an event is signaled, so the coroutine task doesn't block
+ * before it passes over the coroutines again */
+static volatile uint8_t gCoroutineWakeupPending = 0;
+
+/* Functions definitions ---------------------------------------------------- */
+
+/**
+  * @brief  Adds a coroutine to the coroutine task. The coroutine starts running from CO_BEGIN on
+  * 		the next pass of the coroutine task.
+  * @param  pCo - Pointer to the coroutine object. Must stay allocated while the coroutine runs.
+  * @param  pHandler - Pointer to the coroutine's function.
+  * @param  pContext - Pointer to the coroutine's private data, can be NULL.
+  * @retval None
+  */
+void Coroutine_Create(Coroutine_t *pCo, void (*pHandler)(Coroutine_t *pCo), void *pContext)
+{
+	uint32_t PrimaskState;
+
+	pCo->lc = 0;
+	pCo->state = COROUTINE_READY;
+	pCo->wake_tick = 0;
+	pCo->event = NULL;
+	pCo->handler = pHandler;
+	pCo->context = pContext;
+
+	/* Disable interrupts, the coroutine task may be passing over the list */
+	INTERRUPT_SAVE_AND_DISABLE(PrimaskState);
+
+	pCo->next = gpCoroutineList;
+	gpCoroutineList = pCo;
+	gCoroutineWakeupPending = 1;
+	Task_Unblock(pCoroutineTask);
+
+	/* Restore interrupts */
+	INTERRUPT_RESTORE(PrimaskState);
+}
+
+/**
+  * @brief  Puts a coroutine in DELAYED state. Called by CO_DELAY().
+  * @param  pCo - Pointer to the coroutine.
+  * @param  DelayTickCount - Specifies the duration in terms of SysTick ticks the coroutine sleeps.
+  * @retval None
+  */
+void Coroutine_Delay(Coroutine_t *pCo, uint32_t DelayTickCount)
+{
+	pCo->wake_tick = gTickCount + DelayTickCount;
+	pCo->state = COROUTINE_DELAYED;
+}
+
+/**
+  * @brief  Puts a coroutine in WAITING_EVENT state. Called by CO_WAIT_EVENT().
+  * @param  pCo - Pointer to the coroutine.
+  * @param  pEvent - Pointer to the event.
+  * @retval None
+  */
+void Coroutine_Wait_Event(Coroutine_t *pCo, CoroutineEvent_t *pEvent)
+{
+	pCo->event = pEvent;
+	pCo->state = COROUTINE_WAITING_EVENT;
+}
+
+/**
+  * @brief  Signals an event and wakes up the coroutine task.
+  * @note   Can be called from ISRs and from tasks.
+  * @param  pEvent - Pointer to the event.
+  * @retval None
+  */
+void Coroutine_Event_Signal(CoroutineEvent_t *pEvent)
+{
+	uint32_t PrimaskState;
+
+	/* Disable interrupts */
+	INTERRUPT_SAVE_AND_DISABLE(PrimaskState);
+
+	pEvent->count++;
+	gCoroutineWakeupPending = 1;
+	Task_Unblock(pCoroutineTask);
+
+	/* Restore interrupts */
+	INTERRUPT_RESTORE(PrimaskState);
+}
+
+/**
+  * @brief  Handler of the coroutine task. Passes over the coroutines and runs the ready ones.
+  * 		When no coroutine is ready, the task blocks until the earliest coroutine delay expires
+  * 		or an event is signaled.
+  * @param  None
+  * @retval None
+  */
+void Coroutine_Task_Handler(void)
+{
+	Coroutine_t **pLink;
+	Coroutine_t *pCo;
+	uint32_t Ran;
+	uint32_t Delayed;
+	uint32_t Timeout;
+
+	while(1)
+	{
+		Ran = 0;
+		Delayed = 0;
+		Timeout = 0xFFFFFFFFU;
+		gCoroutineWakeupPending = 0;
+
+		pLink = &gpCoroutineList;
+		while((pCo = *pLink) != NULL)
+		{
+			/* Wake up coroutines whose delay expired or whose event was signaled */
+			if(pCo->state == COROUTINE_DELAYED)
+			{
+				if((int32_t)(gTickCount - pCo->wake_tick) >= 0)
+				{
+					pCo->state = COROUTINE_READY;
+				}
+			}
+			else if(pCo->state == COROUTINE_WAITING_EVENT)
+			{
+				INTERRUPT_DISABLE();
+				if(pCo->event->count != 0)
+				{
+					pCo->event->count--;
+					pCo->state = COROUTINE_READY;
+				}
+				INTERRUPT_ENABLE();
+			}
+
+			/* Resume the coroutine from its last wait point */
+			if(pCo->state == COROUTINE_READY)
+			{
+				pCo->handler(pCo);
+				Ran++;
+			}
+
+			/* Keep track of the earliest delay */
+			if(pCo->state == COROUTINE_DELAYED)
+			{
+				uint32_t Remaining = pCo->wake_tick - gTickCount;
+				if((int32_t)Remaining <= 0)
+				{
+					Remaining = 1;
+				}
+				if(Remaining < Timeout)
+				{
+					Timeout = Remaining;
+				}
+				Delayed++;
+			}
+
+			/* Remove finished coroutines from the list */
+			if(pCo->state == COROUTINE_DONE)
+			{
+				INTERRUPT_DISABLE();
+				/* A coroutine started while this one ran was pushed at the head of the list, the
+				 * link may no longer point at it */
+				if(*pLink != pCo)
+				{
+					for(pLink = &gpCoroutineList; *pLink != pCo; pLink = &((*pLink)->next))
+					{
+					}
+				}
+				*pLink = pCo->next;
+				INTERRUPT_ENABLE();
+			}
+			else
+			{
+				pLink = &(pCo->next);
+			}
+		}
+
+		/* Block until the earliest delay expires or an event is signaled. A coroutine that ran may
+		 * be polling a condition with CO_WAIT_UNTIL, so the task only blocks after an idle pass */
+		if(Ran == 0)
+		{
+			INTERRUPT_DISABLE();
+			if(!gCoroutineWakeupPending)
+			{
+				Task_Block((Delayed != 0) ? Timeout : TASK_BLOCK_FOREVER);
+			}
+			INTERRUPT_ENABLE();
+		}
+	}
+}
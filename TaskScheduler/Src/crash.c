@@ -0,0 +1,183 @@
+/**
+ ******************************************************************************
+ * @file           : crash.c
+ * @author         : Noam Yakar
+ * @brief          : This file contains the post-mortem crash capture. The fault
+ *                   handlers pass the stacked exception frame to
+ *                   Crash_Capture(), which writes it to a crash record in
+ *                   no-init RAM with the fault status registers, the running
+ *                   task and the latest scheduler events, then resets the core.
+ *                   On the next boot Crash_Report() prints the record, decoded
+ *                   against the ELF on the host by Tools/crash_decode.
+ ******************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------- */
+
+#include <stddef.h>
+#include "crash.h"
+
+#if (CRASH_CAPTURE == 1)
+
+/* Global variables --------------------------------------------------------- */
+
+/* Kernel objects, allocated in main.c */
+extern TaskControlBlock_t *gpCurrentRunningTask;
+extern uint32_t gTickCount;
+
+#if (RECORD_ENABLE == 1)
+/* The recorder's circular log */
+extern RecordLog_t gRecordLog;
+#endif
+
+/* Neither zeroed nor initialized at boot, the record survives the reset */
+CrashRecord_t gCrashRecord __attribute__((section(".noinit")));
+
+static const char *gCrashExceptionNames[] =
+{
+	[3] = "HardFault",
+	[4] = "MemManage",
+	[5] = "BusFault",
+	[6] = "UsageFault",
+};
+
+/* Private functions definitions -------------------------------------------- */
+
+/**
+  * @brief  Computes the checksum of a crash record, the complement of the sum of its words up to
+  * 		the checksum. Random RAM contents at power-up don't pass for a record.
+  * @param  pRecord - Pointer to the crash record.
+  * @retval The checksum.
+  */
+static uint32_t Crash_Checksum(const CrashRecord_t *pRecord)
+{
+	const uint32_t *pWord = (const uint32_t*)pRecord;
+	uint32_t Sum = 0;
+
+	for(uint32_t i = 0 ; i < (offsetof(CrashRecord_t, checksum) / sizeof(uint32_t)) ; i++)
+	{
+		Sum += pWord[i];
+	}
+
+	return ~Sum;
+}
+
+/* Functions definitions ---------------------------------------------------- */
+
+/**
+  * @brief  Writes the crash record and resets the core. Branched to by the fault handlers.
+  * @param  pFrame - Pointer to the exception frame, on the MSP or the PSP as selected by EXC_RETURN.
+  * @param  ExcReturn - The fault's EXC_RETURN.
+  * @retval None
+  */
+void Crash_Capture(uint32_t *pFrame, uint32_t ExcReturn)
+{
+	CrashRecord_t *pRecord = &gCrashRecord;
+	uint32_t *pAIRCR = (uint32_t*)AIRCR;
+	uint32_t Ipsr;
+	uint32_t State;
+
+	/* Nothing preempts the capture */
+	INTERRUPT_MASK_ALL_SAVE(State);
+	(void)State;
+
+	__asm volatile ("MRS %0,IPSR" : "=r" (Ipsr));
+
+	pRecord->magic = 0;
+	pRecord->size = sizeof(CrashRecord_t);
+	pRecord->exception = Ipsr & 0x1FFU;
+	pRecord->exc_return = ExcReturn;
+	pRecord->cfsr = *(volatile uint32_t*)CFSR;
+	pRecord->hfsr = *(volatile uint32_t*)HFSR;
+	pRecord->mmfar = *(volatile uint32_t*)MMFAR;
+	pRecord->bfar = *(volatile uint32_t*)BFAR;
+
+	/* After a stacking error the frame holds no registers, and reading it may fault again */
+	if(pRecord->cfsr & CRASH_CFSR_STACKING)
+	{
+		for(uint32_t i = 0 ; i < CRASH_FRAME_WORDS ; i++)
+		{
+			pRecord->frame[i] = 0;
+		}
+		pRecord->sp = (uint32_t)pFrame;
+	}
+	else
+	{
+		for(uint32_t i = 0 ; i < CRASH_FRAME_WORDS ; i++)
+		{
+			pRecord->frame[i] = pFrame[i];
+		}
+
+		/* The stack pointer before the exception entry: above the frame, the extended frame's
+		 * S0-S15 and FPSCR if EXC_RETURN bit 4 is cleared, and the alignment word if xPSR bit 9
+		 * is set */
+		pRecord->sp = (uint32_t)(pFrame + CRASH_FRAME_WORDS + (((ExcReturn & ( 1 << 4)) == 0U) ? 18U : 0U) +
+		                         ((pRecord->frame[CRASH_FRAME_XPSR] & ( 1 << 9)) ? 1U : 0U));
+	}
+
+	pRecord->task_id = (gpCurrentRunningTask != NULL) ? gpCurrentRunningTask->task_id : RECORD_NO_TASK;
+	pRecord->tick = gTickCount;
+
+#if (RECORD_ENABLE == 1)
+	pRecord->trace_count = (gRecordLog.head < CRASH_TRACE_SIZE) ? gRecordLog.head : CRASH_TRACE_SIZE;
+	for(uint32_t i = 0 ; i < pRecord->trace_count ; i++)
+	{
+		pRecord->trace[i] = gRecordLog.entries[(gRecordLog.head - pRecord->trace_count + i) & RECORD_MASK];
+	}
+#else
+	pRecord->trace_count = 0;
+#endif
+
+	pRecord->magic = CRASH_MAGIC;
+	pRecord->checksum = Crash_Checksum(pRecord);
+
+	/* Request a system reset, the record is reported on the next boot */
+	__asm volatile ("DSB" : : : "memory");
+	*pAIRCR = (0x05FAU << 16) | ( 1 << 2); /* VECTKEY, SYSRESETREQ */
+	__asm volatile ("DSB" : : : "memory");
+
+	while(1);
+}
+
+/**
+  * @brief  Prints the crash record left by the last reset, if any: a summary, and the record on a
+  * 		line of hex words for Tools/crash_decode. The record is then invalidated.
+  * @note   Called by main() once the UART is initialized, the output goes to the console (ITM or UART).
+  * @param  None
+  * @retval None
+  */
+void Crash_Report(void)
+{
+	CrashRecord_t *pRecord = &gCrashRecord;
+	const uint32_t *pWord = (const uint32_t*)pRecord;
+	const char *pName = "Fault";
+
+	if((pRecord->magic != CRASH_MAGIC) || (pRecord->size != sizeof(CrashRecord_t)) ||
+	   (pRecord->checksum != Crash_Checksum(pRecord)))
+	{
+		return;
+	}
+
+	if((pRecord->exception < (sizeof(gCrashExceptionNames) / sizeof(gCrashExceptionNames[0]))) &&
+	   (gCrashExceptionNames[pRecord->exception] != NULL))
+	{
+		pName = gCrashExceptionNames[pRecord->exception];
+	}
+
+	printf("Crash: %s in task %lu at tick %lu, PC 0x%08lx LR 0x%08lx CFSR 0x%08lx\n", pName,
+	       (unsigned long)pRecord->task_id, (unsigned long)pRecord->tick,
+	       (unsigned long)pRecord->frame[CRASH_FRAME_PC], (unsigned long)pRecord->frame[CRASH_FRAME_LR],
+	       (unsigned long)pRecord->cfsr);
+
+	printf(CRASH_LINE_PREFIX);
+	for(uint32_t i = 0 ; i < (sizeof(CrashRecord_t) / sizeof(uint32_t)) ; i++)
+	{
+		printf(" %08lx", (unsigned long)pWord[i]);
+	}
+	printf("\n");
+
+	/* Reported once */
+	pRecord->magic = 0;
+}
+
+#endif /* CRASH_CAPTURE */
@@ -0,0 +1,325 @@
+/**
+ ******************************************************************************
+ * @file           : dsp.c
+ * @author         : Noam Yakar
+ * @brief          : This file contains the FIR and biquad filter kernels.
+ *                   Each filter has three variants:
+ *                   - Soft-float, calling the AEABI soft-float routines even in
+ *                     a hard-float build.
+ *                   - Float, compiled for the FPU in a hard-float build.
+ *                   - Q15, using the SIMD DSP instructions (SMLAD, SMLALD) of
+ *                     the Cortex-M4 on pairs of 16-bit samples.
+ ******************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------- */
+
+#include <string.h>
+#include "dsp.h"
+
+/* Macros ------------------------------------------------------------------- */
+
+/* The AEABI soft-float routines always use the base procedure call standard, also in a
+ * hard-float build where float arguments are otherwise passed in FPU registers */
+#if defined(__ARM_PCS_VFP)
+#define DSP_SOFT_PCS             __attribute__((pcs("aapcs")))
+#else
+#define DSP_SOFT_PCS
+#endif
+
+/* Q14 scaling of the Q15 biquad coefficients, allowing coefficients in [-2, 2) */
+#define DSP_Q14_ONE              16384.0f
+#define DSP_Q14_SHIFT            14U
+#define DSP_Q15_SHIFT            15U
+
+/* Soft-float routines of libgcc */
+extern float __aeabi_fadd(float a, float b) DSP_SOFT_PCS;
+extern float __aeabi_fsub(float a, float b) DSP_SOFT_PCS;
+extern float __aeabi_fmul(float a, float b) DSP_SOFT_PCS;
+
+/* Private functions definitions -------------------------------------------- */
+
+/**
+  * @brief  Dual 16-bit multiply with 32-bit accumulate: Acc + X.lo * Y.lo + X.hi * Y.hi
+  * @param  X - Pair of Q15 values.
+  * @param  Y - Pair of Q15 values.
+  * @param  Acc - Accumulator.
+  * @retval The accumulator.
+  */
+static inline int32_t Dsp_Smlad(uint32_t X, uint32_t Y, int32_t Acc)
+{
+#if defined(__ARM_FEATURE_DSP)
+	__asm ("SMLAD %0,%1,%2,%3" : "=r" (Acc) : "r" (X), "r" (Y), "r" (Acc));
+	return Acc;
+#else
+	return Acc + ((int16_t)X * (int16_t)Y) + ((int16_t)(X >> 16) * (int16_t)(Y >> 16));
+#endif
+}
+
+/**
+  * @brief  Dual 16-bit multiply with 64-bit accumulate: Acc + X.lo * Y.lo + X.hi * Y.hi
+  * @param  X - Pair of Q15 values.
+  * @param  Y - Pair of Q15 values.
+  * @param  Acc - Accumulator.
+  * @retval The accumulator.
+  */
+static inline int64_t Dsp_Smlald(uint32_t X, uint32_t Y, int64_t Acc)
+{
+#if defined(__ARM_FEATURE_DSP)
+	__asm ("SMLALD %Q0,%R0,%1,%2" : "+r" (Acc) : "r" (X), "r" (Y));
+	return Acc;
+#else
+	return Acc + ((int16_t)X * (int16_t)Y) + ((int16_t)(X >> 16) * (int16_t)(Y >> 16));
+#endif
+}
+
+/**
+  * @brief  Saturates a value to the Q15 range.
+  * @param  Value - The value to saturate.
+  * @retval The saturated value.
+  */
+static inline int16_t Dsp_Sat_Q15(int32_t Value)
+{
+#if defined(__ARM_FEATURE_DSP)
+	__asm ("SSAT %0,#16,%1" : "=r" (Value) : "r" (Value));
+	return (int16_t)Value;
+#else
+	return (Value > INT16_MAX) ? INT16_MAX : ((Value < INT16_MIN) ? INT16_MIN : (int16_t)Value);
+#endif
+}
+
+/**
+  * @brief  Reads two consecutive Q15 values as one word. The address doesn't have to be
+  * 		word aligned, the Cortex-M4 handles the unaligned LDR.
+  * @param  pValues - Pointer to the first value.
+  * @retval The first value in the low half-word, the second in the high half-word.
+  */
+static inline uint32_t Dsp_Read_Pair(const int16_t *pValues)
+{
+	uint32_t Pair;
+
+	memcpy(&Pair, pValues, sizeof(Pair));
+
+	return Pair;
+}
+
+/* Functions definitions ---------------------------------------------------- */
+
+/**
+  * @brief  FIR filter, float variant.
+  * @param  pCoeffs - Pointer to NumTaps coefficients, in time-reversed order.
+  * @param  pState - Pointer to the state buffer of (NumTaps - 1 + BlockSize) samples. The first
+  * 		NumTaps - 1 samples hold the previous inputs and must be zeroed before the first call.
+  * @param  NumTaps - Number of filter coefficients.
+  * @param  pIn - Pointer to BlockSize input samples.
+  * @param  pOut - Pointer to BlockSize output samples.
+  * @param  BlockSize - Number of samples to filter.
+  * @retval None
+  */
+void Fir_F32(const float *pCoeffs, float *pState, uint32_t NumTaps, const float *pIn, float *pOut, uint32_t BlockSize)
+{
+	memcpy(&pState[NumTaps - 1], pIn, BlockSize * sizeof(float));
+
+	for(uint32_t n = 0 ; n < BlockSize ; n++)
+	{
+		float Acc = 0.0f;
+
+		for(uint32_t k = 0 ; k < NumTaps ; k++)
+		{
+			Acc += pCoeffs[k] * pState[n + k];
+		}
+		pOut[n] = Acc;
+	}
+
+	/* Keep the last NumTaps - 1 inputs for the next block */
+	memmove(pState, &pState[BlockSize], (NumTaps - 1) * sizeof(float));
+}
+
+/**
+  * @brief  FIR filter, soft-float variant. Same parameters as Fir_F32().
+  * @retval None
+  */
+void Fir_F32_Soft(const float *pCoeffs, float *pState, uint32_t NumTaps, const float *pIn, float *pOut, uint32_t BlockSize)
+{
+	memcpy(&pState[NumTaps - 1], pIn, BlockSize * sizeof(float));
+
+	for(uint32_t n = 0 ; n < BlockSize ; n++)
+	{
+		float Acc = 0.0f;
+
+		for(uint32_t k = 0 ; k < NumTaps ; k++)
+		{
+			Acc = __aeabi_fadd(Acc, __aeabi_fmul(pCoeffs[k], pState[n + k]));
+		}
+		pOut[n] = Acc;
+	}
+
+	memmove(pState, &pState[BlockSize], (NumTaps - 1) * sizeof(float));
+}
+
+/**
+  * @brief  FIR filter, Q15 SIMD variant. Two taps are computed by each SMLALD, the products
+  * 		are accumulated in 64 bits and the result is saturated to Q15.
+  * @param  pCoeffs - Pointer to NumTaps Q15 coefficients, in time-reversed order.
+  * @param  pState - Pointer to the state buffer of (NumTaps - 1 + BlockSize) samples, see Fir_F32().
+  * @param  NumTaps - Number of filter coefficients, must be even.
+  * @param  pIn - Pointer to BlockSize input samples.
+  * @param  pOut - Pointer to BlockSize output samples.
+  * @param  BlockSize - Number of samples to filter.
+  * @retval None
+  */
+void Fir_Q15(const int16_t *pCoeffs, int16_t *pState, uint32_t NumTaps, const int16_t *pIn, int16_t *pOut, uint32_t BlockSize)
+{
+	memcpy(&pState[NumTaps - 1], pIn, BlockSize * sizeof(int16_t));
+
+	for(uint32_t n = 0 ; n < BlockSize ; n++)
+	{
+		int64_t Acc = 0;
+
+		for(uint32_t k = 0 ; k < NumTaps ; k += 2)
+		{
+			Acc = Dsp_Smlald(Dsp_Read_Pair(&pCoeffs[k]), Dsp_Read_Pair(&pState[n + k]), Acc);
+		}
+		pOut[n] = Dsp_Sat_Q15((int32_t)(Acc >> DSP_Q15_SHIFT));
+	}
+
+	memmove(pState, &pState[BlockSize], (NumTaps - 1) * sizeof(int16_t));
+}
+
+/**
+  * @brief  Initializes a float biquad section and clears its state.
+  * @param  pBiquad - Pointer to the biquad section.
+  * @param  b0, b1, b2 - Feed-forward coefficients.
+  * @param  a1, a2 - Feedback coefficients, a0 is normalized to 1.
+  * @retval None
+  */
+void Biquad_F32_Init(BiquadF32_t *pBiquad, float b0, float b1, float b2, float a1, float a2)
+{
+	pBiquad->b0 = b0;
+	pBiquad->b1 = b1;
+	pBiquad->b2 = b2;
+	pBiquad->a1 = a1;
+	pBiquad->a2 = a2;
+	pBiquad->x1 = 0.0f;
+	pBiquad->x2 = 0.0f;
+	pBiquad->y1 = 0.0f;
+	pBiquad->y2 = 0.0f;
+}
+
+/**
+  * @brief  Biquad filter, float variant.
+  * @param  pBiquad - Pointer to the biquad section.
+  * @param  pIn - Pointer to BlockSize input samples.
+  * @param  pOut - Pointer to BlockSize output samples.
+  * @param  BlockSize - Number of samples to filter.
+  * @retval None
+  */
+void Biquad_F32(BiquadF32_t *pBiquad, const float *pIn, float *pOut, uint32_t BlockSize)
+{
+	float x1 = pBiquad->x1, x2 = pBiquad->x2, y1 = pBiquad->y1, y2 = pBiquad->y2;
+
+	for(uint32_t n = 0 ; n < BlockSize ; n++)
+	{
+		float x0 = pIn[n];
+		float y0 = pBiquad->b0 * x0 + pBiquad->b1 * x1 + pBiquad->b2 * x2 - pBiquad->a1 * y1 - pBiquad->a2 * y2;
+
+		x2 = x1;
+		x1 = x0;
+		y2 = y1;
+		y1 = y0;
+		pOut[n] = y0;
+	}
+
+	pBiquad->x1 = x1;
+	pBiquad->x2 = x2;
+	pBiquad->y1 = y1;
+	pBiquad->y2 = y2;
+}
+
+/**
+  * @brief  Biquad filter, soft-float variant. Same parameters as Biquad_F32().
+  * @retval None
+  */
+void Biquad_F32_Soft(BiquadF32_t *pBiquad, const float *pIn, float *pOut, uint32_t BlockSize)
+{
+	float x1 = pBiquad->x1, x2 = pBiquad->x2, y1 = pBiquad->y1, y2 = pBiquad->y2;
+
+	for(uint32_t n = 0 ; n < BlockSize ; n++)
+	{
+		float x0 = pIn[n];
+		float y0 = __aeabi_fmul(pBiquad->b0, x0);
+
+		y0 = __aeabi_fadd(y0, __aeabi_fmul(pBiquad->b1, x1));
+		y0 = __aeabi_fadd(y0, __aeabi_fmul(pBiquad->b2, x2));
+		y0 = __aeabi_fsub(y0, __aeabi_fmul(pBiquad->a1, y1));
+		y0 = __aeabi_fsub(y0, __aeabi_fmul(pBiquad->a2, y2));
+
+		x2 = x1;
+		x1 = x0;
+		y2 = y1;
+		y1 = y0;
+		pOut[n] = y0;
+	}
+
+	pBiquad->x1 = x1;
+	pBiquad->x2 = x2;
+	pBiquad->y1 = y1;
+	pBiquad->y2 = y2;
+}
+
+/**
+  * @brief  Initializes a Q15 biquad section from float coefficients and clears its state.
+  * @param  pBiquad - Pointer to the biquad section.
+  * @param  b0, b1, b2 - Feed-forward coefficients, in [-2, 2).
+  * @param  a1, a2 - Feedback coefficients, in [-2, 2), a0 is normalized to 1.
+  * @retval None
+  */
+void Biquad_Q15_Init(BiquadQ15_t *pBiquad, float b0, float b1, float b2, float a1, float a2)
+{
+	uint16_t B0 = (uint16_t)(int16_t)(b0 * DSP_Q14_ONE);
+	uint16_t B1 = (uint16_t)(int16_t)(b1 * DSP_Q14_ONE);
+	uint16_t B2 = (uint16_t)(int16_t)(b2 * DSP_Q14_ONE);
+	uint16_t NA1 = (uint16_t)(int16_t)(-a1 * DSP_Q14_ONE);
+
+	pBiquad->b0_b1 = ((uint32_t)B1 << 16) | B0;
+	pBiquad->b2_na1 = ((uint32_t)NA1 << 16) | B2;
+	pBiquad->na2 = (int16_t)(-a2 * DSP_Q14_ONE);
+	pBiquad->x1 = 0;
+	pBiquad->x2 = 0;
+	pBiquad->y1 = 0;
+	pBiquad->y2 = 0;
+}
+
+/**
+  * @brief  Biquad filter, Q15 SIMD variant. Each output takes two SMLAD on the sample pairs
+  * 		(x0, x1) and (x2, y1), and one multiply-accumulate for y2.
+  * @param  pBiquad - Pointer to the biquad section.
+  * @param  pIn - Pointer to BlockSize input samples.
+  * @param  pOut - Pointer to BlockSize output samples.
+  * @param  BlockSize - Number of samples to filter.
+  * @retval None
+  */
+void Biquad_Q15(BiquadQ15_t *pBiquad, const int16_t *pIn, int16_t *pOut, uint32_t BlockSize)
+{
+	int16_t x1 = pBiquad->x1, x2 = pBiquad->x2, y1 = pBiquad->y1, y2 = pBiquad->y2;
+
+	for(uint32_t n = 0 ; n < BlockSize ; n++)
+	{
+		int16_t x0 = pIn[n];
+		int32_t Acc = pBiquad->na2 * y2;
+
+		Acc = Dsp_Smlad(((uint32_t)(uint16_t)x1 << 16) | (uint16_t)x0, pBiquad->b0_b1, Acc);
+		Acc = Dsp_Smlad(((uint32_t)(uint16_t)y1 << 16) | (uint16_t)x2, pBiquad->b2_na1, Acc);
+
+		x2 = x1;
+		x1 = x0;
+		y2 = y1;
+		y1 = Dsp_Sat_Q15(Acc >> DSP_Q14_SHIFT);
+		pOut[n] = y1;
+	}
+
+	pBiquad->x1 = x1;
+	pBiquad->x2 = x2;
+	pBiquad->y1 = y1;
+	pBiquad->y2 = y2;
+}
@@ -0,0 +1,201 @@
+/**
+ ******************************************************************************
+ * @file           : dsp_bench.c
+ * @author         : Noam Yakar
+ * @brief          : This file contains the DSP kernels benchmark. The FIR and
+ *                   biquad filters are run over the same input in their
+ *                   soft-float, float and Q15 SIMD variants, and the cost of
+ *                   each variant is measured with DWT CYCCNT.
+ *                   Enabled by DSP_BENCHMARK in task_config.h.
+ ******************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------- */
+
+#include "dsp.h"
+
+#if (DSP_BENCHMARK == 1)
+
+/* Macros ------------------------------------------------------------------- */
+
+/* Biquad coefficients of the benchmark: 2nd order Butterworth low-pass, fc = 1KHz at fs = 48KHz */
+#define BENCH_BIQUAD_B0          0.00391613f
+#define BENCH_BIQUAD_B1          0.00783225f
+#define BENCH_BIQUAD_B2          0.00391613f
+#define BENCH_BIQUAD_A1          (-1.81534108f)
+#define BENCH_BIQUAD_A2          0.83100559f
+
+/* Types -------------------------------------------------------------------- */
+
+/* The kernel variants measured by the benchmark */
+typedef enum
+{
+	BENCH_SOFT_FLOAT,
+	BENCH_HARD_FLOAT,
+	BENCH_SIMD_Q15,
+	BENCH_NUMBER_OF_VARIANTS
+} BenchVariant_e;
+
+/* Global variables --------------------------------------------------------- */
+
+static float gBenchInF32[DSP_BLOCK_SIZE];
+static float gBenchOutF32[DSP_BLOCK_SIZE];
+static float gBenchFirStateF32[DSP_FIR_TAPS - 1 + DSP_BLOCK_SIZE];
+static float gBenchFirCoeffsF32[DSP_FIR_TAPS];
+static int16_t gBenchInQ15[DSP_BLOCK_SIZE];
+static int16_t gBenchOutQ15[DSP_BLOCK_SIZE];
+static int16_t gBenchFirStateQ15[DSP_FIR_TAPS - 1 + DSP_BLOCK_SIZE];
+static int16_t gBenchFirCoeffsQ15[DSP_FIR_TAPS];
+static BiquadF32_t gBenchBiquadF32;
+static BiquadQ15_t gBenchBiquadQ15;
+
+/* Total cycles of each kernel variant */
+uint32_t gFirBenchCycles[BENCH_NUMBER_OF_VARIANTS];
+uint32_t gBiquadBenchCycles[BENCH_NUMBER_OF_VARIANTS];
+
+/* Functions definitions ---------------------------------------------------- */
+
+/**
+  * @brief  Fills the input blocks with pseudo-random samples in [-0.5, 0.5) and the FIR
+  * 		coefficients with a normalized triangular low-pass window.
+  * @param  None
+  * @retval None
+  */
+static void Bench_Signals_Init(void)
+{
+	uint32_t Seed = 0x12345678U;
+	float Sum = 0.0f;
+
+	for(uint32_t n = 0 ; n < DSP_BLOCK_SIZE ; n++)
+	{
+		Seed = Seed * 1664525U + 1013904223U;
+		gBenchInQ15[n] = (int16_t)(Seed >> 16) / 2;
+		gBenchInF32[n] = (float)gBenchInQ15[n] / 32768.0f;
+	}
+
+	for(uint32_t k = 0 ; k < DSP_FIR_TAPS ; k++)
+	{
+		gBenchFirCoeffsF32[k] = (float)((k < DSP_FIR_TAPS / 2U) ? (k + 1U) : (DSP_FIR_TAPS - k));
+		Sum += gBenchFirCoeffsF32[k];
+	}
+	for(uint32_t k = 0 ; k < DSP_FIR_TAPS ; k++)
+	{
+		gBenchFirCoeffsF32[k] /= Sum;
+		gBenchFirCoeffsQ15[k] = (int16_t)(gBenchFirCoeffsF32[k] * 32768.0f);
+	}
+}
+
+/**
+  * @brief  Runs one block of a kernel variant with interrupts disabled.
+  * @param  Variant - The kernel variant.
+  * @param  Biquad - 1 to run the biquad filter, 0 to run the FIR filter.
+  * @retval Cycles spent in the kernel.
+  */
+static uint32_t Bench_Run_Block(BenchVariant_e Variant, uint8_t Biquad)
+{
+	volatile uint32_t *pDWT_CYCCNT = (uint32_t*)DWT_CYCCNT;
+	uint32_t State;
+	uint32_t Start;
+	uint32_t Cycles;
+
+	INTERRUPT_MASK_ALL_SAVE(State);
+	Start = *pDWT_CYCCNT;
+
+	if(Biquad)
+	{
+		if(Variant == BENCH_SOFT_FLOAT)
+		{
+			Biquad_F32_Soft(&gBenchBiquadF32, gBenchInF32, gBenchOutF32, DSP_BLOCK_SIZE);
+		}
+		else if(Variant == BENCH_HARD_FLOAT)
+		{
+			Biquad_F32(&gBenchBiquadF32, gBenchInF32, gBenchOutF32, DSP_BLOCK_SIZE);
+		}
+		else
+		{
+			Biquad_Q15(&gBenchBiquadQ15, gBenchInQ15, gBenchOutQ15, DSP_BLOCK_SIZE);
+		}
+	}
+	else
+	{
+		if(Variant == BENCH_SOFT_FLOAT)
+		{
+			Fir_F32_Soft(gBenchFirCoeffsF32, gBenchFirStateF32, DSP_FIR_TAPS, gBenchInF32, gBenchOutF32, DSP_BLOCK_SIZE);
+		}
+		else if(Variant == BENCH_HARD_FLOAT)
+		{
+			Fir_F32(gBenchFirCoeffsF32, gBenchFirStateF32, DSP_FIR_TAPS, gBenchInF32, gBenchOutF32, DSP_BLOCK_SIZE);
+		}
+		else
+		{
+			Fir_Q15(gBenchFirCoeffsQ15, gBenchFirStateQ15, DSP_FIR_TAPS, gBenchInQ15, gBenchOutQ15, DSP_BLOCK_SIZE);
+		}
+	}
+
+	Cycles = *pDWT_CYCCNT - Start;
+	INTERRUPT_MASK_ALL_RESTORE(State);
+
+	return Cycles;
+}
+
+/**
+  * @brief  Prints the cycles per sample of the three variants of a filter, with two decimals.
+  * @param  pName - The filter's name.
+  * @param  pCycles - Total cycles of each variant.
+  * @retval None
+  */
+static void Bench_Print(const char *pName, const uint32_t *pCycles)
+{
+	const uint32_t Samples = DSP_BENCHMARK_ROUNDS * DSP_BLOCK_SIZE;
+	uint32_t Centi[BENCH_NUMBER_OF_VARIANTS];
+
+	for(uint32_t v = 0 ; v < BENCH_NUMBER_OF_VARIANTS ; v++)
+	{
+		Centi[v] = (uint32_t)(((uint64_t)pCycles[v] * 100U) / Samples);
+	}
+
+	printf("%s cycles/sample: soft-float %lu.%02lu, hard-float %lu.%02lu, SIMD q15 %lu.%02lu\n", pName,
+	       (unsigned long)(Centi[BENCH_SOFT_FLOAT] / 100U), (unsigned long)(Centi[BENCH_SOFT_FLOAT] % 100U),
+	       (unsigned long)(Centi[BENCH_HARD_FLOAT] / 100U), (unsigned long)(Centi[BENCH_HARD_FLOAT] % 100U),
+	       (unsigned long)(Centi[BENCH_SIMD_Q15] / 100U), (unsigned long)(Centi[BENCH_SIMD_Q15] % 100U));
+}
+
+/**
+  * @brief  Handler of the DSP benchmark task. Measures DSP_BENCHMARK_ROUNDS blocks of each
+  * 		kernel variant and prints the cycles per sample.
+  * @note   The hard-float variant runs on the FPU only in the Release configuration, in the
+  * 		soft-float Debug configuration the compiler emulates it like the soft-float variant.
+  * @param  None
+  * @retval None
+  */
+void Dsp_Benchmark_Task_Handler(void)
+{
+	Cycle_Counter_Init();
+	Bench_Signals_Init();
+	Biquad_F32_Init(&gBenchBiquadF32, BENCH_BIQUAD_B0, BENCH_BIQUAD_B1, BENCH_BIQUAD_B2, BENCH_BIQUAD_A1, BENCH_BIQUAD_A2);
+	Biquad_Q15_Init(&gBenchBiquadQ15, BENCH_BIQUAD_B0, BENCH_BIQUAD_B1, BENCH_BIQUAD_B2, BENCH_BIQUAD_A1, BENCH_BIQUAD_A2);
+
+	for(uint32_t i = 0 ; i < DSP_BENCHMARK_ROUNDS ; i++)
+	{
+		for(BenchVariant_e v = BENCH_SOFT_FLOAT ; v < BENCH_NUMBER_OF_VARIANTS ; v++)
+		{
+			gFirBenchCycles[v] += Bench_Run_Block(v, 0);
+			gBiquadBenchCycles[v] += Bench_Run_Block(v, 1);
+		}
+	}
+
+#if defined(__ARM_PCS_VFP)
+	printf("DSP benchmark, hard-float build\n");
+#else
+	printf("DSP benchmark, soft-float build (the hard-float variant is emulated)\n");
+#endif
+	Bench_Print("FIR", gFirBenchCycles);
+	Bench_Print("Biquad", gBiquadBenchCycles);
+
+	while(1)
+	{
+		Task_Delay(DELAY_1S);
+	}
+}
+
+#endif /* DSP_BENCHMARK */
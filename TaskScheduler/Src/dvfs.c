@@ -0,0 +1,295 @@
+/**
+ ******************************************************************************
+ * @file           : dvfs.c
+ * @author         : Noam Yakar
+ * @brief          : This file contains the operating points and the load-driven
+ *                   frequency governor. The governor samples the busy ratio of
+ *                   the idle-time statistics every DVFS_WINDOW_TICKS, jumps to
+ *                   the fastest point under a burst and steps down one point at
+ *                   a time when the load would still fit the slower point. On
+ *                   every switch the SysTick reload is recomputed, so the tick
+ *                   stays 1ms, and the clock change hooks reprogram the
+ *                   drivers' bus clock dependent rates.
+ ******************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------- */
+
+#include "dvfs.h"
+#include "idle.h"
+
+/* Macros ------------------------------------------------------------------- */
+
+/* RCC registers */
+#define RCC_CR                   ( (RCC_AHB1_BASE) + 0x00U )
+#define RCC_PLLCFGR              ( (RCC_AHB1_BASE) + 0x04U )
+#define RCC_CFGR                 ( (RCC_AHB1_BASE) + 0x08U )
+
+/* Flash access control register */
+#define FLASH_ACR                0x40023C00U
+
+/* PLL from the HSI: VCO input 16MHz / 8 = 2MHz, VCO output 2MHz * 168 = 336MHz, system clock
+ * 336MHz / 2 = 168MHz, USB/SDIO clock 336MHz / 7 = 48MHz */
+#define DVFS_PLL_M               8U
+#define DVFS_PLL_N               168U
+#define DVFS_PLL_P               0U    /* PLLP field, divides by 2 */
+#define DVFS_PLL_Q               7U
+#define DVFS_PLL_CLOCK           ( ((HSI_CLOCK) / (DVFS_PLL_M)) * (DVFS_PLL_N) / 2U )
+
+/* RCC_CFGR fields */
+#define CFGR_SW_HSI              0U
+#define CFGR_SW_PLL              2U
+#define CFGR_HPRE_DIV1           0x0U
+#define CFGR_HPRE_DIV2           0x8U
+#define CFGR_HPRE_DIV4           0x9U
+#define CFGR_PPRE_DIV1           0x0U
+#define CFGR_PPRE_DIV2           0x4U
+#define CFGR_PPRE_DIV4           0x5U
+
+/* Global variables --------------------------------------------------------- */
+
+/* Core clock, allocated in main.c */
+extern uint32_t gSystemClock;
+
+/* Idle-time statistics, allocated in idle.c */
+extern IdleStats_t gIdleStats;
+
+static const DvfsPoint_t gDvfsPoints[DVFS_NUMBER_OF_POINTS] =
+{
+	[DVFS_POINT_4MHZ]   = {HSI_CLOCK / 4U, HSI_CLOCK / 4U, HSI_CLOCK / 4U, 0, CFGR_HPRE_DIV4, CFGR_PPRE_DIV1, CFGR_PPRE_DIV1, 0},
+	[DVFS_POINT_16MHZ]  = {HSI_CLOCK, HSI_CLOCK, HSI_CLOCK, 0, CFGR_HPRE_DIV1, CFGR_PPRE_DIV1, CFGR_PPRE_DIV1, 0},
+	[DVFS_POINT_84MHZ]  = {DVFS_PLL_CLOCK / 2U, DVFS_PLL_CLOCK / 4U, DVFS_PLL_CLOCK / 2U, 1, CFGR_HPRE_DIV2, CFGR_PPRE_DIV2, CFGR_PPRE_DIV1, 2},
+	[DVFS_POINT_168MHZ] = {DVFS_PLL_CLOCK, DVFS_PLL_CLOCK / 4U, DVFS_PLL_CLOCK / 2U, 1, CFGR_HPRE_DIV1, CFGR_PPRE_DIV4, CFGR_PPRE_DIV2, 5},
+};
+
+static uint32_t gDvfsPoint = DVFS_BOOT_POINT;
+static DvfsHook_t gDvfsHooks[DVFS_MAX_HOOKS];
+static uint32_t gDvfsHookCount = 0;
+
+/* Governor window, the idle-time statistics at its start */
+static uint32_t gDvfsWindowTotal = 0;
+static uint32_t gDvfsWindowIdle = 0;
+static uint32_t gDvfsLowWindows = 0;
+
+DvfsStats_t gDvfsStats;
+
+/* Private functions definitions -------------------------------------------- */
+
+/**
+  * @brief  Sets the flash wait states and waits until they're in effect.
+  * @param  Latency - Number of wait states.
+  * @retval None
+  */
+static void Dvfs_Set_Flash_Latency(uint32_t Latency)
+{
+	volatile uint32_t *pFLASH_ACR = (uint32_t*)FLASH_ACR;
+
+	*pFLASH_ACR = (*pFLASH_ACR & ~( 7U << 0)) | Latency;
+	while((*pFLASH_ACR & ( 7U << 0)) != Latency);
+}
+
+/**
+  * @brief  Selects the system clock source and waits until the switch is done.
+  * @param  Source - CFGR_SW_HSI or CFGR_SW_PLL.
+  * @retval None
+  */
+static void Dvfs_Set_Source(uint32_t Source)
+{
+	volatile uint32_t *pRCC_CFGR = (uint32_t*)RCC_CFGR;
+
+	*pRCC_CFGR = (*pRCC_CFGR & ~( 3U << 0)) | Source;
+	while(((*pRCC_CFGR >> 2) & 3U) != Source);
+}
+
+/**
+  * @brief  Switches the clock tree from one operating point to another. The flash wait states are
+  * 		raised before the clock and lowered after it, and the prescalers are written in an
+  * 		order that never takes a bus above its maximum frequency. Called with interrupts
+  * 		disabled.
+  * @param  pFrom - Pointer to the current operating point.
+  * @param  pTo - Pointer to the new operating point.
+  * @retval None
+  */
+static void Dvfs_Switch(const DvfsPoint_t *pFrom, const DvfsPoint_t *pTo)
+{
+	volatile uint32_t *pRCC_CR = (uint32_t*)RCC_CR;
+	volatile uint32_t *pRCC_CFGR = (uint32_t*)RCC_CFGR;
+	uint32_t Source = pTo->pll ? CFGR_SW_PLL : CFGR_SW_HSI;
+
+	if(pTo->hclk_hz > pFrom->hclk_hz)
+	{
+		Dvfs_Set_Flash_Latency(pTo->flash_latency);
+
+		if(pTo->pll && !(*pRCC_CR & ( 1 << 25)))
+		{
+			*pRCC_CR |= ( 1 << 24);       /* PLLON */
+			while(!(*pRCC_CR & ( 1 << 25)));
+		}
+
+		/* The APB prescalers first, the AHB prescaler and the source then raise the clocks */
+		*pRCC_CFGR = (*pRCC_CFGR & ~(( 7U << 10) | ( 7U << 13))) | ((uint32_t)pTo->ppre1 << 10) | ((uint32_t)pTo->ppre2 << 13);
+		*pRCC_CFGR = (*pRCC_CFGR & ~( 0xFU << 4)) | ((uint32_t)pTo->hpre << 4);
+		Dvfs_Set_Source(Source);
+	}
+	else
+	{
+		/* The source and the AHB prescaler first lower the clocks, then the APB prescalers */
+		Dvfs_Set_Source(Source);
+		*pRCC_CFGR = (*pRCC_CFGR & ~( 0xFU << 4)) | ((uint32_t)pTo->hpre << 4);
+		*pRCC_CFGR = (*pRCC_CFGR & ~(( 7U << 10) | ( 7U << 13))) | ((uint32_t)pTo->ppre1 << 10) | ((uint32_t)pTo->ppre2 << 13);
+
+		if(!pTo->pll)
+		{
+			*pRCC_CR &= ~( 1 << 24);      /* PLLON */
+		}
+
+		Dvfs_Set_Flash_Latency(pTo->flash_latency);
+	}
+}
+
+/* Functions definitions ---------------------------------------------------- */
+
+/**
+  * @brief  Configures the PLL, off until an operating point needs it, and enables the flash
+  * 		prefetch and caches. The core keeps running at DVFS_BOOT_POINT, the reset clock.
+  * @param  None
+  * @retval None
+  */
+void Dvfs_Init(void)
+{
+	uint32_t *pRCC_PLLCFGR = (uint32_t*)RCC_PLLCFGR;
+	uint32_t *pFLASH_ACR = (uint32_t*)FLASH_ACR;
+
+	/* PLLSRC = HSI */
+	*pRCC_PLLCFGR = (DVFS_PLL_Q << 24) | (DVFS_PLL_P << 16) | (DVFS_PLL_N << 6) | DVFS_PLL_M;
+
+	*pFLASH_ACR |= ( 1 << 8) | ( 1 << 9) | ( 1 << 10); /* PRFTEN, ICEN, DCEN */
+
+	gDvfsPoint = DVFS_BOOT_POINT;
+	gSystemClock = gDvfsPoints[DVFS_BOOT_POINT].hclk_hz;
+}
+
+/**
+  * @brief  Registers a function called after every operating point switch. Hooks run with
+  * 		interrupts disabled, from the SysTick handler when the governor switches.
+  * @param  Hook - The clock change hook.
+  * @retval 1 if the hook was registered, 0 if DVFS_MAX_HOOKS are already registered.
+  */
+uint8_t Dvfs_Register_Hook(DvfsHook_t Hook)
+{
+	uint32_t State;
+	uint8_t Registered = 0;
+
+	INTERRUPT_SAVE_AND_DISABLE(State);
+	if(gDvfsHookCount < DVFS_MAX_HOOKS)
+	{
+		gDvfsHooks[gDvfsHookCount++] = Hook;
+		Registered = 1;
+	}
+	INTERRUPT_RESTORE(State);
+
+	return Registered;
+}
+
+/**
+  * @brief  Switches to an operating point, reprograms the SysTick for the new core clock and
+  * 		runs the clock change hooks.
+  * @note   The SysTick count restarts from the new reload value, called from the SysTick handler
+  * 		this stretches the current tick by the handler's duration only. With DVFS_GOVERNOR
+  * 		the governor moves away from the point on its next decision.
+  * @param  Point - The operating point, a DVFS_POINT_* value.
+  * @retval None
+  */
+void Dvfs_Set_Point(uint32_t Point)
+{
+	uint32_t State;
+
+	if(Point >= DVFS_NUMBER_OF_POINTS)
+	{
+		return;
+	}
+
+	INTERRUPT_SAVE_AND_DISABLE(State);
+	if(Point != gDvfsPoint)
+	{
+		Dvfs_Switch(&gDvfsPoints[gDvfsPoint], &gDvfsPoints[Point]);
+		gDvfsPoint = Point;
+		gDvfsStats.switches++;
+
+		gSystemClock = gDvfsPoints[Point].hclk_hz;
+		SysTick_Init(TICK_HZ);
+
+		for(uint32_t i = 0 ; i < gDvfsHookCount ; i++)
+		{
+			gDvfsHooks[i](&gDvfsPoints[Point]);
+		}
+	}
+	INTERRUPT_RESTORE(State);
+}
+
+/**
+  * @brief  Returns the current operating point.
+  * @param  None
+  * @retval Pointer to the operating point.
+  */
+const DvfsPoint_t *Dvfs_Get_Point(void)
+{
+	return &gDvfsPoints[gDvfsPoint];
+}
+
+/**
+  * @brief  Accounts the tick to the current operating point and, every DVFS_WINDOW_TICKS, runs
+  * 		the governor. Called by the SysTick handler, after Idle_Account_Tick().
+  * @note   The busy ratio of a window above DVFS_UP_THRESHOLD switches to the fastest point. A
+  * 		step down is taken after DVFS_DOWN_WINDOWS consecutive windows whose busy ratio, scaled
+  * 		to the slower point's clock, is below DVFS_DOWN_THRESHOLD, so the load still fits the
+  * 		slower point and doesn't bounce back up.
+  * @param  None
+  * @retval None
+  */
+void Dvfs_Tick(void)
+{
+	gDvfsStats.ticks[gDvfsPoint]++;
+
+#if (DVFS_GOVERNOR == 1)
+	uint32_t Total = gIdleStats.total_ticks - gDvfsWindowTotal;
+	uint32_t Idle = gIdleStats.idle_ticks - gDvfsWindowIdle;
+	uint32_t Busy;
+
+	/* The statistics were reset, restart the window */
+	if(gIdleStats.total_ticks < gDvfsWindowTotal)
+	{
+		gDvfsWindowTotal = gIdleStats.total_ticks;
+		gDvfsWindowIdle = gIdleStats.idle_ticks;
+		return;
+	}
+
+	if(Total < DVFS_WINDOW_TICKS)
+	{
+		return;
+	}
+
+	Busy = (uint32_t)(((uint64_t)(Total - Idle) * 10000U) / Total);
+	gDvfsWindowTotal = gIdleStats.total_ticks;
+	gDvfsWindowIdle = gIdleStats.idle_ticks;
+
+	if(Busy >= DVFS_UP_THRESHOLD)
+	{
+		gDvfsLowWindows = 0;
+		Dvfs_Set_Point(DVFS_NUMBER_OF_POINTS - 1U);
+	}
+	else if((gDvfsPoint > 0U) &&
+	        ((((uint64_t)Busy * gDvfsPoints[gDvfsPoint].hclk_hz) / gDvfsPoints[gDvfsPoint - 1U].hclk_hz) < DVFS_DOWN_THRESHOLD))
+	{
+		if(++gDvfsLowWindows >= DVFS_DOWN_WINDOWS)
+		{
+			gDvfsLowWindows = 0;
+			Dvfs_Set_Point(gDvfsPoint - 1U);
+		}
+	}
+	else
+	{
+		gDvfsLowWindows = 0;
+	}
+#endif
+}
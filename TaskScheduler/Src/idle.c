@@ -0,0 +1,549 @@
+/**
+ ******************************************************************************
+ * @file           : idle.c
+ * @author         : Noam Yakar
+ * @brief          : This file contains the idle task's low-power management.
+ *                   The idle task runs the registered idle hooks, then enters
+ *                   Sleep mode, or Stop mode when no task needs the CPU before
+ *                   IDLE_STOP_MIN_TICKS. In Stop mode the SysTick is halted, the
+ *                   RTC wakeup timer (clocked by the LSE, or by the LSI
+ *                   calibrated at init) wakes the core on the next timed
+ *                   wakeup, and the RTC calendar measures the Stop period,
+ *                   which is replayed as ticks on the way out.
+ ******************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------- */
+
+#include "idle.h"
+#include "irq.h"
+#include "queue.h"
+#include "sched.h"
+#include "dvfs.h"
+#include "active.h"
+
+/* Macros ------------------------------------------------------------------- */
+
+/* RCC registers */
+#define RCC_CR                   ( (RCC_AHB1_BASE) + 0x00U )
+#define RCC_CFGR                 ( (RCC_AHB1_BASE) + 0x08U )
+#define RCC_APB1ENR              ( (RCC_AHB1_BASE) + 0x40U )
+#define RCC_BDCR                 ( (RCC_AHB1_BASE) + 0x70U )
+#define RCC_CSR                  ( (RCC_AHB1_BASE) + 0x74U )
+
+/* PWR registers */
+#define PWR_CR                   0x40007000U
+
+/* RTC registers */
+#define RTC_BASE                 0x40002800U
+#define RTC_TR                   ( (RTC_BASE) + 0x00U )
+#define RTC_CR                   ( (RTC_BASE) + 0x08U )
+#define RTC_ISR                  ( (RTC_BASE) + 0x0CU )
+#define RTC_PRER                 ( (RTC_BASE) + 0x10U )
+#define RTC_WUTR                 ( (RTC_BASE) + 0x14U )
+#define RTC_WPR                  ( (RTC_BASE) + 0x24U )
+#define RTC_SSR                  ( (RTC_BASE) + 0x28U )
+#define RTC_WKUP_IRQ_NUMBER      3U
+
+/* EXTI registers, the RTC wakeup event is on line 22 */
+#define EXTI_BASE                0x40013C00U
+#define EXTI_IMR                 ( (EXTI_BASE) + 0x00U )
+#define EXTI_RTSR                ( (EXTI_BASE) + 0x08U )
+#define EXTI_PR                  ( (EXTI_BASE) + 0x14U )
+#define EXTI_RTC_WAKEUP_LINE     22U
+
+/* System control register */
+#define SCB_SCR                  0xE000ED10U
+
+/* Debug MCU configuration register */
+#define DBGMCU_CR                0xE0042004U
+
+/* TIM5 registers. The LSI can be routed to channel 4, to measure it */
+#define TIM5_BASE                0x40000C00U
+#define TIM5_CR1                 ( (TIM5_BASE) + 0x00U )
+#define TIM5_SR                  ( (TIM5_BASE) + 0x10U )
+#define TIM5_EGR                 ( (TIM5_BASE) + 0x14U )
+#define TIM5_CCMR2               ( (TIM5_BASE) + 0x1CU )
+#define TIM5_CCER                ( (TIM5_BASE) + 0x20U )
+#define TIM5_PSC                 ( (TIM5_BASE) + 0x28U )
+#define TIM5_ARR                 ( (TIM5_BASE) + 0x2CU )
+#define TIM5_CCR4                ( (TIM5_BASE) + 0x40U )
+#define TIM5_OR                  ( (TIM5_BASE) + 0x50U )
+
+/* RTC clocks. The calendar sub-second counter runs at RTC / 2, and the wakeup timer at RTC / 16 */
+#define IDLE_LSE_HZ              32768U
+#define IDLE_LSI_HZ              32000U      /* Nominal, replaced by the calibration */
+#define IDLE_RTC_PREDIV_A        1U
+
+/* The LSI is measured over this many captures of 8 of its cycles, 8ms */
+#define IDLE_LSI_CAPTURES        32U
+
+/* Global variables --------------------------------------------------------- */
+
+extern TaskControlBlock_t *gpCurrentRunningTask;
+extern TaskControlBlock_t *pIdleTask;
+extern Queue_t gBlockedQueue;
+extern uint32_t gTickCount;
+
+static IdleHook_t gIdleHooks[IDLE_MAX_HOOKS];
+static uint32_t gIdleHookCount = 0;
+
+/* Number of drivers that need their peripheral clocks, Stop mode is entered only when it's 0 */
+static volatile uint32_t gStopInhibitCount = 0;
+
+#if (IDLE_LOW_POWER_MODE == IDLE_MODE_STOP)
+/* Frequency of the RTC clock, and of the calendar sub-second counter */
+static uint32_t gIdleRtcHz = (IDLE_RTC_CLOCK == IDLE_RTC_CLOCK_LSE) ? IDLE_LSE_HZ : IDLE_LSI_HZ;
+static uint32_t gIdleRtcSubsecondHz;
+#endif
+
+IdleStats_t gIdleStats;
+
+/* Private functions definitions -------------------------------------------- */
+
+#if (IDLE_LOW_POWER_MODE == IDLE_MODE_STOP)
+
+#if (IDLE_RTC_CLOCK == IDLE_RTC_CLOCK_LSI)
+/**
+  * @brief  Measures the LSI against the APB1 timer clock - the HSI at boot - with TIM5 channel 4
+  * 		capturing every 8th LSI cycle. The LSI must be running.
+  * @note   The residual error is the HSI's, 1% at 25C and a few percent over the temperature
+  * 		range, plus the LSI's drift with the temperature and the voltage since the calibration.
+  * @param  None
+  * @retval Frequency of the LSI in Hz.
+  */
+static uint32_t Idle_Lsi_Calibrate(void)
+{
+	uint32_t *pRCC_APB1ENR = (uint32_t*)RCC_APB1ENR;
+	volatile uint32_t *pTIM5_SR = (uint32_t*)TIM5_SR;
+	volatile uint32_t *pTIM5_CCR4 = (uint32_t*)TIM5_CCR4;
+	const DvfsPoint_t *pPoint = Dvfs_Get_Point();
+	uint32_t TimerHz;
+	uint32_t First = 0;
+	uint32_t Capture = 0;
+
+	/* The timers run at twice the APB1 clock when APB1 is divided */
+	TimerHz = (pPoint->ppre1 & 4U) ? (2U * pPoint->apb1_hz) : pPoint->apb1_hz;
+
+	/* TIM5 free-running at the timer clock, channel 4 captures the LSI divided by 8 */
+	*pRCC_APB1ENR |= ( 1 << 3);    /* TIM5EN */
+	*(uint32_t*)TIM5_OR = ( 1 << 6);                      /* TI4_RMP = LSI */
+	*(uint32_t*)TIM5_PSC = 0;
+	*(uint32_t*)TIM5_ARR = 0xFFFFFFFFU;
+	*(uint32_t*)TIM5_CCMR2 = ( 1 << 8) | ( 3 << 10);      /* CC4S = TI4, IC4PSC = 8 events */
+	*(uint32_t*)TIM5_CCER = ( 1 << 12);                   /* CC4E */
+	*(uint32_t*)TIM5_EGR = ( 1 << 0);                     /* UG, loads the prescaler */
+	*pTIM5_SR = 0;
+	*(uint32_t*)TIM5_CR1 = ( 1 << 0);                     /* CEN */
+
+	/* Reading CCR4 clears CC4IF */
+	for(uint32_t i = 0 ; i <= IDLE_LSI_CAPTURES ; i++)
+	{
+		while(!(*pTIM5_SR & ( 1 << 4)));                 /* CC4IF */
+		Capture = *pTIM5_CCR4;
+		if(i == 0U)
+		{
+			First = Capture;
+		}
+	}
+
+	*(uint32_t*)TIM5_CR1 = 0;
+	*(uint32_t*)TIM5_CCER = 0;
+	*(uint32_t*)TIM5_OR = 0;
+	*pRCC_APB1ENR &= ~( 1U << 3);
+
+	return (uint32_t)((((uint64_t)TimerHz * 8U * IDLE_LSI_CAPTURES) + ((Capture - First) / 2U)) / (Capture - First));
+}
+#endif /* IDLE_RTC_CLOCK == IDLE_RTC_CLOCK_LSI */
+
+/**
+  * @brief  Clocks the RTC from the LSE, or from the LSI once it's calibrated, starts its calendar
+  * 		and routes its wakeup timer to EXTI line 22, so it can wake the core from Stop mode.
+  * @param  None
+  * @retval None
+  */
+static void Idle_Rtc_Init(void)
+{
+	uint32_t *pRCC_APB1ENR = (uint32_t*)RCC_APB1ENR;
+#if (IDLE_RTC_CLOCK == IDLE_RTC_CLOCK_LSI)
+	uint32_t *pRCC_CSR = (uint32_t*)RCC_CSR;
+#endif
+	uint32_t *pRCC_BDCR = (uint32_t*)RCC_BDCR;
+	uint32_t *pPWR_CR = (uint32_t*)PWR_CR;
+	uint32_t *pRTC_WPR = (uint32_t*)RTC_WPR;
+	uint32_t *pRTC_ISR = (uint32_t*)RTC_ISR;
+	uint32_t *pRTC_PRER = (uint32_t*)RTC_PRER;
+	uint32_t *pRTC_TR = (uint32_t*)RTC_TR;
+	uint32_t *pRTC_CR = (uint32_t*)RTC_CR;
+	uint32_t *pEXTI_IMR = (uint32_t*)EXTI_IMR;
+	uint32_t *pEXTI_RTSR = (uint32_t*)EXTI_RTSR;
+	uint32_t RtcSel = (IDLE_RTC_CLOCK == IDLE_RTC_CLOCK_LSE) ? ( 1 << 8) : ( 2 << 8);
+	uint32_t PredivS;
+
+	/* Unlock the backup domain */
+	*pRCC_APB1ENR |= ( 1 << 28);   /* PWREN */
+	*pPWR_CR |= ( 1 << 8);         /* DBP */
+
+#if (IDLE_RTC_CLOCK == IDLE_RTC_CLOCK_LSI)
+	/* Start the LSI and measure it */
+	*pRCC_CSR |= ( 1 << 0);        /* LSION */
+	while(!(*(volatile uint32_t*)pRCC_CSR & ( 1 << 1)));
+	gIdleRtcHz = Idle_Lsi_Calibrate();
+#endif
+
+	/* Select the RTC clock, the selection can only be changed by a backup domain reset */
+	if((*pRCC_BDCR & ( 3 << 8)) != RtcSel)
+	{
+		*pRCC_BDCR |= ( 1 << 16);  /* BDRST */
+		*pRCC_BDCR &= ~( 1 << 16);
+	}
+
+#if (IDLE_RTC_CLOCK == IDLE_RTC_CLOCK_LSE)
+	/* Start the LSE, in the backup domain */
+	*pRCC_BDCR |= ( 1 << 0);       /* LSEON */
+	while(!(*(volatile uint32_t*)pRCC_BDCR & ( 1 << 1)));
+#endif
+
+	*pRCC_BDCR |= RtcSel;          /* RTCSEL */
+	*pRCC_BDCR |= ( 1 << 15);      /* RTCEN */
+
+	/* The sub-second counter runs at RTC / (PREDIV_A + 1) */
+	PredivS = (gIdleRtcHz / (IDLE_RTC_PREDIV_A + 1U)) - 1U;
+	gIdleRtcSubsecondHz = PredivS + 1U;
+
+	/* Unlock the RTC registers */
+	*pRTC_WPR = 0xCA;
+	*pRTC_WPR = 0x53;
+
+	/* Program the prescalers and restart the calendar */
+	*pRTC_ISR |= ( 1 << 7);        /* INIT */
+	while(!(*(volatile uint32_t*)pRTC_ISR & ( 1 << 6)));
+	*pRTC_PRER = PredivS;
+	*pRTC_PRER = (IDLE_RTC_PREDIV_A << 16) | PredivS;
+	*pRTC_TR = 0;
+	*pRTC_ISR &= ~( 1 << 7);
+
+	/* Read the calendar counters directly, the shadow registers aren't updated in Stop mode */
+	*pRTC_CR |= ( 1 << 5);         /* BYPSHAD */
+
+	/* Wakeup timer clocked by RTC/16, with interrupt */
+	*pRTC_CR &= ~( 1 << 10);       /* WUTE */
+	while(!(*(volatile uint32_t*)pRTC_ISR & ( 1 << 2)));
+	*pRTC_CR &= ~( 7 << 0);        /* WUCKSEL = RTC/16 */
+	*pRTC_CR |= ( 1 << 14);        /* WUTIE */
+
+	/* EXTI line 22 rising edge, and its NVIC interrupt */
+	*pEXTI_IMR |= ( 1 << EXTI_RTC_WAKEUP_LINE);
+	*pEXTI_RTSR |= ( 1 << EXTI_RTC_WAKEUP_LINE);
+	Irq_Enable(RTC_WKUP_IRQ_NUMBER);
+}
+
+/**
+  * @brief  Reads the calendar, in sub-second units modulo one hour.
+  * @param  None
+  * @retval Calendar time.
+  */
+static uint32_t Idle_Rtc_Now(void)
+{
+	volatile uint32_t *pRTC_SSR = (uint32_t*)RTC_SSR;
+	volatile uint32_t *pRTC_TR = (uint32_t*)RTC_TR;
+	uint32_t SubSeconds;
+	uint32_t Time;
+
+	/* Without the shadow registers, read until the sub-second counter didn't move */
+	do
+	{
+		SubSeconds = *pRTC_SSR;
+		Time = *pRTC_TR;
+	} while(SubSeconds != *pRTC_SSR);
+
+	uint32_t Seconds = (((Time >> 4) & 0x7U) * 10U) + (Time & 0xFU);
+	uint32_t Minutes = (((Time >> 12) & 0x7U) * 10U) + ((Time >> 8) & 0xFU);
+
+	return (((Minutes * 60U) + Seconds) * gIdleRtcSubsecondHz) + ((gIdleRtcSubsecondHz - 1U) - SubSeconds);
+}
+
+/**
+  * @brief  Enters Stop mode until the RTC wakeup timer expires or another interrupt occurs, and
+  * 		replays the elapsed ticks. Called with interrupts disabled.
+  * @param  WakeupTicks - Number of ticks until the next timed wakeup.
+  * @retval None
+  */
+static void Idle_Enter_Stop(uint32_t WakeupTicks)
+{
+	uint32_t *pRCC_CR = (uint32_t*)RCC_CR;
+	uint32_t *pRCC_CFGR = (uint32_t*)RCC_CFGR;
+	uint32_t *pPWR_CR = (uint32_t*)PWR_CR;
+	uint32_t *pSCB_SCR = (uint32_t*)SCB_SCR;
+	uint32_t *pRTC_CR = (uint32_t*)RTC_CR;
+	uint32_t *pRTC_ISR = (uint32_t*)RTC_ISR;
+	uint32_t *pRTC_WUTR = (uint32_t*)RTC_WUTR;
+	uint32_t *pEXTI_PR = (uint32_t*)EXTI_PR;
+	uint32_t SavedCr = *pRCC_CR;
+	uint32_t SavedCfgr = *pRCC_CFGR;
+	uint32_t Hour = 3600U * gIdleRtcSubsecondHz;
+	uint32_t Start;
+	uint32_t Elapsed;
+
+	/* Program the wakeup timer */
+	*pRTC_CR &= ~( 1 << 10);       /* WUTE */
+	while(!(*(volatile uint32_t*)pRTC_ISR & ( 1 << 2)));
+	*pRTC_WUTR = ((WakeupTicks * (gIdleRtcHz / 16U)) / TICK_HZ) - 1U;
+	*pRTC_ISR &= ~( 1 << 10);      /* WUTF */
+	*pEXTI_PR = ( 1 << EXTI_RTC_WAKEUP_LINE);
+	*pRTC_CR |= ( 1 << 10);
+
+	/* Stop mode with the low-power regulator */
+	*pPWR_CR &= ~( 1 << 1);        /* PDDS */
+	*pPWR_CR |= ( 1 << 0);         /* LPDS */
+	*pPWR_CR |= ( 1 << 2);         /* CWUF */
+	*pSCB_SCR |= ( 1 << 2);        /* SLEEPDEEP */
+
+	gIdleStats.stop_entries++;
+	Start = Idle_Rtc_Now();
+	__asm volatile ("DSB");
+	__asm volatile ("WFI");
+
+	/* The core wakes up on the HSI, restore the oscillators and the system clock source */
+	*pSCB_SCR &= ~( 1 << 2);
+	if(SavedCr & ( 1 << 16))
+	{
+		*pRCC_CR |= ( 1 << 16);    /* HSEON */
+		while(!(*(volatile uint32_t*)pRCC_CR & ( 1 << 17)));
+	}
+	if(SavedCr & ( 1 << 24))
+	{
+		*pRCC_CR |= ( 1 << 24);    /* PLLON */
+		while(!(*(volatile uint32_t*)pRCC_CR & ( 1 << 25)));
+	}
+	*pRCC_CFGR = (*pRCC_CFGR & ~( 3 << 0)) | (SavedCfgr & ( 3 << 0));
+	while((*(volatile uint32_t*)pRCC_CFGR & ( 3 << 2)) != ((SavedCfgr & ( 3 << 0)) << 2));
+
+	*pRTC_CR &= ~( 1 << 10);
+	if(!(*pRTC_ISR & ( 1 << 10)))
+	{
+		gIdleStats.early_wakeups++;
+	}
+
+	/* Replay the ticks the SysTick missed, the first timed wakeup is due after WakeupTicks */
+	/* The calendar time is measured modulo one hour */
+	Elapsed = (Idle_Rtc_Now() + Hour - Start) % Hour;
+	Elapsed = (uint32_t)(((uint64_t)Elapsed * TICK_HZ) / gIdleRtcSubsecondHz);
+	if(Elapsed > WakeupTicks)
+	{
+		Elapsed = WakeupTicks;
+	}
+	for(uint32_t i = 0 ; i < Elapsed ; i++)
+	{
+		Increment_Global_Tick_Count();
+		Unblock_Tasks();
+		Active_Tick();
+	}
+	gIdleStats.stop_ticks += Elapsed;
+	gIdleStats.idle_ticks += Elapsed;
+	gIdleStats.total_ticks += Elapsed;
+
+	/* Let the scheduler run the unblocked tasks */
+	Pend_PendSV();
+}
+
+#endif /* IDLE_LOW_POWER_MODE == IDLE_MODE_STOP */
+
+/* Functions definitions ---------------------------------------------------- */
+
+/**
+  * @brief  Initializes the low-power management. Keeps the debugger connected in the low-power
+  * 		modes of a Debug build.
+  * @param  None
+  * @retval None
+  */
+void Idle_Init(void)
+{
+#ifdef DEBUG
+	*(uint32_t*)DBGMCU_CR |= ( 1 << 0) | ( 1 << 1); /* DBG_SLEEP, DBG_STOP */
+#endif
+
+#if (IDLE_LOW_POWER_MODE == IDLE_MODE_STOP)
+	Idle_Rtc_Init();
+#endif
+
+	Idle_Stats_Reset();
+}
+
+/**
+  * @brief  Registers a function called by the idle task in every iteration. Hooks run in the
+  * 		idle task's context and must not block.
+  * @param  Hook - The idle hook.
+  * @retval 1 if the hook was registered, 0 if IDLE_MAX_HOOKS are already registered.
+  */
+uint8_t Idle_Register_Hook(IdleHook_t Hook)
+{
+	uint32_t State;
+	uint8_t Registered = 0;
+
+	INTERRUPT_SAVE_AND_DISABLE(State);
+	if(gIdleHookCount < IDLE_MAX_HOOKS)
+	{
+		gIdleHooks[gIdleHookCount++] = Hook;
+		Registered = 1;
+	}
+	INTERRUPT_RESTORE(State);
+
+	return Registered;
+}
+
+/**
+  * @brief  Runs the registered idle hooks.
+  * @param  None
+  * @retval None
+  */
+void Idle_Run_Hooks(void)
+{
+	for(uint32_t i = 0 ; i < gIdleHookCount ; i++)
+	{
+		gIdleHooks[i]();
+	}
+}
+
+/**
+  * @brief  Enters the deepest allowed low-power mode until the next interrupt. Stop mode is
+  * 		entered if it's allowed and the next timed wakeup is at least IDLE_STOP_MIN_TICKS away,
+  * 		Sleep mode otherwise.
+  * @note   Interrupts are disabled from the decision to the WFI, so an interrupt that makes a
+  * 		task ready in between doesn't get lost: it is left pending, and a pending interrupt
+  * 		wakes the core from WFI even while masked. PRIMASK is used rather than BASEPRI, an
+  * 		interrupt masked by BASEPRI doesn't wake the core.
+  * @param  None
+  * @retval None
+  */
+void Idle_Enter_Low_Power(void)
+{
+#if (IDLE_LOW_POWER_MODE != IDLE_MODE_BUSY)
+	uint32_t *pICSR = (uint32_t*)ICSR;
+	uint32_t State;
+
+	INTERRUPT_MASK_ALL_SAVE(State);
+
+	/* A context-switch is pending, a task is about to run. In the cooperative mode a task made
+	 * ready runs once the idle task yields */
+	if((*pICSR & ( 1 << 28)) || ((SCHED_COOPERATIVE == 1) && Sched_Task_Ready()))
+	{
+		INTERRUPT_MASK_ALL_RESTORE(State);
+		return;
+	}
+
+#if (IDLE_LOW_POWER_MODE == IDLE_MODE_STOP)
+	uint32_t WakeupTicks = IDLE_STOP_MAX_TICKS;
+
+	/* The blocked queue is sorted, its head has the next timed wakeup */
+	if(gBlockedQueue.head != NULL)
+	{
+		int32_t Remaining = (int32_t)(gBlockedQueue.head->block_count - gTickCount);
+		WakeupTicks = (Remaining <= 0) ? 0U : (((uint32_t)Remaining < IDLE_STOP_MAX_TICKS) ? (uint32_t)Remaining : IDLE_STOP_MAX_TICKS);
+	}
+
+	/* An armed time event wakes the core too, its signal is posted on the tick it expires */
+	WakeupTicks = Active_Ticks_To_Next_Event(WakeupTicks);
+
+	if((gStopInhibitCount == 0U) && (WakeupTicks >= IDLE_STOP_MIN_TICKS))
+	{
+		Idle_Enter_Stop(WakeupTicks);
+		INTERRUPT_MASK_ALL_RESTORE(State);
+		return;
+	}
+#endif
+
+	gIdleStats.sleep_entries++;
+	__asm volatile ("DSB");
+	__asm volatile ("WFI");
+
+	INTERRUPT_MASK_ALL_RESTORE(State);
+#endif
+}
+
+/**
+  * @brief  Prevents Stop mode, for drivers that wait for interrupts of peripherals whose clocks
+  * 		are stopped in Stop mode. Calls nest, each must be matched by Idle_Stop_Allow().
+  * @param  None
+  * @retval None
+  */
+void Idle_Stop_Inhibit(void)
+{
+	__atomic_add_fetch(&gStopInhibitCount, 1U, __ATOMIC_RELAXED);
+}
+
+/**
+  * @brief  Releases an Idle_Stop_Inhibit() request.
+  * @param  None
+  * @retval None
+  */
+void Idle_Stop_Allow(void)
+{
+	__atomic_sub_fetch(&gStopInhibitCount, 1U, __ATOMIC_RELAXED);
+}
+
+/**
+  * @brief  Accounts the elapsed tick to the idle-time statistics. Called by the SysTick handler.
+  * @param  None
+  * @retval None
+  */
+void Idle_Account_Tick(void)
+{
+	gIdleStats.total_ticks++;
+	if(gpCurrentRunningTask == pIdleTask)
+	{
+		gIdleStats.idle_ticks++;
+	}
+}
+
+/**
+  * @brief  Clears the idle-time statistics.
+  * @param  None
+  * @retval None
+  */
+void Idle_Stats_Reset(void)
+{
+	uint32_t State;
+
+	INTERRUPT_SAVE_AND_DISABLE(State);
+	gIdleStats.total_ticks = 0;
+	gIdleStats.idle_ticks = 0;
+	gIdleStats.sleep_entries = 0;
+	gIdleStats.stop_entries = 0;
+	gIdleStats.stop_ticks = 0;
+	gIdleStats.early_wakeups = 0;
+	INTERRUPT_RESTORE(State);
+}
+
+/**
+  * @brief  Returns the CPU utilisation since the statistics were reset.
+  * @param  None
+  * @retval Utilisation in hundredths of a percent (0 - 10000).
+  */
+uint32_t Idle_Get_Utilisation(void)
+{
+	uint32_t Total = gIdleStats.total_ticks;
+	uint32_t Idle = gIdleStats.idle_ticks;
+
+	if(Total == 0U)
+	{
+		return 0;
+	}
+
+	return (uint32_t)(((uint64_t)(Total - Idle) * 10000U) / Total);
+}
+
+/**
+  * @brief  Handler for the RTC wakeup interrupt. Only clears the wakeup flags, the idle task
+  * 		handles the wakeup.
+  * @param  None
+  * @retval None
+  */
+void RTC_WKUP_IRQHandler(void)
+{
+	uint32_t *pRTC_ISR = (uint32_t*)RTC_ISR;
+	uint32_t *pEXTI_PR = (uint32_t*)EXTI_PR;
+
+	*pRTC_ISR &= ~( 1 << 10);      /* WUTF */
+	*pEXTI_PR = ( 1 << EXTI_RTC_WAKEUP_LINE);
+}
@@ -0,0 +1,215 @@
+/**
+ ******************************************************************************
+ * @file           : irq.c
+ * @author         : Noam Yakar
+ * @brief          : This file contains function definitions of the interrupt
+ *                   management. The vector table is copied to RAM so handlers
+ *                   can be registered at runtime, and every interrupt gets a
+ *                   priority that tells whether the kernel may mask it:
+ *                   kernel-aware interrupts are masked by the kernel critical
+ *                   sections (BASEPRI) and may call kernel functions, while
+ *                   zero-latency interrupts are never masked by the kernel.
+ ******************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------- */
+
+#include "irq.h"
+
+/* Types -------------------------------------------------------------------- */
+
+/* Registered kernel-aware handler */
+typedef struct
+{
+	IrqKernelHandler_t handler;     /*!< Handler called by Irq_Kernel_Dispatch(). */
+	void *arg;                      /*!< Argument passed to the handler. */
+} IrqKernelEntry_t;
+
+/* Global variables --------------------------------------------------------- */
+
+/* The vector table in flash, defined in the startup file */
+extern const IrqHandler_t g_pfnVectors[];
+
+/* The vector table in RAM, used once Irq_Init() sets VTOR */
+static IrqHandler_t gRamVectors[IRQ_VECTOR_COUNT] __attribute__((aligned(IRQ_VECTOR_TABLE_ALIGN)));
+
+/* Kernel-aware handlers, indexed by IRQ number */
+static IrqKernelEntry_t gKernelHandlers[IRQ_COUNT];
+
+/* Functions definitions ---------------------------------------------------- */
+
+/**
+  * @brief  Copies the vector table to RAM and relocates it. Sets SysTick and PendSV to the lowest
+  * 		priority and every interrupt to IRQ_PRIORITY_DEFAULT, so an interrupt enabled without a
+  * 		priority is kernel-aware. Called before any interrupt is enabled.
+  * @param  None
+  * @retval None
+  */
+void Irq_Init(void)
+{
+	uint32_t *pSCB_VTOR = (uint32_t*)SCB_VTOR;
+	uint32_t *pSCB_SHPR3 = (uint32_t*)SCB_SHPR3;
+	uint8_t *pNVIC_IPR = (uint8_t*)NVIC_IPR0;
+
+	for(uint32_t i = 0 ; i < IRQ_VECTOR_COUNT ; i++)
+	{
+		gRamVectors[i] = g_pfnVectors[i];
+	}
+
+	/* Relocate the vector table, make sure it's written before an exception can use it */
+	__asm volatile ("DSB" : : : "memory");
+	*pSCB_VTOR = (uint32_t)gRamVectors;
+	__asm volatile ("DSB");
+	__asm volatile ("ISB");
+
+	for(uint32_t Irq = 0 ; Irq < IRQ_COUNT ; Irq++)
+	{
+		pNVIC_IPR[Irq] = IRQ_PRIORITY_TO_REG(IRQ_PRIORITY_DEFAULT);
+	}
+
+	/* PendSV (bits 16-23) and SysTick (bits 24-31). At the same priority SysTick never preempts a
+	 * context-switch, and PendSV runs only after all the other handlers returned */
+	*pSCB_SHPR3 = (IRQ_PRIORITY_TO_REG(IRQ_PRIORITY_LOWEST) << 24) | (IRQ_PRIORITY_TO_REG(IRQ_PRIORITY_LOWEST) << 16);
+}
+
+/**
+  * @brief  Installs an interrupt handler in the vector table and sets the interrupt priority. The
+  * 		interrupt is not enabled.
+  * @note   A handler with a priority below IRQ_KERNEL_PRIORITY is zero-latency, it must not call
+  * 		kernel functions. A kernel-aware handler installed by this function must pend the
+  * 		context-switch itself, Irq_Register_Kernel() does it for its handlers.
+  * @param  Irq - IRQ number.
+  * @param  Handler - Pointer to the handler.
+  * @param  Priority - Priority, from IRQ_PRIORITY_HIGHEST to IRQ_PRIORITY_LOWEST.
+  * @retval IRQ_OK, or IRQ_INVALID if the arguments are invalid.
+  */
+uint8_t Irq_Register(uint32_t Irq, IrqHandler_t Handler, uint32_t Priority)
+{
+	if((Irq >= IRQ_COUNT) || (Handler == NULL) || (Priority > IRQ_PRIORITY_LOWEST))
+	{
+		return IRQ_INVALID;
+	}
+
+	Irq_Disable(Irq);
+	gRamVectors[16U + Irq] = Handler;
+	__asm volatile ("DSB" : : : "memory");
+
+	return Irq_Set_Priority(Irq, Priority);
+}
+
+/**
+  * @brief  Installs a kernel-aware interrupt handler. The interrupt is dispatched by
+  * 		Irq_Kernel_Dispatch(), which pends a single context-switch if the handler requests it.
+  * 		The interrupt is not enabled.
+  * @param  Irq - IRQ number.
+  * @param  Handler - Pointer to the handler, returns 1 to request a context-switch.
+  * @param  pArg - Argument passed to the handler.
+  * @param  Priority - Priority, from IRQ_KERNEL_PRIORITY to IRQ_PRIORITY_LOWEST.
+  * @retval IRQ_OK, or IRQ_INVALID if the arguments are invalid.
+  */
+uint8_t Irq_Register_Kernel(uint32_t Irq, IrqKernelHandler_t Handler, void *pArg, uint32_t Priority)
+{
+	if((Irq >= IRQ_COUNT) || (Handler == NULL) || (Priority < IRQ_KERNEL_PRIORITY) || (Priority > IRQ_PRIORITY_LOWEST))
+	{
+		return IRQ_INVALID;
+	}
+
+	Irq_Disable(Irq);
+	gKernelHandlers[Irq].handler = Handler;
+	gKernelHandlers[Irq].arg = pArg;
+
+	return Irq_Register(Irq, Irq_Kernel_Dispatch, Priority);
+}
+
+/**
+  * @brief  Sets the priority of an interrupt.
+  * @param  Irq - IRQ number.
+  * @param  Priority - Priority, from IRQ_PRIORITY_HIGHEST to IRQ_PRIORITY_LOWEST.
+  * @retval IRQ_OK, or IRQ_INVALID if the arguments are invalid.
+  */
+uint8_t Irq_Set_Priority(uint32_t Irq, uint32_t Priority)
+{
+	uint8_t *pNVIC_IPR = (uint8_t*)NVIC_IPR0;
+
+	if((Irq >= IRQ_COUNT) || (Priority > IRQ_PRIORITY_LOWEST))
+	{
+		return IRQ_INVALID;
+	}
+
+	pNVIC_IPR[Irq] = IRQ_PRIORITY_TO_REG(Priority);
+
+	return IRQ_OK;
+}
+
+/**
+  * @brief  Enables an interrupt in the NVIC.
+  * @param  Irq - IRQ number.
+  * @retval None
+  */
+void Irq_Enable(uint32_t Irq)
+{
+	uint32_t *pNVIC_ISER = (uint32_t*)NVIC_ISER0;
+
+	pNVIC_ISER[Irq >> 5] = ( 1U << (Irq & 0x1FU));
+}
+
+/**
+  * @brief  Disables an interrupt in the NVIC. The interrupt handler doesn't run once this
+  * 		function returns.
+  * @param  Irq - IRQ number.
+  * @retval None
+  */
+void Irq_Disable(uint32_t Irq)
+{
+	uint32_t *pNVIC_ICER = (uint32_t*)NVIC_ICER0;
+
+	pNVIC_ICER[Irq >> 5] = ( 1U << (Irq & 0x1FU));
+	__asm volatile ("DSB");
+	__asm volatile ("ISB");
+}
+
+/**
+  * @brief  Sets an interrupt pending, its handler runs once its priority allows it.
+  * @param  Irq - IRQ number.
+  * @retval None
+  */
+void Irq_Set_Pending(uint32_t Irq)
+{
+	uint32_t *pNVIC_ISPR = (uint32_t*)NVIC_ISPR0;
+
+	pNVIC_ISPR[Irq >> 5] = ( 1U << (Irq & 0x1FU));
+}
+
+/**
+  * @brief  Clears the pending state of an interrupt.
+  * @param  Irq - IRQ number.
+  * @retval None
+  */
+void Irq_Clear_Pending(uint32_t Irq)
+{
+	uint32_t *pNVIC_ICPR = (uint32_t*)NVIC_ICPR0;
+
+	pNVIC_ICPR[Irq >> 5] = ( 1U << (Irq & 0x1FU));
+}
+
+/**
+  * @brief  Vector of the interrupts registered by Irq_Register_Kernel(). Calls the registered
+  * 		handler of the active interrupt and pends the PendSV exception if it requested a
+  * 		context-switch, which takes place once all the interrupt handlers returned.
+  * @param  None
+  * @retval None
+  */
+void Irq_Kernel_Dispatch(void)
+{
+	uint32_t Ipsr;
+
+	/* IPSR holds the active exception number, interrupts start at 16 */
+	__asm volatile ("MRS %0,IPSR" : "=r" (Ipsr));
+
+	IrqKernelEntry_t *pEntry = &gKernelHandlers[Ipsr - 16U];
+
+	if(pEntry->handler(pEntry->arg))
+	{
+		Pend_PendSV();
+	}
+}
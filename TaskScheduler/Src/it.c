@@ -10,6 +10,27 @@
 /* Includes ----------------------------------------------------------------- */
 
 #include "it.h"
+#include "budget.h"
+#include "idle.h"
+#include "active.h"
+#include "dvfs.h"
+#include "libc.h"
+
+/* Macros ------------------------------------------------------------------- */
+
+/* Expands a macro into a string, for use in the naked handlers' assembly */
+#define IT_STR_(x)               #x
+#define IT_STR(x)                IT_STR_(x)
+
+/* Branches to Crash_Capture() with the exception frame, on the stack selected by EXC_RETURN bit 2,
+ * and EXC_RETURN. Nothing is pushed, the stack that faulted may be the broken one */
+#define FAULT_CAPTURE() \
+	__asm volatile("TST LR,#4\n\t" \
+	               "ITE EQ\n\t" \
+	               "MRSEQ R0,MSP\n\t" \
+	               "MRSNE R0,PSP\n\t" \
+	               "MOV R1,LR\n\t" \
+	               "B Crash_Capture")
 
 /* Functions definitions ---------------------------------------------------- */
 
@@ -22,9 +43,67 @@
   * 		1.  Retrieves the values of R4-R11 registers (SF2) of the switched in task, that were
   * 			not part of the standard stack frame during the un-stacking process that took place
   * 			at the exception entry.
+  * @note   Kernel-aware interrupts preempt PendSV, they are masked while Schedule() runs.
+  * 		In a hard-float build each task has its own EXC_RETURN, since only tasks that used
+  * 		the FPU have an extended stack frame (EXC_RETURN bit 4 cleared). The EXC_RETURN is
+  * 		saved with SF2 on the task's stack, preceded by S16-S31 for an extended frame.
   * @param  None
   * @retval None
   */
+#if defined(__ARM_FP)
+__attribute__((naked)) void PendSV_Handler(void)
+{
+	/* Save the context of current running task */
+
+	__asm volatile("MRS R0,PSP"); /* Get current running task's PSP value */
+
+	__asm volatile("TST LR,#0x10"); /* Extended frame if EXC_RETURN bit 4 is cleared */
+
+	__asm volatile("IT EQ");
+
+	__asm volatile("VSTMDBEQ R0!,{S16-S31}"); /* Store S16-S31, this also completes the lazy stacking of S0-S15 */
+
+	__asm volatile("STMDB R0!,{R4-R11,LR}"); /* Store SF2 (registers R4-R11) and the task's EXC_RETURN */
+
+	__asm volatile("BL Save_PSP_Value"); /* Save the PSP value in the current task's TCB */
+
+	/* Retrieve the context of the next task */
+
+	__asm volatile("MOV R0,#" IT_STR(KERNEL_BASEPRI)); /* Mask the kernel-aware interrupts, PendSV has the lowest priority */
+
+	__asm volatile("MSR BASEPRI,R0");
+
+	__asm volatile("ISB");
+
+	__asm volatile("BL Schedule"); /* Decide the next task to run */
+
+	__asm volatile("MOV R0,#0"); /* Unmask the kernel-aware interrupts */
+
+	__asm volatile("MSR BASEPRI,R0");
+
+#if (LATENCY_BENCHMARK == 1)
+	__asm volatile("BL Latency_Stamp_Switch"); /* Timestamp the switch for the latency harness */
+#endif
+
+#if (LIBC_REENT == 1)
+	__asm volatile("BL Libc_Switch"); /* Make the new task's C library reentrancy structure current */
+#endif
+
+	__asm volatile ("BL Get_PSP_Value"); /* Get the new task's PSP value */
+
+	__asm volatile ("LDMIA R0!,{R4-R11,LR}"); /* Retrieve SF2 (registers R4-R11) and the task's EXC_RETURN */
+
+	__asm volatile("TST LR,#0x10");
+
+	__asm volatile("IT EQ");
+
+	__asm volatile("VLDMIAEQ R0!,{S16-S31}"); /* Retrieve S16-S31 of an extended frame */
+
+	__asm volatile("MSR PSP,R0"); /* Update PSP */
+
+	__asm volatile("BX LR"); /* Exception return using the task's EXC_RETURN */
+}
+#else
 __attribute__((naked)) void PendSV_Handler(void)
 {
 	/* Save the context of current running task */
@@ -40,8 +119,26 @@ __attribute__((naked)) void PendSV_Handler(void)
 
 	/* Retrieve the context of the next task */
 
+	__asm volatile("MOV R0,#" IT_STR(KERNEL_BASEPRI)); /* Mask the kernel-aware interrupts, PendSV has the lowest priority */
+
+	__asm volatile("MSR BASEPRI,R0");
+
+	__asm volatile("ISB");
+
 	__asm volatile("BL Schedule"); /* Decide the next task to run */
 
+	__asm volatile("MOV R0,#0"); /* Unmask the kernel-aware interrupts */
+
+	__asm volatile("MSR BASEPRI,R0");
+
+#if (LATENCY_BENCHMARK == 1)
+	__asm volatile("BL Latency_Stamp_Switch"); /* Timestamp the switch for the latency harness */
+#endif
+
+#if (LIBC_REENT == 1)
+	__asm volatile("BL Libc_Switch"); /* Make the new task's C library reentrancy structure current */
+#endif
+
 	__asm volatile ("BL Get_PSP_Value"); /* Get the new task's PSP value */
 
 	__asm volatile ("LDMIA R0!,{R4-R11}"); /* Using that PSP value retrieve SF2 (registers R4-R11) */
@@ -52,26 +149,93 @@ __attribute__((naked)) void PendSV_Handler(void)
 
 	__asm volatile("BX LR"); /* Exception return using the EXC_RETURN in LR*/
 }
+#endif
 
 /**
-  * @brief  Handler for the SysTick system exception. Takes place every 1ms. It increments the
-  * 		program's global tick count variable - g_tick_count, unblocks qualified tasks and
-  * 		initiates a contect-switch.
+  * @brief  Handler for the SysTick system exception. Takes place every 1ms. It charges the elapsed
+  * 		tick to the running task's CPU budget, increments the program's global tick count
+  * 		variable - g_tick_count, unblocks qualified tasks, posts the expired time events of the
+  * 		active objects and initiates a contect-switch.
   * @param  None
   * @retval None
   */
 void SysTick_Handler(void)
 {
+	uint32_t BasepriState;
+
+	/* Kernel-aware interrupts of higher priority could preempt the update of the kernel objects */
+	INTERRUPT_SAVE_AND_DISABLE(BasepriState);
+
+	/* Charge the running task's CPU budget */
+	Budget_Charge();
+
+	/* Account the tick to the idle-time statistics */
+	Idle_Account_Tick();
+
+	/* Let the frequency governor sample the load, it may switch the operating point */
+	Dvfs_Tick();
+
 	/* Increment the program's global tick count */
 	Increment_Global_Tick_Count();
 
 	/* Unblock qualified tasks */
 	Unblock_Tasks();
 
-	/* Pend the PendSV exception and initiate a contect-switch */
+	/* Post the expired time events to their active objects. Their wakeups follow the tick's
+	 * unblocking, in the order Tools/sched_replay replays them */
+	Active_Tick();
+
+#if (SCHED_COOPERATIVE == 0)
+	/* Pend the PendSV exception and initiate a contect-switch. In the cooperative mode the tick
+	 * only advances time, the unblocked tasks run once the running task yields */
 	Pend_PendSV();
+#endif
+
+	/* Restore interrupts */
+	INTERRUPT_RESTORE(BasepriState);
 }
 
+#if (CRASH_CAPTURE == 1)
+/**
+  * @brief  Handler for the HardFault system exception. Captures the crash and resets.
+  * @param  None
+  * @retval None
+  */
+__attribute__((naked)) void HardFault_Handler(void)
+{
+	FAULT_CAPTURE();
+}
+
+/**
+  * @brief  Handler for the MemManage system exception. Captures the crash and resets.
+  * @param  None
+  * @retval None
+  */
+__attribute__((naked)) void MemManage_Handler(void)
+{
+	FAULT_CAPTURE();
+}
+
+/**
+  * @brief  Handler for the BusFault system exception. Captures the crash and resets.
+  * @param  None
+  * @retval None
+  */
+__attribute__((naked)) void BusFault_Handler(void)
+{
+	FAULT_CAPTURE();
+}
+
+/**
+  * @brief  Handler for the UsageFault system exception. Captures the crash and resets.
+  * @param  None
+  * @retval None
+  */
+__attribute__((naked)) void UsageFault_Handler(void)
+{
+	FAULT_CAPTURE();
+}
+#else
 /**
   * @brief  Handler for the HardFault system exception.
   * @param  None
@@ -115,3 +279,4 @@ void UsageFault_Handler(void)
 	printf("Exception : UsageFault\n");
 	while(1);
 }
+#endif /* CRASH_CAPTURE */
@@ -0,0 +1,366 @@
+/**
+ ******************************************************************************
+ * @file           : latency_bench.c
+ * @author         : Noam Yakar
+ * @brief          : This file contains the interrupt-to-task latency harness.
+ *                   TIM3 fires a periodic interrupt that wakes the harness
+ *                   task with a notification. Each wakeup is timestamped at
+ *                   the ISR entry, when PendSV_Handler switches to the task,
+ *                   and at the task's first instruction after the wakeup, and
+ *                   the TIM3 counter read at the ISR entry gives the time from
+ *                   the timer event to the ISR. The min/avg/max and histogram
+ *                   of each interval are printed as CSV.
+ *                   Enabled by LATENCY_BENCHMARK in task_config.h.
+ *
+ *                   Board: DWT CYCCNT timestamps, results over ITM or
+ *                   semihosting (LATENCY_SEMIHOSTING).
+ *                   QEMU regression run, see Tools/latency/run_qemu.sh.
+ ******************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------- */
+
+#include <stdarg.h>
+#include "latency.h"
+#include "notify.h"
+#include "idle.h"
+#include "irq.h"
+
+#if (LATENCY_BENCHMARK == 1)
+
+/* Macros ------------------------------------------------------------------- */
+
+/* RCC APB1 clock enable register */
+#define RCC_APB1ENR              ( (RCC_AHB1_BASE) + 0x40U )
+
+/* TIM3 registers */
+#define TIM3_BASE                0x40000400U
+#define TIM3_CR1                 ( (TIM3_BASE) + 0x00U )
+#define TIM3_DIER                ( (TIM3_BASE) + 0x0CU )
+#define TIM3_SR                  ( (TIM3_BASE) + 0x10U )
+#define TIM3_CNT                 ( (TIM3_BASE) + 0x24U )
+#define TIM3_PSC                 ( (TIM3_BASE) + 0x28U )
+#define TIM3_ARR                 ( (TIM3_BASE) + 0x2CU )
+#define TIM3_IRQ_NUMBER          29U
+
+/* Semihosting operations */
+#define SEMIHOSTING_SYS_WRITE0   0x04U
+#define SEMIHOSTING_SYS_EXIT     0x18U
+#define ADP_STOPPED_EXIT         0x20026U  /* ADP_Stopped_ApplicationExit, exit code 0 */
+#define ADP_STOPPED_ERROR        0x20023U  /* ADP_Stopped_RunTimeErrorUnknown, exit code 1 */
+
+/* Intervals between timestamps longer than this are reported as errors */
+#define LATENCY_SANE_CYCLES      1000000U
+
+/* Types -------------------------------------------------------------------- */
+
+/* Progress of the current wakeup */
+typedef enum
+{
+	LATENCY_BUSY,                   /* The task is recording the previous wakeup */
+	LATENCY_WAITING,                /* The task is about to block */
+	LATENCY_FIRED,                  /* The ISR woke the task up */
+	LATENCY_SWITCHED                /* PendSV_Handler switched to the task */
+} LatencyState_e;
+
+/* Measured intervals */
+typedef enum
+{
+	LATENCY_IRQ_ENTRY,              /* Timer event to the ISR entry, in timer clocks */
+	LATENCY_ISR_TO_SWITCH,          /* ISR entry to the switch to the task */
+	LATENCY_SWITCH_TO_TASK,         /* Switch to the task's first instruction */
+	LATENCY_TOTAL,                  /* Timer event to the task's first instruction */
+	LATENCY_METRICS
+} LatencyMetric_e;
+
+/* Statistics of an interval */
+typedef struct
+{
+	uint32_t min;
+	uint32_t max;
+	uint64_t sum;
+	uint32_t count;
+	uint32_t histogram[LATENCY_BUCKETS];
+} LatencyStats_t;
+
+/* Global variables --------------------------------------------------------- */
+
+extern TaskControlBlock_t *gpCurrentRunningTask;
+extern uint32_t gTickCount;
+
+static const char *const gLatencyMetricNames[LATENCY_METRICS] = {"irq_entry", "isr_to_switch", "switch_to_task", "total"};
+
+static TaskControlBlock_t *pLatencyTask = NULL;
+static volatile LatencyState_e gLatencyState = LATENCY_BUSY;
+static volatile uint32_t gLatencyIrqEntry = 0;
+static volatile uint32_t gLatencyIrqStamp = 0;
+static volatile uint32_t gLatencySwitchStamp = 0;
+
+/* Interrupts that found the task busy, and wakeups that didn't need a context-switch */
+static volatile uint32_t gLatencySkipped = 0;
+static uint32_t gLatencyNoSwitch = 0;
+static uint32_t gLatencyErrors = 0;
+
+static LatencyStats_t gLatencyStats[LATENCY_METRICS];
+
+/* Functions definitions ---------------------------------------------------- */
+
+/**
+  * @brief  Reads the timestamp clock, in core clock cycles.
+  * @note   The SysTick clock combines the tick count and the SysTick counter. A wrap of the
+  * 		counter whose SysTick exception didn't run yet is detected by the pending bit.
+  * @param  None
+  * @retval Timestamp.
+  */
+static uint32_t Latency_Now(void)
+{
+#if (LATENCY_CLOCK == LATENCY_CLOCK_DWT)
+	return *((volatile uint32_t*)DWT_CYCCNT);
+#else
+	volatile uint32_t *pSYST_CVR = (uint32_t*)SYST_CVR;
+	volatile uint32_t *pSYST_RVR = (uint32_t*)SYST_RVR;
+	volatile uint32_t *pICSR = (uint32_t*)ICSR;
+	uint32_t Period = *pSYST_RVR + 1U;
+	uint32_t State;
+	uint32_t Ticks;
+	uint32_t Current;
+
+	INTERRUPT_MASK_ALL_SAVE(State);
+	Ticks = gTickCount;
+	Current = *pSYST_CVR;
+	if(*pICSR & ( 1 << 26))        /* PENDSTSET - the counter wrapped, read it again after the wrap */
+	{
+		Current = *pSYST_CVR;
+		Ticks++;
+	}
+	INTERRUPT_MASK_ALL_RESTORE(State);
+
+	return (Ticks * Period) + (Period - 1U - Current);
+#endif
+}
+
+/**
+  * @brief  Prints a line of the results, over semihosting or with printf.
+  * @param  pFormat - printf format string.
+  * @retval None
+  */
+static void Latency_Print(const char *pFormat, ...)
+{
+	va_list Args;
+
+	va_start(Args, pFormat);
+#if (LATENCY_SEMIHOSTING == 1)
+	char Line[96];
+
+	vsnprintf(Line, sizeof(Line), pFormat, Args);
+
+	register uint32_t Operation __asm("r0") = SEMIHOSTING_SYS_WRITE0;
+	register char *pLine __asm("r1") = Line;
+	__asm volatile ("BKPT 0xAB" : "+r" (Operation) : "r" (pLine) : "memory");
+#else
+	vprintf(pFormat, Args);
+#endif
+	va_end(Args);
+}
+
+/**
+  * @brief  Ends the run. Under semihosting the exit status tells whether the run passed.
+  * @param  Passed - 1 if the run passed, 0 otherwise.
+  * @retval None
+  */
+static void Latency_Exit(uint8_t Passed)
+{
+#if (LATENCY_SEMIHOSTING == 1)
+	register uint32_t Operation __asm("r0") = SEMIHOSTING_SYS_EXIT;
+	register uint32_t Reason __asm("r1") = Passed ? ADP_STOPPED_EXIT : ADP_STOPPED_ERROR;
+	__asm volatile ("BKPT 0xAB" : "+r" (Operation) : "r" (Reason) : "memory");
+#else
+	(void)Passed;
+#endif
+}
+
+/**
+  * @brief  Handler for the TIM3 interrupt. Timestamps the ISR entry and wakes up the harness task.
+  * @param  None
+  * @retval None
+  */
+void TIM3_IRQHandler(void)
+{
+	uint32_t Entry = *((volatile uint32_t*)TIM3_CNT);
+	uint32_t Stamp = Latency_Now();
+	uint32_t *pTIM3_SR = (uint32_t*)TIM3_SR;
+
+	/* Clear the update interrupt flag */
+	*pTIM3_SR &= ~( 1 << 0);
+
+	if(gLatencyState != LATENCY_WAITING)
+	{
+		gLatencySkipped++;
+		return;
+	}
+
+	gLatencyIrqEntry = Entry;
+	gLatencyIrqStamp = Stamp;
+	gLatencyState = LATENCY_FIRED;
+	Task_Notify_Give(pLatencyTask);
+}
+
+/**
+  * @brief  Called by PendSV_Handler once the next task is selected. Timestamps the switch to the
+  * 		harness task after a wakeup.
+  * @param  None
+  * @retval None
+  */
+void Latency_Stamp_Switch(void)
+{
+	if((gLatencyState == LATENCY_FIRED) && (gpCurrentRunningTask == pLatencyTask))
+	{
+		gLatencySwitchStamp = Latency_Now();
+		gLatencyState = LATENCY_SWITCHED;
+	}
+}
+
+/**
+  * @brief  Adds a sample to the statistics of an interval.
+  * @param  Metric - The interval.
+  * @param  Cycles - The sample.
+  * @retval None
+  */
+static void Latency_Record(LatencyMetric_e Metric, uint32_t Cycles)
+{
+	LatencyStats_t *pStats = &gLatencyStats[Metric];
+	uint32_t Bucket = Cycles / LATENCY_BUCKET_CYCLES;
+
+	if(Cycles < pStats->min)
+	{
+		pStats->min = Cycles;
+	}
+	if(Cycles > pStats->max)
+	{
+		pStats->max = Cycles;
+	}
+	pStats->sum += Cycles;
+	pStats->count++;
+	pStats->histogram[(Bucket < LATENCY_BUCKETS) ? Bucket : (LATENCY_BUCKETS - 1U)]++;
+}
+
+/**
+  * @brief  Prints the statistics and the non-empty histogram buckets of every interval, and the
+  * 		verdict of the run.
+  * @param  None
+  * @retval 1 if the run passed, 0 otherwise.
+  */
+static uint8_t Latency_Report(void)
+{
+	uint8_t Passed = (gLatencyErrors == 0U) && (gLatencyStats[LATENCY_TOTAL].count != 0U);
+
+	if((LATENCY_MAX_CYCLES != 0U) && (gLatencyStats[LATENCY_TOTAL].max > LATENCY_MAX_CYCLES))
+	{
+		Passed = 0;
+	}
+
+	Latency_Print("metric,samples,min,avg,max\n");
+	for(uint32_t m = 0 ; m < LATENCY_METRICS ; m++)
+	{
+		LatencyStats_t *pStats = &gLatencyStats[m];
+		Latency_Print("%s,%lu,%lu,%lu,%lu\n", gLatencyMetricNames[m], (unsigned long)pStats->count,
+		              (unsigned long)pStats->min, (unsigned long)(pStats->count ? (pStats->sum / pStats->count) : 0U),
+		              (unsigned long)pStats->max);
+	}
+
+	Latency_Print("histogram,metric,from_cycles,samples\n");
+	for(uint32_t m = 0 ; m < LATENCY_METRICS ; m++)
+	{
+		for(uint32_t b = 0 ; b < LATENCY_BUCKETS ; b++)
+		{
+			if(gLatencyStats[m].histogram[b] != 0U)
+			{
+				Latency_Print("histogram,%s,%lu,%lu\n", gLatencyMetricNames[m], (unsigned long)(b * LATENCY_BUCKET_CYCLES),
+				              (unsigned long)gLatencyStats[m].histogram[b]);
+			}
+		}
+	}
+
+	Latency_Print("result,%s,skipped %lu,no_switch %lu,errors %lu\n", Passed ? "PASS" : "FAIL",
+	              (unsigned long)gLatencySkipped, (unsigned long)gLatencyNoSwitch, (unsigned long)gLatencyErrors);
+
+	return Passed;
+}
+
+/**
+  * @brief  Handler of the harness task. Measures LATENCY_SAMPLES wakeups by the TIM3 interrupt
+  * 		and reports the results.
+  * @param  None
+  * @retval None
+  */
+void Latency_Benchmark_Task_Handler(void)
+{
+	uint32_t *pRCC_APB1ENR = (uint32_t*)RCC_APB1ENR;
+	uint32_t *pTIM3_CR1 = (uint32_t*)TIM3_CR1;
+	uint32_t *pTIM3_DIER = (uint32_t*)TIM3_DIER;
+	uint32_t *pTIM3_PSC = (uint32_t*)TIM3_PSC;
+	uint32_t *pTIM3_ARR = (uint32_t*)TIM3_ARR;
+	uint32_t TaskStamp;
+
+	pLatencyTask = gpCurrentRunningTask;
+	for(uint32_t m = 0 ; m < LATENCY_METRICS ; m++)
+	{
+		gLatencyStats[m].min = 0xFFFFFFFFU;
+	}
+	Cycle_Counter_Init();
+
+	/* TIM3 is halted in Stop mode */
+	Idle_Stop_Inhibit();
+
+	/* Configure TIM3 as a periodic timer with an update interrupt, at the highest kernel-aware priority */
+	*pRCC_APB1ENR |= ( 1 << 1);   /* Enable the peripheral clock of TIM3 */
+	*pTIM3_PSC = 0;
+	*pTIM3_ARR = LATENCY_PERIOD - 1U;
+	*pTIM3_DIER |= ( 1 << 0);     /* UIE - update interrupt enable */
+	Irq_Set_Priority(TIM3_IRQ_NUMBER, IRQ_KERNEL_PRIORITY);
+	Irq_Enable(TIM3_IRQ_NUMBER);
+	*pTIM3_CR1 |= ( 1 << 0);      /* CEN - enable the counter */
+
+	while(gLatencyStats[LATENCY_TOTAL].count < LATENCY_SAMPLES)
+	{
+		gLatencyState = LATENCY_WAITING;
+		Task_Notify_Take(1, TASK_BLOCK_FOREVER);
+		TaskStamp = Latency_Now();
+
+		/* The interrupt fired before the task blocked, the notification was already pending */
+		if(gLatencyState != LATENCY_SWITCHED)
+		{
+			gLatencyState = LATENCY_BUSY;
+			gLatencyNoSwitch++;
+			continue;
+		}
+		gLatencyState = LATENCY_BUSY;
+
+		uint32_t IsrToSwitch = gLatencySwitchStamp - gLatencyIrqStamp;
+		uint32_t SwitchToTask = TaskStamp - gLatencySwitchStamp;
+
+		if((IsrToSwitch > LATENCY_SANE_CYCLES) || (SwitchToTask > LATENCY_SANE_CYCLES))
+		{
+			gLatencyErrors++;
+			continue;
+		}
+
+		Latency_Record(LATENCY_IRQ_ENTRY, gLatencyIrqEntry);
+		Latency_Record(LATENCY_ISR_TO_SWITCH, IsrToSwitch);
+		Latency_Record(LATENCY_SWITCH_TO_TASK, SwitchToTask);
+		Latency_Record(LATENCY_TOTAL, gLatencyIrqEntry + IsrToSwitch + SwitchToTask);
+	}
+
+	*pTIM3_CR1 &= ~( 1 << 0);
+	Irq_Disable(TIM3_IRQ_NUMBER);
+	Idle_Stop_Allow();
+
+	Latency_Exit(Latency_Report());
+
+	while(1)
+	{
+		Task_Delay(DELAY_1S);
+	}
+}
+
+#endif /* LATENCY_BENCHMARK */
@@ -0,0 +1,288 @@
+/**
+ ******************************************************************************
+ * @file           : libc.c
+ * @author         : Noam Yakar
+ * @brief          : This file contains the C library (newlib) port. Each task
+ *                   owns a reentrancy structure (errno, stdio streams, strtok
+ *                   state...), made current by PendSV_Handler. The library's
+ *                   retargetable locks - stdio, malloc, atexit, environment -
+ *                   are recursive mutexes built on kernel semaphores, so tasks
+ *                   can use the C library concurrently, and a task that blocks
+ *                   in the middle of a printf (UART buffer full) keeps the
+ *                   stream's lock while the other tasks run.
+ ******************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------- */
+
+#include "libc.h"
+
+#if (LIBC_REENT == 1)
+
+#include <reent.h>
+#include <sys/lock.h>
+#include "semaphore.h"
+#include "mempool.h"
+
+/* Macros ------------------------------------------------------------------- */
+
+/* Statically allocated lock, free */
+#define LIBC_LOCK_INITIALIZER    { {1U, NULL}, NULL, 0U }
+
+/* Types -------------------------------------------------------------------- */
+
+/* The C library's lock, a recursive mutex */
+struct __lock
+{
+	Semaphore_t sem;                /*!< Binary semaphore, 1 while the lock is free */
+	TaskControlBlock_t *owner;      /*!< Task holding the lock, NULL if it's free */
+	uint32_t depth;                 /*!< Number of acquisitions by the owner */
+};
+
+/* Global variables --------------------------------------------------------- */
+
+/* Kernel objects, allocated in main.c */
+extern TaskControlBlock_t gTaskTable[NUMBER_OF_STATIC_TASKS];
+extern TaskControlBlock_t *gpCurrentRunningTask;
+
+/* The C library's static locks */
+struct __lock __lock___sinit_recursive_mutex = LIBC_LOCK_INITIALIZER;
+struct __lock __lock___sfp_recursive_mutex = LIBC_LOCK_INITIALIZER;
+struct __lock __lock___atexit_recursive_mutex = LIBC_LOCK_INITIALIZER;
+struct __lock __lock___at_quick_exit_mutex = LIBC_LOCK_INITIALIZER;
+struct __lock __lock___malloc_recursive_mutex = LIBC_LOCK_INITIALIZER;
+struct __lock __lock___env_recursive_mutex = LIBC_LOCK_INITIALIZER;
+struct __lock __lock___tz_mutex = LIBC_LOCK_INITIALIZER;
+struct __lock __lock___dd_hash_mutex = LIBC_LOCK_INITIALIZER;
+struct __lock __lock___arc4random_mutex = LIBC_LOCK_INITIALIZER;
+
+/* Locks created at runtime */
+MEMPOOL_STORAGE(gLibcLockStorage, sizeof(struct __lock), LIBC_MAX_LOCKS);
+static MemPool_t gLibcLockPool;
+
+/* Private functions definitions -------------------------------------------- */
+
+/**
+  * @brief  Tells whether the locks are bypassed: in handler mode, where a task can't be blocked,
+  * 		and before the scheduler starts, while main() runs alone on the MSP.
+  * @param  None
+  * @retval 1 if the locks are bypassed, 0 otherwise.
+  */
+static uint8_t Libc_Lock_Bypass(void)
+{
+	uint32_t Ipsr;
+	uint32_t Control;
+
+	__asm volatile ("MRS %0,IPSR" : "=r" (Ipsr));
+	__asm volatile ("MRS %0,CONTROL" : "=r" (Control));
+
+	return (Ipsr != 0U) || !(Control & ( 1 << 1));
+}
+
+/**
+  * @brief  Allocates a lock from the pool.
+  * @param  pLock - Pointer to the lock handle, NULL if the pool is exhausted.
+  * @retval None
+  */
+static void Libc_Lock_Create(_LOCK_T *pLock)
+{
+	struct __lock *pNew = NULL;
+
+	/* Streams opened before Libc_Init() aren't locked */
+	if(gLibcLockPool.storage != NULL)
+	{
+		pNew = MemPool_Alloc(&gLibcLockPool);
+	}
+	if(pNew != NULL)
+	{
+		Semaphore_Init(&(pNew->sem), 1);
+		pNew->owner = NULL;
+		pNew->depth = 0;
+	}
+	*pLock = pNew;
+}
+
+/**
+  * @brief  Acquires a lock, blocking the current running task while another task holds it.
+  * @param  Lock - The lock.
+  * @retval None
+  */
+static void Libc_Lock_Acquire(_LOCK_T Lock)
+{
+	if((Lock == NULL) || Libc_Lock_Bypass())
+	{
+		return;
+	}
+
+	if(Lock->owner != gpCurrentRunningTask)
+	{
+		Semaphore_Take(&(Lock->sem), TASK_BLOCK_FOREVER);
+		Lock->owner = gpCurrentRunningTask;
+	}
+	Lock->depth++;
+}
+
+/**
+  * @brief  Acquires a lock if no other task holds it.
+  * @param  Lock - The lock.
+  * @retval 0 if the lock was acquired, -1 otherwise.
+  */
+static int Libc_Lock_Try_Acquire(_LOCK_T Lock)
+{
+	uint32_t State;
+	uint8_t Taken = 1;
+
+	if((Lock == NULL) || Libc_Lock_Bypass())
+	{
+		return 0;
+	}
+
+	if(Lock->owner != gpCurrentRunningTask)
+	{
+		INTERRUPT_SAVE_AND_DISABLE(State);
+		Taken = (Lock->sem.count != 0U);
+		if(Taken)
+		{
+			Lock->sem.count--;
+			Lock->owner = gpCurrentRunningTask;
+		}
+		INTERRUPT_RESTORE(State);
+	}
+	if(!Taken)
+	{
+		return -1;
+	}
+
+	Lock->depth++;
+	return 0;
+}
+
+/**
+  * @brief  Releases one acquisition of a lock, and the lock itself with the last one.
+  * @param  Lock - The lock.
+  * @retval None
+  */
+static void Libc_Lock_Release(_LOCK_T Lock)
+{
+	if((Lock == NULL) || Libc_Lock_Bypass() || (Lock->owner != gpCurrentRunningTask))
+	{
+		return;
+	}
+
+	if(--(Lock->depth) == 0U)
+	{
+		Lock->owner = NULL;
+		Semaphore_Give(&(Lock->sem));
+	}
+}
+
+/* Functions definitions ---------------------------------------------------- */
+
+/**
+  * @brief  Initializes the reentrancy structures of the static tasks and the pool of runtime
+  * 		locks. Called by main() before the scheduler starts.
+  * @param  None
+  * @retval None
+  */
+void Libc_Init(void)
+{
+	MemPool_Init(&gLibcLockPool, gLibcLockStorage, sizeof(struct __lock), LIBC_MAX_LOCKS);
+
+	for(uint32_t i = 0 ; i < NUMBER_OF_STATIC_TASKS ; i++)
+	{
+		Libc_Reent_Init(&gTaskTable[i]);
+	}
+}
+
+/**
+  * @brief  Initializes a task's reentrancy structure. Its streams are opened on first use.
+  * @param  pTask - Pointer to the task.
+  * @retval None
+  */
+void Libc_Reent_Init(TaskControlBlock_t *pTask)
+{
+	_REENT_INIT_PTR(&(pTask->reent));
+}
+
+/**
+  * @brief  Releases the memory of the current running task's streams. Called by Task_Exit().
+  * @param  None
+  * @retval None
+  */
+void Libc_Reent_Reclaim(void)
+{
+	struct _reent *pReent = &(gpCurrentRunningTask->reent);
+
+	/* The C library doesn't reclaim the current structure */
+	_impure_ptr = _global_impure_ptr;
+	_reclaim_reent(pReent);
+}
+
+/**
+  * @brief  Makes the current running task's reentrancy structure the C library's current one.
+  * 		Called by PendSV_Handler after Schedule(), and by main() for the first task.
+  * @param  None
+  * @retval None
+  */
+void Libc_Switch(void)
+{
+	_impure_ptr = &(gpCurrentRunningTask->reent);
+}
+
+/**
+  * @brief  The C library's retargetable lock functions.
+  */
+void __retarget_lock_init(_LOCK_T *pLock)
+{
+	Libc_Lock_Create(pLock);
+}
+
+void __retarget_lock_init_recursive(_LOCK_T *pLock)
+{
+	Libc_Lock_Create(pLock);
+}
+
+void __retarget_lock_close(_LOCK_T Lock)
+{
+	if(Lock != NULL)
+	{
+		MemPool_Free(&gLibcLockPool, Lock);
+	}
+}
+
+void __retarget_lock_close_recursive(_LOCK_T Lock)
+{
+	__retarget_lock_close(Lock);
+}
+
+void __retarget_lock_acquire(_LOCK_T Lock)
+{
+	Libc_Lock_Acquire(Lock);
+}
+
+void __retarget_lock_acquire_recursive(_LOCK_T Lock)
+{
+	Libc_Lock_Acquire(Lock);
+}
+
+int __retarget_lock_try_acquire(_LOCK_T Lock)
+{
+	return Libc_Lock_Try_Acquire(Lock);
+}
+
+int __retarget_lock_try_acquire_recursive(_LOCK_T Lock)
+{
+	return Libc_Lock_Try_Acquire(Lock);
+}
+
+void __retarget_lock_release(_LOCK_T Lock)
+{
+	Libc_Lock_Release(Lock);
+}
+
+void __retarget_lock_release_recursive(_LOCK_T Lock)
+{
+	Libc_Lock_Release(Lock);
+}
+
+#endif /* LIBC_REENT */
@@ -8,27 +8,119 @@
 
 /* Includes ----------------------------------------------------------------- */
 
+#include <string.h>
 #include "main.h"
 #include "queue.h"
+#include "sched.h"
+#include "workqueue.h"
+#include "coroutine.h"
+#include "active.h"
+#include "notify.h"
+#include "dsp.h"
+#include "snapshot.h"
+#include "idle.h"
+#include "dvfs.h"
+#include "boot.h"
+#include "task.h"
+#include "irq.h"
+#include "latency.h"
+#include "uart.h"
+#include "libc.h"
+#include "crash.h"
 
 /* Global variables --------------------------------------------------------- */
 
-/* Allocate tasks objects in memory */
-TaskControlBlock_t gIdleTask;
-TaskControlBlock_t gTask1;
-TaskControlBlock_t gTask2;
-TaskControlBlock_t gTask3;
-TaskControlBlock_t gTask4;
+/* Number of words in a task's stack */
+#define STACK_WORDS(StackSize)   ((StackSize) / sizeof(uint32_t))
+
+#if (SCHED_COOPERATIVE == 1)
+/* Initial frame of a task in the cooperative mode, at the top of an array of Words words: the
+ * return address of Sched_Switch(), Sched_Task_Start(), followed by R11-R3. Sched_Task_Start()
+ * calls the entry point from R4 with the return address (Task_Exit) from R5 */
+#define TASK_FRAME(Words, Entry) \
+	[(Words) - 1U] = (uint32_t)Sched_Task_Start, \
+	[(Words) - 8U] = TASK_EXIT_ADDRESS, \
+	[(Words) - 9U] = (uint32_t)Entry,
+#else
+/* The EXC_RETURN stacked by PendSV_Handler below R12, R3-R0 in a hard-float build */
+#if defined(__ARM_FP)
+#define TASK_FRAME_EXC_RETURN(Words) [(Words) - 9U] = EXC_RETURN_THREAD_PSP,
+#else
+#define TASK_FRAME_EXC_RETURN(Words)
+#endif
+
+/* Initial exception frame of a task, at the top of an array of Words words: xPSR, PC and LR
+ * (Task_Exit), followed by zeros for R0-R12 */
+#define TASK_FRAME(Words, Entry) \
+	[(Words) - 1U] = DUMMY_XPSR, \
+	[(Words) - 2U] = (uint32_t)Entry, \
+	[(Words) - 3U] = TASK_EXIT_ADDRESS, \
+	TASK_FRAME_EXC_RETURN(Words)
+#endif /* SCHED_COOPERATIVE */
+
+#if (BOOT_FAST_START == 1)
+/* Allocate the tasks' stacks in .noinit, they are neither copied nor zeroed at boot. Only the
+ * initial frames are pre-built, in flash, and copied to the top of the stacks by
+ * Task_Frames_Init() */
+#define TASK_STACK(Id, Entry, StackSize, Deadline) \
+	static uint32_t gStack_##Id[STACK_WORDS(StackSize)] __attribute__((section(".noinit.task_stacks"), aligned(8)));
+TASK_TABLE(TASK_STACK)
+
+#define TASK_INITIAL_FRAME(Id, Entry, StackSize, Deadline) \
+	[Id] = { TASK_FRAME(TASK_INITIAL_FRAME_WORDS, Entry) },
+static const uint32_t gTaskFrames[NUMBER_OF_STATIC_TASKS][TASK_INITIAL_FRAME_WORDS] =
+{
+	TASK_TABLE(TASK_INITIAL_FRAME)
+};
+#else
+/* Allocate the tasks' stacks in the .task_stacks section of .data, with the initial exception
+ * frame pre-built at the top of the stack */
+#define TASK_STACK(Id, Entry, StackSize, Deadline) \
+	static uint32_t gStack_##Id[STACK_WORDS(StackSize)] __attribute__((section(".task_stacks"), aligned(8))) = \
+	{ \
+		TASK_FRAME(STACK_WORDS(StackSize), Entry) \
+	};
+TASK_TABLE(TASK_STACK)
+#endif /* BOOT_FAST_START */
+
+/* Reject a misconfigured tasks table at build time */
+#define TASK_CHECK(Id, Entry, StackSize, Deadline) \
+	_Static_assert(((StackSize) % 8U) == 0U, #Id " stack size must be a multiple of 8"); \
+	_Static_assert(STACK_WORDS(StackSize) > TASK_INITIAL_FRAME_WORDS, #Id " stack is too small");
+TASK_TABLE(TASK_CHECK)
+_Static_assert(IDLE_TASK == (NUMBER_OF_STATIC_TASKS - 1), "The idle task must be the last task in the table");
+
+/* Allocate tasks objects in memory. The tasks are linked in the ready queue by the order of
+ * the table, the idle task is the last one */
+#define TASK_TCB(Id, Entry, StackSize, Deadline) \
+	[Id] = \
+	{ \
+		.task_id = Id, \
+		.psp_value = &gStack_##Id[STACK_WORDS(StackSize) - TASK_INITIAL_FRAME_WORDS], \
+		.current_state = TASK_READY_STATE, \
+		.relative_deadline = (Deadline), \
+		.absolute_deadline = ((Deadline) == SCHED_NO_DEADLINE) ? SCHED_FAR_DEADLINE : (Deadline), \
+		.notify_state = NOTIFY_NOT_WAITING, \
+		.task_handler = Entry, \
+		.next = (Id == IDLE_TASK) ? NULL : &gTaskTable[Id + 1], \
+	},
+TaskControlBlock_t gTaskTable[NUMBER_OF_STATIC_TASKS] =
+{
+	TASK_TABLE(TASK_TCB)
+};
 
 /* Pointers to the tasks objects */
-TaskControlBlock_t *pIdleTask = &gIdleTask;
-TaskControlBlock_t *pTask1 = &gTask1;
-TaskControlBlock_t *pTask2 = &gTask2;
-TaskControlBlock_t *pTask3 = &gTask3;
-TaskControlBlock_t *pTask4 = &gTask4;
-
-/* Initialize ready queue and blocked queue */
-Queue_t gReadyQueue = {READY_QUEUE, NULL, Enqueue, Dequeue};
+TaskControlBlock_t *pIdleTask = &gTaskTable[IDLE_TASK];
+TaskControlBlock_t *pTask1 = &gTaskTable[TASK1];
+TaskControlBlock_t *pTask2 = &gTaskTable[TASK2];
+TaskControlBlock_t *pTask3 = &gTaskTable[TASK3];
+TaskControlBlock_t *pTask4 = &gTaskTable[TASK4];
+TaskControlBlock_t *pWorkQueueTask = &gTaskTable[WORKQUEUE_TASK];
+TaskControlBlock_t *pCoroutineTask = &gTaskTable[COROUTINE_TASK];
+TaskControlBlock_t *pActiveTask = &gTaskTable[ACTIVE_TASK];
+
+/* Initialize ready queue and blocked queue. All the static tasks start in the ready queue */
+Queue_t gReadyQueue = {READY_QUEUE, &gTaskTable[0], Enqueue, Dequeue};
 Queue_t gBlockedQueue = {BLOCKED_QUEUE, NULL, Enqueue, Dequeue};
 
 /* This variable specifies the current running task */
@@ -37,6 +129,9 @@ TaskControlBlock_t *gpCurrentRunningTask = NULL;
 /* This variable is the program counter updated by the SysTick handler every 1ms */
 uint32_t gTickCount = 0;
 
+/* Core clock in Hz, updated by the frequency governor on every operating point switch */
+uint32_t gSystemClock = HSI_CLOCK;
+
 /* Functions definitions ---------------------------------------------------- */
 
 /**
@@ -49,106 +144,106 @@ int main(void)
 	/* Enable system exceptions */
 	System_Exceptions_Enable();
 
+	/* Relocate the vector table to RAM and set the interrupt priorities */
+	Irq_Init();
+
+	/* Export the scheduler's stack size computed by Tools/stack_usage, the linker script checks the
+	 * stack it reserves against it */
+	__asm volatile (".global _Scheduler_Stack_Size\n\t.set _Scheduler_Stack_Size, %c0" : : "i" (STACK_SIZE_SCHEDULER));
+
 	/* Initialize MSP to the start of the scheduler's stack */
 	Scheduler_Stack_Init(SCHEDULER_STACK_START);
 
-	/* Initialize tasks' control block properties and push dummy contents to their stack */
-	Task_Init(pTask1, TASK1, (uint32_t*)T1_STACK_START, Task1_Handler);
-	Task_Init(pTask2, TASK2, (uint32_t*)T2_STACK_START, Task2_Handler);
-	Task_Init(pTask3, TASK3, (uint32_t*)T3_STACK_START, Task3_Handler);
-	Task_Init(pTask4, TASK4, (uint32_t*)T4_STACK_START, Task4_Handler);
-	Task_Init(pIdleTask, IDLE_TASK, (uint32_t*)IDLE_STACK_START, IdleTask_Handler);
+	/* The tasks' control blocks, stacks and the ready queue are initialized statically from the
+	 * tasks table. Copy the initial frames of the fast start's stacks */
+	Task_Frames_Init();
+
+#if (LIBC_REENT == 1)
+	/* Initialize the tasks' C library reentrancy structures and the C library locks */
+	Libc_Init();
+#endif
 
-	/* Enqueue tasks to the ready queue */
-	gReadyQueue.ENQUEUE(&(gReadyQueue.head), pTask1, REGULAR_ENQUEUE);
-	gReadyQueue.ENQUEUE(&(gReadyQueue.head), pTask2, REGULAR_ENQUEUE);
-	gReadyQueue.ENQUEUE(&(gReadyQueue.head), pTask3, REGULAR_ENQUEUE);
-	gReadyQueue.ENQUEUE(&(gReadyQueue.head), pTask4, REGULAR_ENQUEUE);
-	gReadyQueue.ENQUEUE(&(gReadyQueue.head), pIdleTask, REGULAR_ENQUEUE);
+	/* Build the ready structure of the selected scheduling policy */
+	gpSchedPolicy->INIT();
 
 	/* Update the current running task */
 	Schedule();
+	BOOT_TIMESTAMP(BOOT_PHASE_KERNEL_INIT);
+
+	/* Initialize the deferred interrupt work queue */
+	WorkQueue_Init();
+
+	/* Initialize the operating points, the core runs at the reset clock until the governor
+	 * switches */
+	Dvfs_Init();
 
 	/* Initialize the 4 on-board LEDs */
 	Led_Init();
 
+	/* Initialize the UART, the C library console if UART_CONSOLE is set */
+	Uart_Init();
+
+#if (CRASH_CAPTURE == 1)
+	/* Report the crash that caused the last reset */
+	Crash_Report();
+#endif
+
+	/* Initialize the idle task's low-power modes */
+	Idle_Init();
+
 	/* Initialize SysTick to 1KHz */
 	SysTick_Init(TICK_HZ);
+	BOOT_TIMESTAMP(BOOT_PHASE_DRIVERS_INIT);
 
 	/* Set PSP to the current running task's stack pointer and make it the active stack pointer. */
 	Switch_SP_To_PSP();
 
+#if (LIBC_REENT == 1)
+	/* The C library runs on the first task's reentrancy structure from now on */
+	Libc_Switch();
+#endif
+
 	/* Kick-start with the first task */
+	BOOT_TIMESTAMP(BOOT_PHASE_FIRST_TASK);
 	gpCurrentRunningTask->task_handler();
 
 	while(1);
 }
 
 /**
-  * @brief  Updates the variable current_running_task.
+  * @brief  Runs when no other task is ready. Reclaims terminated tasks, runs the idle hooks and
+  * 		puts the core in a low-power mode until the next interrupt.
   * @param  None
   * @retval None
   */
-void Schedule(void)
+void IdleTask_Handler(void)
 {
-	TaskControlBlock_t* pScheduledOutTask = NULL;
-
-	/* Only in the beginning there's no running task */
-	if(gpCurrentRunningTask == NULL)
-	{
-		gpCurrentRunningTask = gReadyQueue.DEQUEUE(&(gReadyQueue.head), DEQUEUE_WITH_REAR_IDLE_TASK);
-	}
-
-	/* The next task to be scheduled is not the idle task */
-	else if(gReadyQueue.head->task_id != IDLE_TASK)
-	{
-		/* Save the scheduled out task and update the current running task */
-		pScheduledOutTask = gpCurrentRunningTask;
-		gpCurrentRunningTask = gReadyQueue.DEQUEUE(&(gReadyQueue.head), DEQUEUE_WITH_REAR_IDLE_TASK);
-
-		/* Enqueue the scheduled out task to the ready queue if its not idle and its ready*/
-		if(pScheduledOutTask->task_id != IDLE_TASK)
-		{
-			if(pScheduledOutTask->current_state == TASK_READY_STATE)
-			{
-				gReadyQueue.ENQUEUE(&(gReadyQueue.head), pScheduledOutTask, ENQUEUE_WITH_REAR_IDLE_TASK);
-			}
-		}
-	}
-
-	/* The next task to be scheduled is the idle task */
-	else
+	while(1)
 	{
-		/* Schedule the idle task if no other option is available. A running task that's
-		 * in ready state will stay scheduled. */
-		if(gpCurrentRunningTask->task_id != IDLE_TASK)
-		{
-			if(gpCurrentRunningTask->current_state != TASK_READY_STATE)
-			{
-				pScheduledOutTask = gpCurrentRunningTask;
-				gpCurrentRunningTask = gReadyQueue.head; /* Schedule idle task */
-			}
-		}
+#if (SCHED_COOPERATIVE == 1)
+		/* Let the tasks made ready since the last iteration run */
+		Task_Yield();
+#endif
+
+		/* Release the memory of terminated tasks, run the idle hooks, then wait for the next
+		 * interrupt in a low-power mode */
+		Task_Reclaim();
+		Idle_Run_Hooks();
+		Idle_Enter_Low_Power();
 	}
 }
 
 /**
-  * @brief  Stuck in a while(1) loop and does nothing.
-  * @param  None
-  * @retval None
-  */
-void IdleTask_Handler(void)
-{
-	while(1);
-}
-
-/**
-  * @brief  Toggles the green LED every 1 second.
+  * @brief  Prints the boot-time profile, then toggles the green LED every 1 second.
   * @param  None
   * @retval None
   */
 void Task1_Handler(void)
 {
+#if (BOOT_PROFILE == 1)
+	Boot_Report();
+#endif
+
 	while(1)
 	{
 		Led_On(LED_GREEN);
@@ -206,6 +301,22 @@ void Task4_Handler(void)
 	}
 }
 
+/**
+  * @brief  Copies the pre-built initial frames of the tasks to the top of their stacks. With the
+  * 		fast start the stacks aren't initialized by the startup code, otherwise the frames are
+  * 		already in place.
+  * @param  None
+  * @retval None
+  */
+void Task_Frames_Init(void)
+{
+#if (BOOT_FAST_START == 1)
+#define TASK_FRAME_COPY(Id, Entry, StackSize, Deadline) \
+	memcpy(&gStack_##Id[STACK_WORDS(StackSize) - TASK_INITIAL_FRAME_WORDS], gTaskFrames[Id], sizeof(gTaskFrames[Id]));
+	TASK_TABLE(TASK_FRAME_COPY)
+#endif
+}
+
 /**
   * @brief  Initialize the processor peripheral SysTick to a certain reload value.
   * @param  TickHz - The wanted ticking frequency in Hz.
@@ -216,15 +327,22 @@ void SysTick_Init(uint32_t TickHz)
 	/* Define pointers to relevant SysTick registers */
 	uint32_t *pSYST_CSR = (uint32_t*)SYST_CSR; /* pointer to SysTick Control and Status Register */
 	uint32_t *pSYST_RVR = (uint32_t*)SYST_RVR; /* pointer to SysTick Reload Value Register */
+	uint32_t *pSYST_CVR = (uint32_t*)SYST_CVR; /* pointer to SysTick Current Value Register */
 
-    /* Calculate the reload value */
-	uint32_t SystemTicksInOneSecond = (SYSTICK_TIM_CLK/TickHz);
+    /* Calculate the reload value from the current core clock */
+	uint32_t SystemTicksInOneSecond = (gSystemClock/TickHz);
 	uint32_t ReloadValue = SystemTicksInOneSecond-1;
 
+	/* Stop the counter while it's reprogrammed, Dvfs_Set_Point() calls again after every switch */
+	*pSYST_CSR &= ~( 1 << 0);
+
 	/* Clear RVR and load the reload value */
 	*pSYST_RVR &= ~(0x00FFFFFFFF);
 	*pSYST_RVR |= ReloadValue;
 
+	/* Restart the count from the new reload value */
+	*pSYST_CVR = 0;
+
 	/* Enable the SysTick features */
 	*pSYST_CSR |= ( 1 << 1); /* Enable SysTick exception request - assert request */
 	*pSYST_CSR |= ( 1 << 2); /* Indicates the clock source - processor clock */
@@ -248,7 +366,8 @@ __attribute__((naked)) void Scheduler_Stack_Init(uint32_t SchedulerStackStart)
 /**
   * @brief  Initializes a task's control block properties and pushes dummy contents
   * 		to its stack.
-  * @note   The stack is Full Descending.
+  * @note   The stack is Full Descending. The tasks of the tasks table (task_config.h) are
+  * 		initialized statically, this function is used for tasks created at runtime.
   * @param  pTask - pointer to a TaskControlBlock_t structure that contains task properties.
   * @param  TaskID - a TaskID_e enumerator that specifies the ID of a task.
   * 			This parameter can be one of the following values:
@@ -257,6 +376,10 @@ __attribute__((naked)) void Scheduler_Stack_Init(uint32_t SchedulerStackStart)
   * 				@arg TASK2 : Task 2
   * 				@arg TASK3 : Task 3
   * 				@arg TASK4 : Task 4
+  * 				@arg WORKQUEUE_TASK : Deferred interrupt work task
+  * 				@arg COROUTINE_TASK : Stackless coroutines task
+  * 				@arg ACTIVE_TASK : Active objects task
+  * 				@arg DYNAMIC_TASK : Task created at runtime by Task_Create()
   * @param  pPSPValue - Pointer to the task's stack start that will be used as PSP.
   * @param  pTaskHandler - Pointer to the task handler function.
   * @retval None
@@ -268,22 +391,75 @@ void Task_Init(TaskControlBlock_t *pTask, TaskID_e TaskID, uint32_t *pPSPValue,
 	pTask->psp_value = pPSPValue;
 	pTask->block_count = 0;
 	pTask->current_state = TASK_READY_STATE;
+	pTask->relative_deadline = SCHED_NO_DEADLINE;
+	pTask->absolute_deadline = gTickCount + SCHED_FAR_DEADLINE;
+	pTask->deadline_misses = 0;
+	pTask->job_done = 1;
+	pTask->budget.budget = 0;
+	pTask->budget.period = 0;
+	pTask->budget.used = 0;
+	pTask->budget.replenish_tick = 0;
+	pTask->budget.overruns = 0;
+	pTask->budget.overrun_handler = NULL;
+	pTask->notify_value = 0;
+	pTask->notify_state = NOTIFY_NOT_WAITING;
+	pTask->wait_next = NULL;
+	pTask->sched_lock = 0;
+	pTask->flags = 0;
+	pTask->joiner = NULL;
 	pTask->task_handler = pTaskHandler;
 	pTask->next = NULL;
+#if (LIBC_REENT == 1)
+	Libc_Reent_Init(pTask);
+#endif
 
 	/* Get PSP value */
 	uint32_t *pPSP = pTask->psp_value;
 
+#if (SCHED_COOPERATIVE == 1)
+	/* Push the return address of Sched_Switch() */
+	*(--pPSP) = (uint32_t)Sched_Task_Start;
+
+	/* Push zeros for core registers R11-R6 */
+	for(int j = 0 ; j < 6 ; j++)
+	{
+		*(--pPSP) = 0;
+	}
+
+	*(--pPSP) = TASK_EXIT_ADDRESS; /* R5 - A task handler that returns lands in Task_Exit() */
+	*(--pPSP) = (uint32_t) pTaskHandler; /* R4 - Called by Sched_Task_Start() */
+	*(--pPSP) = 0; /* R3 - Keeps the frame 8-byte aligned */
+
+#if defined(__ARM_FP)
+	/* Push zeros for FPU registers S16-S31 */
+	for(int j = 0 ; j < 16 ; j++)
+	{
+		*(--pPSP) = 0;
+	}
+#endif
+#else
 	/* Push dummy values for core registers xPSR, PC, LR */
 	*(--pPSP) = DUMMY_XPSR; /* XPSR = 0x01000000, maintaining T-bit (bit 24) as 1*/
 	*(--pPSP) = (uint32_t) pTaskHandler; /* PC */
-	*(--pPSP) = EXC_RETURN_THREAD_PSP; /* LR - EXC_RETURN = Return to thread mode and use PSP */
+	*(--pPSP) = TASK_EXIT_ADDRESS; /* LR - A task handler that returns lands in Task_Exit() */
+
+	/* Push zeros for core registers R12, R3-R0 */
+	for(int j = 0 ; j < 5 ; j++)
+	{
+		*(--pPSP) = 0;
+	}
+
+#if defined(__ARM_FP)
+	/* Push the task's EXC_RETURN, restored by PendSV_Handler in a hard-float build */
+	*(--pPSP) = EXC_RETURN_THREAD_PSP;
+#endif
 
-	/* Push zeros for core registers R0-R12*/
-	for(int j = 0 ; j < 13 ; j++)
+	/* Push zeros for core registers R4-R11 */
+	for(int j = 0 ; j < 8 ; j++)
 	{
 		*(--pPSP) = 0;
 	}
+#endif /* SCHED_COOPERATIVE */
 
 	/* Save PSP value */
 	pTask->psp_value = pPSP;
@@ -348,88 +524,120 @@ __attribute__((naked)) void Switch_SP_To_PSP(void)
 }
 
 /**
-  * @brief  Changes the PendSV exception state to pending.
+  * @brief  Changes the PendSV exception state to pending. The context-switch is deferred while the
+  * 		running task holds the scheduler lock. In the cooperative mode, switches out the
+  * 		running task if it blocked or terminated itself.
   * @param  None
   * @retval None
   */
+#if (SCHED_COOPERATIVE == 1)
 void Pend_PendSV(void)
 {
-	/* Define a pointer to ICSR, a System Control Block register */
-	uint32_t *pICSR = (uint32_t*)ICSR; /* ICSR - Interrupt Control and State Register */
+	uint32_t Ipsr;
 
-	/* Change the PendSV exception state to pending */
-	*pICSR |= ( 1 << 28);
+	__asm volatile ("MRS %0,IPSR" : "=r" (Ipsr));
+
+	/* Tasks aren't preempted: a task made ready by an interrupt or by another task runs at the
+	 * next yield. Only a task that blocked or terminated itself is switched out here, with the
+	 * kernel-aware interrupts masked by its caller */
+	if((Ipsr == 0U) && (gpCurrentRunningTask->current_state != TASK_READY_STATE))
+	{
+		Sched_Switch();
+	}
 }
 
 /**
-  * @brief  Puts the current running task in BLOCKED state and initiates a contect-switch (Task Yield).
-  * @param  DelayTickCount - Specifies the duration in terms of SysTick ticks the task should be blocked.
+  * @brief  Cooperative context-switch. Called as a plain function from the task being switched out,
+  * 		so only the registers the callee must preserve are saved on its stack: R4-R11, the
+  * 		return address, and S16-S31 in a hard-float build. R3 is stacked as well, it keeps the
+  * 		stack 8-byte aligned for the calls below. The caller-saved registers, already spilled
+  * 		by the compiler, and the exception frame of the PendSV path aren't.
+  * @note   Must be called in thread mode, with the kernel-aware interrupts masked. The switched in
+  * 		task returns from its own call to Sched_Switch() with the interrupts still masked and
+  * 		restores them, a new task is started by Sched_Task_Start().
+  * @param  None
   * @retval None
   */
-void Task_Delay(uint32_t DelayTickCount)
+__attribute__((naked)) void Sched_Switch(void)
 {
-	/* Disable interrupts */
-	INTERRUPT_DISABLE();
+	/* Save the context of current running task */
 
-	/* Delay is relevant only for LED tasks */
-	if(gpCurrentRunningTask->task_id != IDLE_TASK)
-	{
-		/* Set the task's block count to tick_count ticks from now*/
-		gpCurrentRunningTask->block_count = gTickCount + DelayTickCount;
+	__asm volatile("PUSH {R3-R11,LR}"); /* Store the callee-saved registers and the return address */
 
-		/* Change task state to BLOCKED */
-		gpCurrentRunningTask->current_state = TASK_BLOCKED_STATE;
+#if defined(__ARM_FP)
+	__asm volatile("VPUSH {S16-S31}"); /* Store the callee-saved FPU registers */
+#endif
 
-		/* Insert the blocked task to the blocked queue, and keep it sorted */
-		gBlockedQueue.ENQUEUE(&(gBlockedQueue.head), gpCurrentRunningTask, ENQUEUE_SORTED);
+	__asm volatile("MOV R0,SP");
 
-		/* Pend the PendSV exception and initiate a contect-switch */
-		Pend_PendSV();
-	}
+	__asm volatile("BL Save_PSP_Value"); /* Save the stack pointer in the current task's TCB */
+
+	/* Retrieve the context of the next task */
+
+	__asm volatile("BL Schedule"); /* Decide the next task to run, on the switched out task's stack */
+
+#if (LIBC_REENT == 1)
+	__asm volatile("BL Libc_Switch"); /* Make the new task's C library reentrancy structure current */
+#endif
+
+	__asm volatile("BL Get_PSP_Value"); /* Get the new task's stack pointer */
 
-	/* Enable interrupts */
-	INTERRUPT_ENABLE();
+	__asm volatile("MOV SP,R0");
+
+#if defined(__ARM_FP)
+	__asm volatile("VPOP {S16-S31}");
+#endif
+
+	__asm volatile("POP {R3-R11,PC}"); /* Return into the new task's call to Sched_Switch() */
 }
 
 /**
-  * @brief  Increments the global tick count variable g_tick_count.
+  * @brief  Starts a task in the cooperative mode. The return address of the initial frame built by
+  * 		Task_Init(): unmasks the kernel-aware interrupts, masked by the task that switched, and
+  * 		calls the task's entry point (R4) with Task_Exit() (R5) as its return address.
   * @param  None
   * @retval None
   */
-void Increment_Global_Tick_Count(void)
+__attribute__((naked)) void Sched_Task_Start(void)
 {
-	gTickCount++;
+	__asm volatile("MOV R0,#0");
+
+	__asm volatile("MSR BASEPRI,R0");
+
+	__asm volatile("MOV LR,R5");
+
+	__asm volatile("BX R4");
+}
+#else
+void Pend_PendSV(void)
+{
+	/* Define a pointer to ICSR, a System Control Block register */
+	uint32_t *pICSR = (uint32_t*)ICSR; /* ICSR - Interrupt Control and State Register */
+
+	/* Performed by Sched_Unlock() */
+	if(Sched_Defer_Switch())
+	{
+		return;
+	}
+
+	/* Change the PendSV exception state to pending */
+	*pICSR |= ( 1 << 28);
 }
+#endif /* SCHED_COOPERATIVE */
 
 /**
-  * @brief  Checks the blocked queue and puts qualified tasks in READY state.
+  * @brief  Enables the DWT cycle counter (CYCCNT), used for measuring durations in core clock cycles.
   * @param  None
   * @retval None
   */
-void Unblock_Tasks(void)
+void Cycle_Counter_Init(void)
 {
-	/* It's enough to check the head in each iteration, since the queue is sorted and qualified tasks
-	 * get unblocked immediately */
-	while(gBlockedQueue.head != NULL)
-	{
-		if(gBlockedQueue.head->block_count == gTickCount)
-		{
-
-			/* Dequeue the qualified task */
-			TaskControlBlock_t* temp = gBlockedQueue.DEQUEUE(&(gBlockedQueue.head), REGULAR_DEQUEUE);
-
-			/* Change task state to READY */
-			temp->current_state = TASK_READY_STATE;
-
-			/* Insert the ready task to the ready queue */
-			gReadyQueue.ENQUEUE(&(gReadyQueue.head), temp, ENQUEUE_WITH_REAR_IDLE_TASK);
-		}
-
-		/* Since the queue is sorted, once reaching a head task that's not qualified for unblocking,
-		 * it's sure that all other tasks aren't qualified as well */
-		else
-		{
-			break;
-		}
-	}
+	/* Define pointers to the relevant debug registers */
+	uint32_t *pDEMCR = (uint32_t*)DEMCR;           /* pointer to Debug Exception and Monitor Control Register */
+	uint32_t *pDWT_CTRL = (uint32_t*)DWT_CTRL;     /* pointer to DWT Control Register */
+	uint32_t *pDWT_CYCCNT = (uint32_t*)DWT_CYCCNT; /* pointer to DWT Cycle Count Register */
+
+	*pDEMCR |= ( 1 << 24);  /* TRCENA - enable the DWT unit */
+	*pDWT_CYCCNT = 0;       /* Reset the counter */
+	*pDWT_CTRL |= ( 1 << 0); /* CYCCNTENA - enable the counter */
 }
@@ -0,0 +1,128 @@
+/**
+ ******************************************************************************
+ * @file           : mempool.c
+ * @author         : Noam Yakar
+ * @brief          : This file contains the fixed-block memory pools. Blocks are
+ *                   allocated and released in constant time by a lock-free LIFO
+ *                   free list, safe to use from tasks and ISRs.
+ ******************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------- */
+
+#include "mempool.h"
+
+/* Macros ------------------------------------------------------------------- */
+
+/* Free-list head fields */
+#define MEMPOOL_NIL              0xFFFFU                 /* Index of an empty free list */
+#define MEMPOOL_INDEX_MASK       0x0000FFFFU
+#define MEMPOOL_TAG_INCREMENT    0x00010000U
+
+/* Private functions definitions -------------------------------------------- */
+
+/**
+  * @brief  Returns the address of a block of the pool.
+  * @param  pPool - Pointer to the pool.
+  * @param  Index - Index of the block.
+  * @retval Pointer to the block.
+  */
+static inline uint32_t *MemPool_Block(MemPool_t *pPool, uint32_t Index)
+{
+	return (uint32_t*)(pPool->storage + (Index * pPool->block_size));
+}
+
+/* Functions definitions ---------------------------------------------------- */
+
+/**
+  * @brief  Initializes a pool and links all of its blocks to the free list.
+  * @param  pPool - Pointer to the pool.
+  * @param  pStorage - Pointer to the pool's storage, allocated with MEMPOOL_STORAGE().
+  * @param  BlockSize - Size of a block in bytes.
+  * @param  NumBlocks - Number of blocks, up to MEMPOOL_MAX_BLOCKS.
+  * @retval None
+  */
+void MemPool_Init(MemPool_t *pPool, void *pStorage, uint32_t BlockSize, uint32_t NumBlocks)
+{
+	pPool->storage = (uint8_t*)pStorage;
+	pPool->block_size = MEMPOOL_BLOCK_SIZE((BlockSize != 0U) ? BlockSize : 1U);
+	pPool->num_blocks = (NumBlocks < MEMPOOL_MAX_BLOCKS) ? NumBlocks : MEMPOOL_MAX_BLOCKS;
+	pPool->used = 0;
+	pPool->peak = 0;
+	pPool->failures = 0;
+
+	for(uint32_t i = 0 ; i < pPool->num_blocks ; i++)
+	{
+		*MemPool_Block(pPool, i) = ((i + 1U) < pPool->num_blocks) ? (i + 1U) : MEMPOOL_NIL;
+	}
+	pPool->head = (pPool->num_blocks != 0U) ? 0U : MEMPOOL_NIL;
+}
+
+/**
+  * @brief  Allocates a block from the pool.
+  * @note   Lock-free, may be called from ISRs. A concurrent allocation or release makes the
+  * 		compare-and-swap fail and the loop retry, the tag of the head makes a stale head fail
+  * 		even if the same block was released back in the meantime.
+  * @param  pPool - Pointer to the pool.
+  * @retval Pointer to the block, or NULL if the pool is empty.
+  */
+void *MemPool_Alloc(MemPool_t *pPool)
+{
+	uint32_t Head = __atomic_load_n(&(pPool->head), __ATOMIC_ACQUIRE);
+	uint32_t Index;
+	uint32_t Next;
+	uint32_t Used;
+	uint32_t Peak;
+
+	do
+	{
+		Index = Head & MEMPOOL_INDEX_MASK;
+		if(Index == MEMPOOL_NIL)
+		{
+			__atomic_add_fetch(&(pPool->failures), 1U, __ATOMIC_RELAXED);
+			return NULL;
+		}
+		Next = *MemPool_Block(pPool, Index);
+	} while(!__atomic_compare_exchange_n(&(pPool->head), &Head,
+	                                     ((Head & ~MEMPOOL_INDEX_MASK) + MEMPOOL_TAG_INCREMENT) | Next,
+	                                     0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+	/* Update the statistics */
+	Used = __atomic_add_fetch(&(pPool->used), 1U, __ATOMIC_RELAXED);
+	Peak = __atomic_load_n(&(pPool->peak), __ATOMIC_RELAXED);
+	while((Used > Peak) &&
+	      !__atomic_compare_exchange_n(&(pPool->peak), &Peak, Used, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+	return MemPool_Block(pPool, Index);
+}
+
+/**
+  * @brief  Returns a block to the pool.
+  * @note   Lock-free, may be called from ISRs.
+  * @param  pPool - Pointer to the pool.
+  * @param  pBlock - Pointer to a block allocated from the pool.
+  * @retval MEMPOOL_OK if the block was released, MEMPOOL_INVALID if it isn't a block of the pool.
+  */
+MemPoolStatus_e MemPool_Free(MemPool_t *pPool, void *pBlock)
+{
+	uint32_t Offset = (uint32_t)((uint8_t*)pBlock - pPool->storage);
+	uint32_t Index = Offset / pPool->block_size;
+	uint32_t Head;
+
+	if(((uint8_t*)pBlock < pPool->storage) || (Index >= pPool->num_blocks) || ((Offset % pPool->block_size) != 0U))
+	{
+		return MEMPOOL_INVALID;
+	}
+
+	Head = __atomic_load_n(&(pPool->head), __ATOMIC_RELAXED);
+	do
+	{
+		*MemPool_Block(pPool, Index) = Head & MEMPOOL_INDEX_MASK;
+	} while(!__atomic_compare_exchange_n(&(pPool->head), &Head,
+	                                     ((Head & ~MEMPOOL_INDEX_MASK) + MEMPOOL_TAG_INCREMENT) | Index,
+	                                     0, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+	__atomic_sub_fetch(&(pPool->used), 1U, __ATOMIC_RELAXED);
+
+	return MEMPOOL_OK;
+}
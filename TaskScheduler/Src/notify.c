@@ -0,0 +1,183 @@
+/**
+ ******************************************************************************
+ * @file           : notify.c
+ * @author         : Noam Yakar
+ * @brief          : This file contains function definitions for direct-to-task
+ *                   notifications. Each task has a 32-bit notification value,
+ *                   and a notified task that waits for it is unblocked straight
+ *                   into the ready structure, without an intermediate object.
+ ******************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------- */
+
+#include "notify.h"
+
+/* Global variables --------------------------------------------------------- */
+
+/* Kernel objects, allocated in main.c */
+extern TaskControlBlock_t *gpCurrentRunningTask;
+
+/* Functions definitions ---------------------------------------------------- */
+
+/**
+  * @brief  Sends a notification to a task, updates its notification value and unblocks it if it
+  * 		waits for a notification.
+  * @note   Can be called from ISRs.
+  * @param  pTask - Pointer to the task to be notified.
+  * @param  Value - Value used by the action.
+  * @param  Action - a NotifyAction_e enumerator that specifies how the notification value is updated.
+  * @retval 1 if the value was updated, 0 if NOTIFY_WRITE_IF_TAKEN found a pending notification.
+  */
+uint8_t Task_Notify(TaskControlBlock_t *pTask, uint32_t Value, NotifyAction_e Action)
+{
+	uint32_t PrimaskState;
+	uint8_t Updated = 1;
+	uint8_t PreviousState;
+
+	/* Disable interrupts */
+	INTERRUPT_SAVE_AND_DISABLE(PrimaskState);
+
+	PreviousState = pTask->notify_state;
+
+	switch(Action)
+	{
+		case NOTIFY_SET_BITS:
+			pTask->notify_value |= Value;
+			break;
+
+		case NOTIFY_INCREMENT:
+			pTask->notify_value++;
+			break;
+
+		case NOTIFY_OVERWRITE:
+			pTask->notify_value = Value;
+			break;
+
+		case NOTIFY_WRITE_IF_TAKEN:
+			if(PreviousState != NOTIFY_PENDING)
+			{
+				pTask->notify_value = Value;
+			}
+			else
+			{
+				Updated = 0;
+			}
+			break;
+
+		case NOTIFY_NO_ACTION:
+		default:
+			break;
+	}
+
+	pTask->notify_state = NOTIFY_PENDING;
+
+	/* The task waits for this notification, make it ready */
+	if(PreviousState == NOTIFY_WAITING)
+	{
+		Task_Unblock(pTask);
+	}
+
+	/* Restore interrupts */
+	INTERRUPT_RESTORE(PrimaskState);
+
+	return Updated;
+}
+
+/**
+  * @brief  Increments a task's notification value, the notification value is used as a counting
+  * 		semaphore taken by Task_Notify_Take().
+  * @note   Can be called from ISRs.
+  * @param  pTask - Pointer to the task to be notified.
+  * @retval None
+  */
+void Task_Notify_Give(TaskControlBlock_t *pTask)
+{
+	Task_Notify(pTask, 0, NOTIFY_INCREMENT);
+}
+
+/**
+  * @brief  Waits until the current running task's notification value is non-zero, and then either
+  * 		decrements it or clears it.
+  * @note   Must be called from a task with interrupts enabled.
+  * @param  ClearOnExit - 1 to clear the value (binary semaphore), 0 to decrement it (counting semaphore).
+  * @param  TimeoutTickCount - Maximum duration in terms of SysTick ticks to wait, or TASK_BLOCK_FOREVER.
+  * @retval The notification value before it was decremented or cleared, 0 if the timeout expired.
+  */
+uint32_t Task_Notify_Take(uint8_t ClearOnExit, uint32_t TimeoutTickCount)
+{
+	uint32_t PrimaskState;
+	uint32_t Value;
+	TaskControlBlock_t *pTask = gpCurrentRunningTask;
+
+	/* Disable interrupts */
+	INTERRUPT_SAVE_AND_DISABLE(PrimaskState);
+
+	/* Block until notified. The context-switch takes place once interrupts are restored */
+	if(pTask->notify_value == 0)
+	{
+		pTask->notify_state = NOTIFY_WAITING;
+		Task_Block(TimeoutTickCount);
+		INTERRUPT_RESTORE(PrimaskState);
+		INTERRUPT_SAVE_AND_DISABLE(PrimaskState);
+	}
+
+	Value = pTask->notify_value;
+	if(Value != 0)
+	{
+		pTask->notify_value = ClearOnExit ? 0 : (Value - 1);
+	}
+	pTask->notify_state = NOTIFY_NOT_WAITING;
+
+	/* Restore interrupts */
+	INTERRUPT_RESTORE(PrimaskState);
+
+	return Value;
+}
+
+/**
+  * @brief  Waits until a notification is pending for the current running task and fetches the
+  * 		notification value.
+  * @note   Must be called from a task with interrupts enabled.
+  * @param  ClearBitsOnEntry - Bits cleared in the value before waiting, if no notification is pending.
+  * @param  ClearBitsOnExit - Bits cleared in the value after it is fetched, if a notification was received.
+  * @param  pValue - Pointer the notification value is copied to, can be NULL.
+  * @param  TimeoutTickCount - Maximum duration in terms of SysTick ticks to wait, or TASK_BLOCK_FOREVER.
+  * @retval 1 if a notification was received, 0 if the timeout expired.
+  */
+uint8_t Task_Notify_Wait(uint32_t ClearBitsOnEntry, uint32_t ClearBitsOnExit, uint32_t *pValue, uint32_t TimeoutTickCount)
+{
+	uint32_t PrimaskState;
+	uint8_t Received;
+	TaskControlBlock_t *pTask = gpCurrentRunningTask;
+
+	/* Disable interrupts */
+	INTERRUPT_SAVE_AND_DISABLE(PrimaskState);
+
+	/* Block until notified. The context-switch takes place once interrupts are restored */
+	if(pTask->notify_state != NOTIFY_PENDING)
+	{
+		pTask->notify_value &= ~ClearBitsOnEntry;
+		pTask->notify_state = NOTIFY_WAITING;
+		Task_Block(TimeoutTickCount);
+		INTERRUPT_RESTORE(PrimaskState);
+		INTERRUPT_SAVE_AND_DISABLE(PrimaskState);
+	}
+
+	if(pValue != NULL)
+	{
+		*pValue = pTask->notify_value;
+	}
+
+	Received = (pTask->notify_state == NOTIFY_PENDING);
+	if(Received)
+	{
+		pTask->notify_value &= ~ClearBitsOnExit;
+	}
+	pTask->notify_state = NOTIFY_NOT_WAITING;
+
+	/* Restore interrupts */
+	INTERRUPT_RESTORE(PrimaskState);
+
+	return Received;
+}
@@ -0,0 +1,186 @@
+/**
+ ******************************************************************************
+ * @file           : notify_bench.c
+ * @author         : Noam Yakar
+ * @brief          : This file contains the ISR-to-task wakeup benchmark of task
+ *                   notifications against semaphores. TIM2 fires a one-shot
+ *                   interrupt while the benchmark task is blocked, the ISR
+ *                   stamps DWT CYCCNT and wakes the task, and the task stamps
+ *                   CYCCNT again once it runs.
+ *                   Enabled by NOTIFY_BENCHMARK in task_config.h.
+ ******************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------- */
+
+#include "notify.h"
+#include "semaphore.h"
+#include "idle.h"
+#include "irq.h"
+
+#if (NOTIFY_BENCHMARK == 1)
+
+/* Macros ------------------------------------------------------------------- */
+
+/* RCC APB1 clock enable register */
+#define RCC_APB1ENR              ( (RCC_AHB1_BASE) + 0x40U )
+
+/* TIM2 registers */
+#define TIM2_BASE                0x40000000U
+#define TIM2_CR1                 ( (TIM2_BASE) + 0x00U )
+#define TIM2_DIER                ( (TIM2_BASE) + 0x0CU )
+#define TIM2_SR                  ( (TIM2_BASE) + 0x10U )
+#define TIM2_CNT                 ( (TIM2_BASE) + 0x24U )
+#define TIM2_ARR                 ( (TIM2_BASE) + 0x2CU )
+#define TIM2_IRQ_NUMBER          28U
+
+/* TIM2 one-shot delay, in timer clocks (100us at 16MHz) */
+#define BENCH_TIMER_DELAY        1600U
+
+/* Types -------------------------------------------------------------------- */
+
+/* The primitive the ISR wakes the benchmark task with */
+typedef enum
+{
+	BENCH_NOTIFY,
+	BENCH_SEMAPHORE
+} BenchMode_e;
+
+/* Wakeup latency statistics */
+typedef struct
+{
+	uint32_t min;
+	uint32_t max;
+	uint32_t sum;
+	uint32_t count;
+} BenchStats_t;
+
+/* Global variables --------------------------------------------------------- */
+
+extern TaskControlBlock_t *gpCurrentRunningTask;
+
+static TaskControlBlock_t *pBenchTask = NULL;
+static Semaphore_t gBenchSemaphore;
+static volatile BenchMode_e gBenchMode = BENCH_NOTIFY;
+static volatile uint32_t gBenchIrqCycles = 0;
+
+BenchStats_t gNotifyWakeupStats = {0xFFFFFFFFU, 0, 0, 0};
+BenchStats_t gSemaphoreWakeupStats = {0xFFFFFFFFU, 0, 0, 0};
+
+/* Functions definitions ---------------------------------------------------- */
+
+/**
+  * @brief  Handler for the TIM2 interrupt. Stamps the cycle counter and wakes up the benchmark task.
+  * @param  None
+  * @retval None
+  */
+void TIM2_IRQHandler(void)
+{
+	uint32_t *pTIM2_SR = (uint32_t*)TIM2_SR;
+
+	gBenchIrqCycles = *((volatile uint32_t*)DWT_CYCCNT);
+
+	/* Clear the update interrupt flag */
+	*pTIM2_SR &= ~( 1 << 0);
+
+	if(gBenchMode == BENCH_NOTIFY)
+	{
+		Task_Notify_Give(pBenchTask);
+	}
+	else
+	{
+		Semaphore_Give(&gBenchSemaphore);
+	}
+}
+
+/**
+  * @brief  Starts TIM2 in one-shot mode, its update interrupt fires BENCH_TIMER_DELAY clocks later.
+  * @param  None
+  * @retval None
+  */
+static void Bench_Timer_Start(void)
+{
+	uint32_t *pTIM2_CNT = (uint32_t*)TIM2_CNT;
+	uint32_t *pTIM2_CR1 = (uint32_t*)TIM2_CR1;
+
+	*pTIM2_CNT = 0;
+	*pTIM2_CR1 |= ( 1 << 0); /* CEN - enable the counter, OPM stops it at the update event */
+}
+
+/**
+  * @brief  Adds a wakeup latency sample to the statistics.
+  * @param  pStats - Pointer to the statistics.
+  * @param  Cycles - Latency in core clock cycles.
+  * @retval None
+  */
+static void Bench_Record(BenchStats_t *pStats, uint32_t Cycles)
+{
+	if(Cycles < pStats->min)
+	{
+		pStats->min = Cycles;
+	}
+	if(Cycles > pStats->max)
+	{
+		pStats->max = Cycles;
+	}
+	pStats->sum += Cycles;
+	pStats->count++;
+}
+
+/**
+  * @brief  Handler of the benchmark task. Measures NOTIFY_BENCHMARK_ROUNDS wakeups with each
+  * 		primitive and prints min/avg/max cycles from the TIM2 ISR entry to the task.
+  * @param  None
+  * @retval None
+  */
+void Notify_Benchmark_Task_Handler(void)
+{
+	uint32_t *pRCC_APB1ENR = (uint32_t*)RCC_APB1ENR;
+	uint32_t *pTIM2_CR1 = (uint32_t*)TIM2_CR1;
+	uint32_t *pTIM2_DIER = (uint32_t*)TIM2_DIER;
+	uint32_t *pTIM2_ARR = (uint32_t*)TIM2_ARR;
+	uint32_t Cycles;
+
+	pBenchTask = gpCurrentRunningTask;
+	Semaphore_Init(&gBenchSemaphore, 0);
+	Cycle_Counter_Init();
+
+	/* TIM2 is halted in Stop mode */
+	Idle_Stop_Inhibit();
+
+	/* Configure TIM2 as a one-shot timer with an update interrupt */
+	*pRCC_APB1ENR |= ( 1 << 0);   /* Enable the peripheral clock of TIM2 */
+	*pTIM2_ARR = BENCH_TIMER_DELAY;
+	*pTIM2_CR1 |= ( 1 << 3);      /* OPM - one-pulse mode */
+	*pTIM2_DIER |= ( 1 << 0);     /* UIE - update interrupt enable */
+	Irq_Enable(TIM2_IRQ_NUMBER);
+
+	for(uint32_t i = 0 ; i < NOTIFY_BENCHMARK_ROUNDS ; i++)
+	{
+		/* Notification wakeup */
+		gBenchMode = BENCH_NOTIFY;
+		Bench_Timer_Start();
+		Task_Notify_Take(1, TASK_BLOCK_FOREVER);
+		Cycles = *((volatile uint32_t*)DWT_CYCCNT) - gBenchIrqCycles;
+		Bench_Record(&gNotifyWakeupStats, Cycles);
+
+		/* Semaphore wakeup */
+		gBenchMode = BENCH_SEMAPHORE;
+		Bench_Timer_Start();
+		Semaphore_Take(&gBenchSemaphore, TASK_BLOCK_FOREVER);
+		Cycles = *((volatile uint32_t*)DWT_CYCCNT) - gBenchIrqCycles;
+		Bench_Record(&gSemaphoreWakeupStats, Cycles);
+	}
+
+	printf("Wakeup cycles, notification: min %lu avg %lu max %lu\n", (unsigned long)gNotifyWakeupStats.min,
+	       (unsigned long)(gNotifyWakeupStats.sum / gNotifyWakeupStats.count), (unsigned long)gNotifyWakeupStats.max);
+	printf("Wakeup cycles, semaphore:    min %lu avg %lu max %lu\n", (unsigned long)gSemaphoreWakeupStats.min,
+	       (unsigned long)(gSemaphoreWakeupStats.sum / gSemaphoreWakeupStats.count), (unsigned long)gSemaphoreWakeupStats.max);
+
+	while(1)
+	{
+		Task_Delay(DELAY_1S);
+	}
+}
+
+#endif /* NOTIFY_BENCHMARK */
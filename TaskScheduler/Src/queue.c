@@ -25,12 +25,20 @@
   *                 @arg ENQUEUE_SORTED : The queue is actually a sorted linked list, sorted by the
 	                                      block_count property, and the new task is placed according
 	                                      to its block_count value
+  *                 @arg ENQUEUE_AT_FRONT : Insert at the beginning of the queue.
   * @retval None
   */
 void Enqueue(TaskControlBlock_t **pHead, TaskControlBlock_t *pTask, EnqueueMode_e EnqueueMode)
 {
+	/* Enqueue a task at the front of the queue, it will be the next one to be dequeued */
+	if(EnqueueMode == ENQUEUE_AT_FRONT)
+	{
+		pTask->next = *pHead;
+		*pHead = pTask;
+	}
+
 	/* Enqueue a task while maintaining the idle task at the back */
-	if(EnqueueMode == ENQUEUE_WITH_REAR_IDLE_TASK)
+	else if(EnqueueMode == ENQUEUE_WITH_REAR_IDLE_TASK)
 	{
 		/* The queue is empty, the new task becomes the queue head */
 		if (*pHead == NULL)
@@ -188,3 +196,28 @@ TaskControlBlock_t* Dequeue(TaskControlBlock_t **pHead, DequeueMode_e DequeueMod
 		}
 	}
 }
+
+/**
+  * @brief  Removes a task from the middle of a queue, keeping the order of the other tasks.
+  * @param  pHead - Pointer to a pointer to the first element of the queue.
+  * @param  pTask - Pointer to the task to be removed.
+  * @retval 1 if the task was found and removed, 0 if it isn't in the queue.
+  */
+uint8_t Queue_Remove(TaskControlBlock_t **pHead, TaskControlBlock_t *pTask)
+{
+	TaskControlBlock_t **pLink = pHead;
+
+	/* Follow the links until reaching the one that points to the task */
+	while(*pLink != NULL)
+	{
+		if(*pLink == pTask)
+		{
+			*pLink = pTask->next;
+			pTask->next = NULL;
+			return 1;
+		}
+		pLink = &((*pLink)->next);
+	}
+
+	return 0;
+}
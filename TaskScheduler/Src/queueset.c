@@ -0,0 +1,267 @@
+/**
+ ******************************************************************************
+ * @file           : queueset.c
+ * @author         : Noam Yakar
+ * @brief          : This file contains function definitions of the queue sets.
+ *                   A task registers semaphores and stream buffers in a set and
+ *                   blocks once in QueueSet_Select() until any of them becomes
+ *                   ready, with a timeout kept in the blocked queue like the
+ *                   one of Task_Delay(). A member that gets a token or bytes
+ *                   wakes the tasks waiting on its set, which scan the members
+ *                   again, so readiness is never lost or counted twice.
+ ******************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------- */
+
+#include "queueset.h"
+
+/* Global variables --------------------------------------------------------- */
+
+/* Kernel objects, allocated in main.c */
+extern TaskControlBlock_t *gpCurrentRunningTask;
+extern uint32_t gTickCount;
+
+/* Private functions definitions -------------------------------------------- */
+
+/**
+  * @brief  Finds a ready member, starting from the one after the last member selected.
+  * @note   Must be called with interrupts disabled.
+  * @param  pSet - Pointer to the set.
+  * @retval Pointer to the ready member's handle, NULL if no member is ready.
+  */
+static void* QueueSet_Scan(QueueSet_t *pSet)
+{
+	for(uint32_t i = 0 ; i < pSet->count ; i++)
+	{
+		uint32_t Index = (pSet->next + i) % pSet->count;
+		QueueSetMember_t *pMember = &(pSet->members[Index]);
+		uint8_t Ready;
+
+		if(pMember->type == QUEUESET_SEMAPHORE)
+		{
+			Ready = (((Semaphore_t*)pMember->handle)->count != 0U);
+		}
+		else
+		{
+			Ready = (StreamBuf_Available((StreamBuf_t*)pMember->handle) != 0U);
+		}
+
+		if(Ready)
+		{
+			pSet->next = Index + 1U;
+			return pMember->handle;
+		}
+	}
+
+	return NULL;
+}
+
+/**
+  * @brief  Removes a task from the set's waiters list, if it's still there after a timeout.
+  * @param  pSet - Pointer to the set.
+  * @param  pTask - Pointer to the task.
+  * @retval None
+  */
+static void QueueSet_Remove_Waiter(QueueSet_t *pSet, TaskControlBlock_t *pTask)
+{
+	TaskControlBlock_t **pLink = &(pSet->waiters);
+
+	while(*pLink != NULL)
+	{
+		if(*pLink == pTask)
+		{
+			*pLink = pTask->wait_next;
+			pTask->wait_next = NULL;
+			return;
+		}
+		pLink = &((*pLink)->wait_next);
+	}
+}
+
+/**
+  * @brief  Links a member to its set, or unlinks it.
+  * @param  pMember - Pointer to the member.
+  * @param  pSet - Pointer to the set, NULL to unlink.
+  * @retval None
+  */
+static void QueueSet_Link(QueueSetMember_t *pMember, QueueSet_t *pSet)
+{
+	if(pMember->type == QUEUESET_SEMAPHORE)
+	{
+		((Semaphore_t*)pMember->handle)->set = pSet;
+	}
+	else
+	{
+		((StreamBuf_t*)pMember->handle)->set = pSet;
+	}
+}
+
+/* Functions definitions ---------------------------------------------------- */
+
+/**
+  * @brief  Initializes an empty set.
+  * @param  pSet - Pointer to the set.
+  * @retval None
+  */
+void QueueSet_Init(QueueSet_t *pSet)
+{
+	pSet->count = 0;
+	pSet->next = 0;
+	pSet->waiters = NULL;
+}
+
+/**
+  * @brief  Adds a semaphore or a stream buffer to a set.
+  * @param  pSet - Pointer to the set.
+  * @param  Type - The member's type.
+  * @param  pHandle - Pointer to the Semaphore_t or the StreamBuf_t.
+  * @retval QUEUESET_OK, or QUEUESET_INVALID if the set is full or the object is already a member
+  * 		of a set.
+  */
+uint8_t QueueSet_Add(QueueSet_t *pSet, QueueSetMemberType_e Type, void *pHandle)
+{
+	uint32_t PrimaskState;
+	QueueSet_t *pCurrentSet;
+	uint8_t Status = QUEUESET_INVALID;
+
+	if((pHandle == NULL) || ((Type != QUEUESET_SEMAPHORE) && (Type != QUEUESET_STREAMBUF)))
+	{
+		return QUEUESET_INVALID;
+	}
+
+	/* Disable interrupts, the member may be given to from an ISR */
+	INTERRUPT_SAVE_AND_DISABLE(PrimaskState);
+
+	pCurrentSet = (Type == QUEUESET_SEMAPHORE) ? ((Semaphore_t*)pHandle)->set : ((StreamBuf_t*)pHandle)->set;
+	if((pCurrentSet == NULL) && (pSet->count < QUEUESET_MAX_MEMBERS))
+	{
+		pSet->members[pSet->count].type = (uint8_t)Type;
+		pSet->members[pSet->count].handle = pHandle;
+		QueueSet_Link(&(pSet->members[pSet->count]), pSet);
+		pSet->count++;
+		Status = QUEUESET_OK;
+	}
+
+	/* Restore interrupts */
+	INTERRUPT_RESTORE(PrimaskState);
+
+	return Status;
+}
+
+/**
+  * @brief  Removes a member from a set. Nothing is done if it isn't a member of the set.
+  * @param  pSet - Pointer to the set.
+  * @param  pHandle - Pointer to the member's Semaphore_t or StreamBuf_t.
+  * @retval None
+  */
+void QueueSet_Remove(QueueSet_t *pSet, void *pHandle)
+{
+	uint32_t PrimaskState;
+
+	/* Disable interrupts */
+	INTERRUPT_SAVE_AND_DISABLE(PrimaskState);
+
+	for(uint32_t i = 0 ; i < pSet->count ; i++)
+	{
+		if(pSet->members[i].handle == pHandle)
+		{
+			QueueSet_Link(&(pSet->members[i]), NULL);
+
+			/* Keep the order of the other members */
+			for(uint32_t j = i + 1U ; j < pSet->count ; j++)
+			{
+				pSet->members[j - 1U] = pSet->members[j];
+			}
+			pSet->count--;
+			pSet->next = 0;
+			break;
+		}
+	}
+
+	/* Restore interrupts */
+	INTERRUPT_RESTORE(PrimaskState);
+}
+
+/**
+  * @brief  Waits for a member of a set to become ready, blocking the current running task until a
+  * 		member gets a token or bytes, or the timeout expires. The members are scanned in turn,
+  * 		starting after the last one selected.
+  * @note   Must be called from a task with interrupts enabled. The member selected is ready until
+  * 		the task reads it: Semaphore_Take() or StreamBuf_Receive() return without blocking.
+  * @param  pSet - Pointer to the set.
+  * @param  TimeoutTickCount - Maximum duration in terms of SysTick ticks to wait, or TASK_BLOCK_FOREVER.
+  * @retval Pointer to the ready member's Semaphore_t or StreamBuf_t, NULL if the timeout expired.
+  */
+void* QueueSet_Select(QueueSet_t *pSet, uint32_t TimeoutTickCount)
+{
+	uint32_t PrimaskState;
+	uint32_t StartTick = gTickCount;
+	uint32_t Remaining = TASK_BLOCK_FOREVER;
+	void *pReady;
+
+	while(1)
+	{
+		/* Disable interrupts */
+		INTERRUPT_SAVE_AND_DISABLE(PrimaskState);
+
+		pReady = QueueSet_Scan(pSet);
+		if(pReady != NULL)
+		{
+			break;
+		}
+
+		if(TimeoutTickCount != TASK_BLOCK_FOREVER)
+		{
+			uint32_t Elapsed = gTickCount - StartTick;
+			if(Elapsed >= TimeoutTickCount)
+			{
+				break;
+			}
+			Remaining = TimeoutTickCount - Elapsed;
+		}
+
+		/* Join the waiters list and block. The context-switch takes place once interrupts are restored */
+		gpCurrentRunningTask->wait_next = pSet->waiters;
+		pSet->waiters = gpCurrentRunningTask;
+		Task_Block(Remaining);
+		INTERRUPT_RESTORE(PrimaskState);
+
+		/* A task that is still in the list was woken up by the timeout */
+		INTERRUPT_SAVE_AND_DISABLE(PrimaskState);
+		QueueSet_Remove_Waiter(pSet, gpCurrentRunningTask);
+		INTERRUPT_RESTORE(PrimaskState);
+	}
+
+	/* Restore interrupts */
+	INTERRUPT_RESTORE(PrimaskState);
+
+	return pReady;
+}
+
+/**
+  * @brief  Wakes up the tasks waiting on a set, they scan its members again. Called by a member
+  * 		that became ready.
+  * @note   Can be called from ISRs.
+  * @param  pSet - Pointer to the set.
+  * @retval None
+  */
+void QueueSet_Post(QueueSet_t *pSet)
+{
+	uint32_t PrimaskState;
+	TaskControlBlock_t *pWaiter;
+
+	/* Disable interrupts */
+	INTERRUPT_SAVE_AND_DISABLE(PrimaskState);
+
+	while(pSet->waiters != NULL)
+	{
+		pWaiter = pSet->waiters;
+		pSet->waiters = pWaiter->wait_next;
+		pWaiter->wait_next = NULL;
+		Task_Unblock(pWaiter);
+	}
+
+	/* Restore interrupts */
+	INTERRUPT_RESTORE(PrimaskState);
+}
@@ -0,0 +1,150 @@
+/**
+ ******************************************************************************
+ * @file           : record.c
+ * @author         : Noam Yakar
+ * @brief          : This file contains function definitions for the recorder of
+ *                   the scheduler's nondeterministic inputs: the delays, blocks,
+ *                   wakeups, budget throttles and exits of the tasks, and the
+ *                   calls to Schedule(), each stamped with the tick count. The
+ *                   entries are written to a circular log in RAM, dumped from
+ *                   the target and replayed by Tools/sched_replay.
+ ******************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------- */
+
+#include "record.h"
+#include "sched.h"
+
+#if (RECORD_ENABLE == 1)
+
+/* Macros ------------------------------------------------------------------- */
+
+/* Number of entries of a checkpoint */
+#define RECORD_CHECKPOINT_ENTRIES  ( 1U + (3U * (NUMBER_OF_STATIC_TASKS)) )
+
+_Static_assert((RECORD_SIZE & RECORD_MASK) == 0U, "RECORD_SIZE must be a power of 2");
+_Static_assert(RECORD_CHECKPOINT_ENTRIES < RECORD_HALF, "RECORD_SIZE is too small for a checkpoint");
+_Static_assert(NUMBER_OF_STATIC_TASKS < RECORD_NO_POSITION, "Too many tasks for the checkpoint positions");
+
+/* Global variables --------------------------------------------------------- */
+
+/* Kernel objects, allocated in main.c */
+extern TaskControlBlock_t gTaskTable[NUMBER_OF_STATIC_TASKS];
+extern TaskControlBlock_t *gpCurrentRunningTask;
+extern Queue_t gBlockedQueue;
+extern uint32_t gTickCount;
+
+/* The circular log */
+RecordLog_t gRecordLog = {RECORD_MAGIC, RECORD_SIZE, 0, {{0}}};
+
+/* Functions definitions ---------------------------------------------------- */
+
+/**
+  * @brief  Writes an entry to the log.
+  * @param  Type - Specifies the entry's type.
+  * @param  TaskId - Specifies the task the entry refers to.
+  * @param  Aux - Type specific.
+  * @param  Arg - Type specific.
+  * @retval None
+  */
+static void Record_Write(RecordType_e Type, uint8_t TaskId, uint16_t Aux, uint32_t Arg)
+{
+	RecordEntry_t *pEntry = &(gRecordLog.entries[gRecordLog.head & RECORD_MASK]);
+
+	pEntry->tick = gTickCount;
+	pEntry->type = (uint8_t)Type;
+	pEntry->task_id = TaskId;
+	pEntry->aux = Aux;
+	pEntry->arg = Arg;
+	gRecordLog.head++;
+}
+
+/**
+  * @brief  Logs the scheduler's state of the static tasks: the running task, the order of the ready
+  * 		structure and of the blocked queue, and the tasks' states and deadlines.
+  * @param  None
+  * @retval None
+  */
+static void Record_Checkpoint(void)
+{
+	TaskControlBlock_t *pReady[SCHED_MAX_TASKS];
+	uint8_t ReadyPosition[NUMBER_OF_STATIC_TASKS];
+	uint8_t BlockedPosition[NUMBER_OF_STATIC_TASKS];
+	TaskControlBlock_t *pTask;
+	uint32_t Count;
+	uint32_t Position;
+
+	for(uint32_t i = 0 ; i < NUMBER_OF_STATIC_TASKS ; i++)
+	{
+		ReadyPosition[i] = RECORD_NO_POSITION;
+		BlockedPosition[i] = RECORD_NO_POSITION;
+	}
+
+	/* Positions in the ready structure and in the blocked queue. Dynamic tasks take a position
+	 * but aren't logged */
+	Count = Sched_Ready_Tasks(pReady, SCHED_MAX_TASKS);
+	for(uint32_t i = 0 ; i < Count ; i++)
+	{
+		if(pReady[i]->task_id < NUMBER_OF_STATIC_TASKS)
+		{
+			ReadyPosition[pReady[i]->task_id] = (uint8_t)i;
+		}
+	}
+	Position = 0;
+	for(pTask = gBlockedQueue.head ; pTask != NULL ; pTask = pTask->next)
+	{
+		if((pTask->task_id < NUMBER_OF_STATIC_TASKS) && (Position < RECORD_NO_POSITION))
+		{
+			BlockedPosition[pTask->task_id] = (uint8_t)Position;
+		}
+		Position++;
+	}
+
+	Record_Write(RECORD_CHECKPOINT, (gpCurrentRunningTask != NULL) ? gpCurrentRunningTask->task_id : RECORD_NO_TASK,
+	             (uint16_t)gpSchedPolicy->policy_type, NUMBER_OF_STATIC_TASKS);
+
+	for(uint32_t i = 0 ; i < NUMBER_OF_STATIC_TASKS ; i++)
+	{
+		pTask = &gTaskTable[i];
+		Record_Write(RECORD_CHECKPOINT_TASK, (uint8_t)i, (uint16_t)(ReadyPosition[i] | (BlockedPosition[i] << 8)), pTask->block_count);
+		Record_Write(RECORD_CHECKPOINT_STATE, (uint8_t)i, (uint16_t)pTask->current_state, pTask->relative_deadline);
+		Record_Write(RECORD_CHECKPOINT_DEADLINE, (uint8_t)i, pTask->job_done, pTask->absolute_deadline);
+	}
+}
+
+/**
+  * @brief  Logs an event. Logs a checkpoint first when the event starts a half of the log.
+  * @note   Called through RECORD(), before the event changes the scheduler's state. Can be called
+  * 		from ISRs.
+  * @param  Type - Specifies the event's type.
+  * @param  TaskId - Specifies the task the event refers to.
+  * @param  Aux - Type specific. The active exception number is logged for RECORD_WAKEUP.
+  * @param  Arg - Type specific.
+  * @retval None
+  */
+void Record_Event(RecordType_e Type, uint8_t TaskId, uint16_t Aux, uint32_t Arg)
+{
+	uint32_t PrimaskState;
+	uint32_t Ipsr;
+
+	if(Type == RECORD_WAKEUP)
+	{
+		__asm volatile ("MRS %0,IPSR" : "=r" (Ipsr));
+		Aux = (uint16_t)(Ipsr & 0x1FFU);
+	}
+
+	/* Disable interrupts */
+	INTERRUPT_SAVE_AND_DISABLE(PrimaskState);
+
+	if((gRecordLog.head & (RECORD_HALF - 1U)) == 0U)
+	{
+		Record_Checkpoint();
+	}
+	Record_Write(Type, TaskId, Aux, Arg);
+
+	/* Restore interrupts */
+	INTERRUPT_RESTORE(PrimaskState);
+}
+
+#endif /* RECORD_ENABLE */
@@ -0,0 +1,653 @@
+/**
+ ******************************************************************************
+ * @file           : sched.c
+ * @author         : Noam Yakar
+ * @brief          : This file contains function definitions of the scheduling
+ *                   policies. Schedule() dispatches to the selected policy:
+ *                   round-robin over the ready queue, or earliest deadline
+ *                   first over a deadline heap. It also contains the task state
+ *                   transitions of the tick, delays, blocking and wakeups, so
+ *                   the host tools can run the scheduler core as is.
+ ******************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------- */
+
+#include "sched.h"
+#include "record.h"
+
+/* Private functions prototypes --------------------------------------------- */
+
+static void RoundRobin_Init(void);
+static void RoundRobin_Ready(TaskControlBlock_t *pTask, EnqueueMode_e EnqueueMode);
+static void RoundRobin_Schedule(void);
+static void Edf_Init(void);
+static void Edf_Ready(TaskControlBlock_t *pTask, EnqueueMode_e EnqueueMode);
+static void Edf_Schedule(void);
+
+/* Global variables --------------------------------------------------------- */
+
+/* Kernel objects, allocated in main.c */
+extern Queue_t gReadyQueue;
+extern Queue_t gBlockedQueue;
+extern TaskControlBlock_t *gpCurrentRunningTask;
+extern uint32_t gTickCount;
+
+/* Scheduling policies */
+SchedPolicy_t gRoundRobinPolicy = {SCHED_POLICY_ROUND_ROBIN, RoundRobin_Init, RoundRobin_Ready, RoundRobin_Schedule};
+SchedPolicy_t gEdfPolicy = {SCHED_POLICY_EDF, Edf_Init, Edf_Ready, Edf_Schedule};
+
+/* The selected scheduling policy */
+_Static_assert((SCHED_POLICY == SCHED_POLICY_ROUND_ROBIN) || (SCHED_POLICY == SCHED_POLICY_EDF),
+               "SCHED_POLICY must be SCHED_POLICY_ROUND_ROBIN or SCHED_POLICY_EDF");
+#if (SCHED_POLICY == SCHED_POLICY_EDF)
+SchedPolicy_t *gpSchedPolicy = &gEdfPolicy;
+#else
+SchedPolicy_t *gpSchedPolicy = &gRoundRobinPolicy;
+#endif
+
+/* EDF deadline heap. A binary min-heap of the ready tasks, ordered by absolute deadline */
+static TaskControlBlock_t *gEdfHeap[SCHED_MAX_TASKS];
+static uint32_t gEdfHeapSize = 0;
+
+/* The idle task is kept out of the EDF heap and runs only when the heap is empty */
+static TaskControlBlock_t *pEdfIdleTask = NULL;
+
+/* A context-switch was requested while the running task held the scheduler lock */
+static volatile uint8_t gSchedSwitchPending = 0;
+
+/* Functions definitions ---------------------------------------------------- */
+
+/**
+  * @brief  Updates the variable current_running_task according to the selected scheduling policy.
+  * @param  None
+  * @retval None
+  */
+void Schedule(void)
+{
+	/* A ready task holding the scheduler lock keeps running, the switch is made by Sched_Unlock() */
+	if(Sched_Is_Locked())
+	{
+		gSchedSwitchPending = 1;
+		return;
+	}
+
+	RECORD(RECORD_SCHEDULE, (gpCurrentRunningTask != NULL) ? gpCurrentRunningTask->task_id : RECORD_NO_TASK, 0, 0);
+
+	gpSchedPolicy->SCHEDULE();
+}
+
+/**
+  * @brief  Locks the scheduler: the running task isn't switched out until the matching
+  * 		Sched_Unlock(), while interrupts keep running. Calls nest.
+  * @note   The lock belongs to the task. If the task blocks, or is throttled by its CPU budget,
+  * 		while holding it, other tasks run normally and the lock is held again once the task
+  * 		resumes.
+  * @param  None
+  * @retval None
+  */
+void Sched_Lock(void)
+{
+	gpCurrentRunningTask->sched_lock++;
+}
+
+/**
+  * @brief  Releases one level of the scheduler lock. When the last level is released, a
+  * 		context-switch requested while the lock was held is performed.
+  * @param  None
+  * @retval None
+  */
+void Sched_Unlock(void)
+{
+	gpCurrentRunningTask->sched_lock--;
+
+	/* An ISR that runs after the count reached 0 pends the PendSV itself */
+	if((gpCurrentRunningTask->sched_lock == 0U) && __atomic_exchange_n(&gSchedSwitchPending, 0U, __ATOMIC_RELAXED))
+	{
+		Pend_PendSV();
+	}
+}
+
+/**
+  * @brief  Tells whether the running task holds the scheduler lock and is still ready.
+  * @param  None
+  * @retval 1 if the running task must not be switched out, 0 otherwise.
+  */
+uint8_t Sched_Is_Locked(void)
+{
+	return (gpCurrentRunningTask != NULL) && (gpCurrentRunningTask->sched_lock != 0U) &&
+	       (gpCurrentRunningTask->current_state == TASK_READY_STATE);
+}
+
+/**
+  * @brief  Called before a context-switch is requested. Defers it if the running task holds
+  * 		the scheduler lock.
+  * @param  None
+  * @retval 1 if the context-switch was deferred to Sched_Unlock(), 0 if it may proceed.
+  */
+uint8_t Sched_Defer_Switch(void)
+{
+	if(Sched_Is_Locked())
+	{
+		gSchedSwitchPending = 1;
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+  * @brief  Lists the tasks of the ready structure of the selected scheduling policy, in the order
+  * 		they are kept: the ready queue from its head, or the deadline heap's array followed by
+  * 		the idle task. Inserting them to an empty ready structure in that order rebuilds it as is.
+  * @note   Must be called with interrupts disabled or from handler mode.
+  * @param  pTasks - Pointer to the array the tasks are written to.
+  * @param  MaxTasks - Size of the array.
+  * @retval Number of tasks written.
+  */
+uint32_t Sched_Ready_Tasks(TaskControlBlock_t **pTasks, uint32_t MaxTasks)
+{
+	uint32_t Count = 0;
+
+	if(gpSchedPolicy->policy_type == SCHED_POLICY_EDF)
+	{
+		for(uint32_t i = 0 ; (i < gEdfHeapSize) && (Count < MaxTasks) ; i++)
+		{
+			pTasks[Count++] = gEdfHeap[i];
+		}
+		if((pEdfIdleTask != NULL) && (Count < MaxTasks))
+		{
+			pTasks[Count++] = pEdfIdleTask;
+		}
+	}
+	else
+	{
+		for(TaskControlBlock_t *pTask = gReadyQueue.head ; (pTask != NULL) && (Count < MaxTasks) ; pTask = pTask->next)
+		{
+			pTasks[Count++] = pTask;
+		}
+	}
+
+	return Count;
+}
+
+/**
+  * @brief  Tells whether a task other than the idle task is ready to run.
+  * @note   Must be called with interrupts disabled or from handler mode.
+  * @param  None
+  * @retval 1 if a task is ready, 0 if only the idle task is.
+  */
+uint8_t Sched_Task_Ready(void)
+{
+	TaskControlBlock_t *pNext;
+
+	return (Sched_Ready_Tasks(&pNext, 1) != 0U) && (pNext->task_id != IDLE_TASK);
+}
+
+/**
+  * @brief  Sets the relative deadline of a task and starts its current job now. The deadline of
+  * 		each job of the task is RelativeDeadline ticks after the job's release.
+  * @param  pTask - Pointer to the task.
+  * @param  RelativeDeadline - Relative deadline in ticks, or SCHED_NO_DEADLINE.
+  * @retval None
+  */
+void Sched_Set_Deadline(TaskControlBlock_t *pTask, uint32_t RelativeDeadline)
+{
+	pTask->relative_deadline = RelativeDeadline;
+	pTask->absolute_deadline = gTickCount + ((RelativeDeadline == SCHED_NO_DEADLINE) ? SCHED_FAR_DEADLINE : RelativeDeadline);
+}
+
+/**
+  * @brief  Releases a new job of a task that completed its previous one: its absolute deadline is
+  * 		RelativeDeadline ticks from now. A task woken in the middle of a job keeps the job's
+  * 		deadline.
+  * @param  pTask - Pointer to the task that became ready.
+  * @retval None
+  */
+static void Sched_Release_Job(TaskControlBlock_t *pTask)
+{
+	if(pTask->job_done)
+	{
+		pTask->job_done = 0;
+		Sched_Set_Deadline(pTask, pTask->relative_deadline);
+	}
+}
+
+/**
+  * @brief  Inserts a task that became ready to the ready structure of the selected scheduling
+  * 		policy, releasing a new job if its previous one completed.
+  * @note   Must be called with interrupts disabled or from handler mode.
+  * @param  pTask - Pointer to the task that became ready.
+  * @param  EnqueueMode - Hint for queue based policies, see @ref EnqueueMode_e.
+  * @retval None
+  */
+void Sched_Ready(TaskControlBlock_t *pTask, EnqueueMode_e EnqueueMode)
+{
+	Sched_Release_Job(pTask);
+	gpSchedPolicy->READY(pTask, EnqueueMode);
+}
+
+/**
+  * @brief  Marks the end of the current job of a task and counts a deadline miss if it completed
+  * 		after its absolute deadline. The task's next wakeup releases a new job. Called by
+  * 		Task_Delay() and Task_Exit(), and by an event driven task before it blocks waiting for
+  * 		its next event.
+  * @param  pTask - Pointer to the task whose job completed.
+  * @retval None
+  */
+void Sched_Job_Complete(TaskControlBlock_t *pTask)
+{
+	pTask->job_done = 1;
+
+	if(pTask->relative_deadline != SCHED_NO_DEADLINE)
+	{
+		/* Tick count wrap-around safe comparison */
+		if((int32_t)(gTickCount - pTask->absolute_deadline) > 0)
+		{
+			pTask->deadline_misses++;
+		}
+	}
+}
+
+/**
+  * @brief  Puts the current running task in BLOCKED state and initiates a contect-switch (Task Yield).
+  * @param  DelayTickCount - Specifies the duration in terms of SysTick ticks the task should be blocked.
+  * @retval None
+  */
+void Task_Delay(uint32_t DelayTickCount)
+{
+	/* Disable interrupts */
+	INTERRUPT_DISABLE();
+
+	/* Delay is relevant only for LED tasks */
+	if(gpCurrentRunningTask->task_id != IDLE_TASK)
+	{
+		RECORD(RECORD_DELAY, gpCurrentRunningTask->task_id, 0, DelayTickCount);
+
+		/* Set the task's block count to tick_count ticks from now*/
+		gpCurrentRunningTask->block_count = gTickCount + DelayTickCount;
+
+		/* Change task state to BLOCKED */
+		gpCurrentRunningTask->current_state = TASK_BLOCKED_STATE;
+
+		/* The task's current job is done */
+		Sched_Job_Complete(gpCurrentRunningTask);
+
+		/* Insert the blocked task to the blocked queue, and keep it sorted */
+		gBlockedQueue.ENQUEUE(&(gBlockedQueue.head), gpCurrentRunningTask, ENQUEUE_SORTED);
+
+		/* Pend the PendSV exception and initiate a contect-switch */
+		Pend_PendSV();
+	}
+
+	/* Enable interrupts */
+	INTERRUPT_ENABLE();
+}
+
+/**
+  * @brief  Switches out the current running task, which stays ready. With the round-robin policy
+  * 		it moves to the back of the ready queue, with EDF it's switched out only for a task
+  * 		with an earlier deadline.
+  * @note   In the cooperative mode this is where the tasks made ready by the tick, the interrupts
+  * 		and the other tasks get to run.
+  * @param  None
+  * @retval None
+  */
+void Task_Yield(void)
+{
+#if (SCHED_COOPERATIVE == 1)
+	uint32_t BasepriState;
+
+	/* Sched_Switch() runs with the kernel-aware interrupts masked, the task restores them once
+	 * it's switched back in */
+	INTERRUPT_SAVE_AND_DISABLE(BasepriState);
+	Sched_Switch();
+	INTERRUPT_RESTORE(BasepriState);
+#else
+	/* Pend the PendSV exception and initiate a contect-switch. The barriers make sure it's taken
+	 * before the function returns */
+	Pend_PendSV();
+#if defined(__arm__)
+	__asm volatile ("DSB" : : : "memory");
+	__asm volatile ("ISB" : : : "memory");
+#endif
+#endif
+}
+
+/**
+  * @brief  Increments the global tick count variable g_tick_count.
+  * @param  None
+  * @retval None
+  */
+void Increment_Global_Tick_Count(void)
+{
+	gTickCount++;
+}
+
+/**
+  * @brief  Checks the blocked queue and puts qualified tasks in READY state. Both delayed tasks and
+  * 		tasks throttled by their CPU budget are kept in the blocked queue.
+  * @param  None
+  * @retval None
+  */
+void Unblock_Tasks(void)
+{
+	/* It's enough to check the head in each iteration, since the queue is sorted and qualified tasks
+	 * get unblocked immediately */
+	while(gBlockedQueue.head != NULL)
+	{
+		if(gBlockedQueue.head->block_count == gTickCount)
+		{
+
+			/* Dequeue the qualified task */
+			TaskControlBlock_t* temp = gBlockedQueue.DEQUEUE(&(gBlockedQueue.head), REGULAR_DEQUEUE);
+
+			/* Change task state to READY */
+			temp->current_state = TASK_READY_STATE;
+
+			/* Insert the ready task to the ready structure of the scheduling policy */
+			Sched_Ready(temp, ENQUEUE_WITH_REAR_IDLE_TASK);
+		}
+
+		/* Since the queue is sorted, once reaching a head task that's not qualified for unblocking,
+		 * it's sure that all other tasks aren't qualified as well */
+		else
+		{
+			break;
+		}
+	}
+}
+
+/**
+  * @brief  Puts the current running task in BLOCKED state and initiates a context-switch. The task
+  * 		stays blocked until Task_Unblock() is called for it, or until the timeout expires. The
+  * 		task's current job goes on after the wakeup, unless the task completed it with
+  * 		Sched_Job_Complete() before blocking.
+  * @note   Must be called with interrupts disabled, so the condition the task waits for can be
+  * 		checked atomically with the state change. The context-switch takes place once
+  * 		interrupts are enabled again.
+  * @param  TimeoutTickCount - Specifies the maximum duration in terms of SysTick ticks the task
+  * 		should be blocked, or TASK_BLOCK_FOREVER. A task with a timeout is inserted to the
+  * 		blocked queue, like a delayed task.
+  * @retval None
+  */
+void Task_Block(uint32_t TimeoutTickCount)
+{
+	/* The idle task is never blocked */
+	if(gpCurrentRunningTask->task_id != IDLE_TASK)
+	{
+		RECORD(RECORD_BLOCK, gpCurrentRunningTask->task_id, gpCurrentRunningTask->job_done, TimeoutTickCount);
+
+		/* Change task state to BLOCKED */
+		gpCurrentRunningTask->current_state = TASK_BLOCKED_STATE;
+
+		/* Insert the blocked task to the blocked queue, Unblock_Tasks() wakes it up on timeout */
+		if(TimeoutTickCount != TASK_BLOCK_FOREVER)
+		{
+			gpCurrentRunningTask->block_count = gTickCount + TimeoutTickCount;
+			gBlockedQueue.ENQUEUE(&(gBlockedQueue.head), gpCurrentRunningTask, ENQUEUE_SORTED);
+		}
+
+		/* Pend the PendSV exception and initiate a contect-switch */
+		Pend_PendSV();
+	}
+}
+
+/**
+  * @brief  Puts a task that was blocked by Task_Block() or Task_Delay() in READY state, cancelling
+  * 		its timeout. With the round-robin policy the task is inserted at the front of the ready
+  * 		queue, so it is the next one to be scheduled.
+  * @note   Can be called from ISRs.
+  * @param  pTask - Pointer to the task to be unblocked.
+  * @retval None
+  */
+void Task_Unblock(TaskControlBlock_t *pTask)
+{
+	uint32_t PrimaskState;
+
+	/* Disable interrupts */
+	INTERRUPT_SAVE_AND_DISABLE(PrimaskState);
+
+	if(pTask->current_state == TASK_BLOCKED_STATE)
+	{
+		RECORD(RECORD_WAKEUP, pTask->task_id, 0, 0);
+
+		/* Change task state to READY */
+		pTask->current_state = TASK_READY_STATE;
+
+		/* Cancel the task's timeout */
+		Queue_Remove(&(gBlockedQueue.head), pTask);
+
+		/* A task that blocked itself but wasn't switched out yet is still the current running task,
+		 * so Schedule() handles it as a ready task and it must not be inserted to the ready structure */
+		if(pTask != gpCurrentRunningTask)
+		{
+			Sched_Ready(pTask, ENQUEUE_AT_FRONT);
+		}
+		else
+		{
+			Sched_Release_Job(pTask);
+		}
+
+		/* Pend the PendSV exception and initiate a contect-switch */
+		Pend_PendSV();
+	}
+
+	/* Restore interrupts */
+	INTERRUPT_RESTORE(PrimaskState);
+}
+
+/**
+  * @brief  The ready queue is the ready structure of this policy, nothing to build.
+  * @param  None
+  * @retval None
+  */
+static void RoundRobin_Init(void)
+{
+}
+
+/**
+  * @brief  Inserts a ready task to the ready queue.
+  * @param  pTask - Pointer to the task that became ready.
+  * @param  EnqueueMode - The method in which the task is inserted to the ready queue.
+  * @retval None
+  */
+static void RoundRobin_Ready(TaskControlBlock_t *pTask, EnqueueMode_e EnqueueMode)
+{
+	gReadyQueue.ENQUEUE(&(gReadyQueue.head), pTask, EnqueueMode);
+}
+
+/**
+  * @brief  Round-robin policy. Switches to the task at the head of the ready queue and moves the
+  * 		scheduled out task to the back of the queue, before the idle task.
+  * @param  None
+  * @retval None
+  */
+static void RoundRobin_Schedule(void)
+{
+	TaskControlBlock_t* pScheduledOutTask = NULL;
+
+	/* Only in the beginning there's no running task */
+	if(gpCurrentRunningTask == NULL)
+	{
+		gpCurrentRunningTask = gReadyQueue.DEQUEUE(&(gReadyQueue.head), DEQUEUE_WITH_REAR_IDLE_TASK);
+	}
+
+	/* The next task to be scheduled is not the idle task */
+	else if(gReadyQueue.head->task_id != IDLE_TASK)
+	{
+		/* Save the scheduled out task and update the current running task */
+		pScheduledOutTask = gpCurrentRunningTask;
+		gpCurrentRunningTask = gReadyQueue.DEQUEUE(&(gReadyQueue.head), DEQUEUE_WITH_REAR_IDLE_TASK);
+
+		/* Enqueue the scheduled out task to the ready queue if its not idle and its ready*/
+		if(pScheduledOutTask->task_id != IDLE_TASK)
+		{
+			if(pScheduledOutTask->current_state == TASK_READY_STATE)
+			{
+				gReadyQueue.ENQUEUE(&(gReadyQueue.head), pScheduledOutTask, ENQUEUE_WITH_REAR_IDLE_TASK);
+			}
+		}
+	}
+
+	/* The next task to be scheduled is the idle task */
+	else
+	{
+		/* Schedule the idle task if no other option is available. A running task that's
+		 * in ready state will stay scheduled. */
+		if(gpCurrentRunningTask->task_id != IDLE_TASK)
+		{
+			if(gpCurrentRunningTask->current_state != TASK_READY_STATE)
+			{
+				pScheduledOutTask = gpCurrentRunningTask;
+				gpCurrentRunningTask = gReadyQueue.head; /* Schedule idle task */
+			}
+		}
+	}
+}
+
+/**
+  * @brief  Checks whether task A's absolute deadline is earlier than task B's.
+  * @param  pTaskA - Pointer to task A.
+  * @param  pTaskB - Pointer to task B.
+  * @retval 1 if task A's deadline is earlier, 0 otherwise.
+  */
+static inline uint8_t Edf_Earlier(TaskControlBlock_t *pTaskA, TaskControlBlock_t *pTaskB)
+{
+	/* Tick count wrap-around safe comparison */
+	return ((int32_t)(pTaskA->absolute_deadline - pTaskB->absolute_deadline) < 0);
+}
+
+/**
+  * @brief  Inserts a task to the deadline heap. O(log n).
+  * @param  pTask - Pointer to the task.
+  * @retval None
+  */
+static void Edf_Heap_Push(TaskControlBlock_t *pTask)
+{
+	uint32_t Index;
+	uint32_t Parent;
+
+	/* The heap can't overflow, Task_Create() keeps the number of tasks within SCHED_MAX_TASKS */
+
+	/* Sift up from the new leaf */
+	Index = gEdfHeapSize++;
+	while(Index > 0)
+	{
+		Parent = (Index - 1) / 2;
+		if(!Edf_Earlier(pTask, gEdfHeap[Parent]))
+		{
+			break;
+		}
+		gEdfHeap[Index] = gEdfHeap[Parent];
+		Index = Parent;
+	}
+	gEdfHeap[Index] = pTask;
+}
+
+/**
+  * @brief  Removes the task with the earliest deadline from the deadline heap. O(log n).
+  * @param  None
+  * @retval Pointer to the removed task, NULL if the heap is empty.
+  */
+static TaskControlBlock_t* Edf_Heap_Pop(void)
+{
+	TaskControlBlock_t *pTop;
+	TaskControlBlock_t *pLast;
+	uint32_t Index = 0;
+	uint32_t Child;
+
+	if(gEdfHeapSize == 0)
+	{
+		return NULL;
+	}
+
+	pTop = gEdfHeap[0];
+	pLast = gEdfHeap[--gEdfHeapSize];
+
+	/* Sift the last leaf down from the root */
+	while((Child = (2 * Index) + 1) < gEdfHeapSize)
+	{
+		if(((Child + 1) < gEdfHeapSize) && Edf_Earlier(gEdfHeap[Child + 1], gEdfHeap[Child]))
+		{
+			Child++;
+		}
+		if(!Edf_Earlier(gEdfHeap[Child], pLast))
+		{
+			break;
+		}
+		gEdfHeap[Index] = gEdfHeap[Child];
+		Index = Child;
+	}
+	gEdfHeap[Index] = pLast;
+
+	return pTop;
+}
+
+/**
+  * @brief  Builds the deadline heap from the tasks in the ready queue.
+  * @param  None
+  * @retval None
+  */
+static void Edf_Init(void)
+{
+	gEdfHeapSize = 0;
+	pEdfIdleTask = NULL;
+
+	while(gReadyQueue.head != NULL)
+	{
+		Edf_Ready(gReadyQueue.DEQUEUE(&(gReadyQueue.head), REGULAR_DEQUEUE), REGULAR_ENQUEUE);
+	}
+}
+
+/**
+  * @brief  Inserts a ready task to the deadline heap. The idle task is kept aside.
+  * @param  pTask - Pointer to the task that became ready.
+  * @param  EnqueueMode - Not used by this policy.
+  * @retval None
+  */
+static void Edf_Ready(TaskControlBlock_t *pTask, EnqueueMode_e EnqueueMode)
+{
+	(void)EnqueueMode;
+
+	if(pTask->task_id == IDLE_TASK)
+	{
+		pEdfIdleTask = pTask;
+	}
+	else
+	{
+		Edf_Heap_Push(pTask);
+	}
+}
+
+/**
+  * @brief  Earliest deadline first policy. Runs the ready task with the earliest absolute deadline.
+  * 		A ready running task is preempted only by a task with a strictly earlier deadline.
+  * @param  None
+  * @retval None
+  */
+static void Edf_Schedule(void)
+{
+	TaskControlBlock_t *pScheduledOutTask = gpCurrentRunningTask;
+
+	/* The running task is still ready, it competes with the earliest task in the heap */
+	if((pScheduledOutTask != NULL) && (pScheduledOutTask->task_id != IDLE_TASK) &&
+	   (pScheduledOutTask->current_state == TASK_READY_STATE))
+	{
+		if((gEdfHeapSize != 0) && Edf_Earlier(gEdfHeap[0], pScheduledOutTask))
+		{
+			gpCurrentRunningTask = Edf_Heap_Pop();
+			Edf_Heap_Push(pScheduledOutTask);
+		}
+	}
+
+	/* The running task blocked or it's the idle task, run the earliest task or the idle task */
+	else
+	{
+		gpCurrentRunningTask = Edf_Heap_Pop();
+		if(gpCurrentRunningTask == NULL)
+		{
+			gpCurrentRunningTask = pEdfIdleTask;
+		}
+	}
+}
@@ -0,0 +1,146 @@
+/**
+ ******************************************************************************
+ * @file           : semaphore.c
+ * @author         : Noam Yakar
+ * @brief          : This file contains function definitions for counting
+ *                   semaphores.
+ ******************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------- */
+
+#include "semaphore.h"
+#include "queueset.h"
+
+/* Global variables --------------------------------------------------------- */
+
+/* Kernel objects, allocated in main.c */
+extern TaskControlBlock_t *gpCurrentRunningTask;
+
+/* Functions definitions ---------------------------------------------------- */
+
+/**
+  * @brief  Removes a task from the semaphore's waiters list.
+  * @param  pSem - Pointer to the semaphore.
+  * @param  pTask - Pointer to the task.
+  * @retval 1 if the task was found and removed, 0 if it doesn't wait for the semaphore.
+  */
+static uint8_t Semaphore_Remove_Waiter(Semaphore_t *pSem, TaskControlBlock_t *pTask)
+{
+	TaskControlBlock_t **pLink = &(pSem->waiters);
+
+	while(*pLink != NULL)
+	{
+		if(*pLink == pTask)
+		{
+			*pLink = pTask->wait_next;
+			pTask->wait_next = NULL;
+			return 1;
+		}
+		pLink = &((*pLink)->wait_next);
+	}
+
+	return 0;
+}
+
+/**
+  * @brief  Initializes a semaphore.
+  * @param  pSem - Pointer to the semaphore.
+  * @param  InitialCount - Number of available tokens.
+  * @retval None
+  */
+void Semaphore_Init(Semaphore_t *pSem, uint32_t InitialCount)
+{
+	pSem->count = InitialCount;
+	pSem->waiters = NULL;
+	pSem->set = NULL;
+}
+
+/**
+  * @brief  Gives a token. If tasks wait for the semaphore, the token is handed directly to the first
+  * 		waiting task, which is unblocked. Otherwise the token makes the semaphore's queue set
+  * 		ready.
+  * @note   Can be called from ISRs.
+  * @param  pSem - Pointer to the semaphore.
+  * @retval None
+  */
+void Semaphore_Give(Semaphore_t *pSem)
+{
+	uint32_t PrimaskState;
+	TaskControlBlock_t *pWaiter;
+
+	/* Disable interrupts */
+	INTERRUPT_SAVE_AND_DISABLE(PrimaskState);
+
+	pWaiter = pSem->waiters;
+	if(pWaiter != NULL)
+	{
+		pSem->waiters = pWaiter->wait_next;
+		pWaiter->wait_next = NULL;
+		Task_Unblock(pWaiter);
+	}
+	else
+	{
+		pSem->count++;
+
+		/* Wake up the task waiting on the semaphore's set */
+		if(pSem->set != NULL)
+		{
+			QueueSet_Post(pSem->set);
+		}
+	}
+
+	/* Restore interrupts */
+	INTERRUPT_RESTORE(PrimaskState);
+}
+
+/**
+  * @brief  Takes a token, blocking the current running task until a token is given or the timeout
+  * 		expires.
+  * @note   Must be called from a task with interrupts enabled.
+  * @param  pSem - Pointer to the semaphore.
+  * @param  TimeoutTickCount - Maximum duration in terms of SysTick ticks to wait, or TASK_BLOCK_FOREVER.
+  * @retval SEMAPHORE_OK if a token was taken, SEMAPHORE_TIMEOUT otherwise.
+  */
+SemaphoreStatus_e Semaphore_Take(Semaphore_t *pSem, uint32_t TimeoutTickCount)
+{
+	uint32_t PrimaskState;
+	SemaphoreStatus_e Status = SEMAPHORE_OK;
+	TaskControlBlock_t **pLink;
+
+	/* Disable interrupts */
+	INTERRUPT_SAVE_AND_DISABLE(PrimaskState);
+
+	if(pSem->count != 0)
+	{
+		pSem->count--;
+	}
+	else
+	{
+		/* Join the end of the waiters list and block. The context-switch takes place once interrupts
+		 * are restored */
+		pLink = &(pSem->waiters);
+		while(*pLink != NULL)
+		{
+			pLink = &((*pLink)->wait_next);
+		}
+		*pLink = gpCurrentRunningTask;
+		gpCurrentRunningTask->wait_next = NULL;
+
+		Task_Block(TimeoutTickCount);
+		INTERRUPT_RESTORE(PrimaskState);
+
+		/* Semaphore_Give() removes the task it hands a token to from the waiters list, a task that
+		 * is still in the list was woken up by the timeout */
+		INTERRUPT_SAVE_AND_DISABLE(PrimaskState);
+		if(Semaphore_Remove_Waiter(pSem, gpCurrentRunningTask))
+		{
+			Status = SEMAPHORE_TIMEOUT;
+		}
+	}
+
+	/* Restore interrupts */
+	INTERRUPT_RESTORE(PrimaskState);
+
+	return Status;
+}
@@ -0,0 +1,97 @@
+/**
+ ******************************************************************************
+ * @file           : snapshot.c
+ * @author         : Noam Yakar
+ * @brief          : This file contains function definitions for the seqlock-
+ *                   protected shared snapshots. The writer bumps the sequence
+ *                   number before it updates each of the two copies of the
+ *                   data, the readers pick the copy the writer isn't updating
+ *                   and retry if the sequence number changed during the copy.
+ *                   Neither side disables interrupts or waits for the other.
+ ******************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------- */
+
+#include <string.h>
+#include "snapshot.h"
+
+/* Functions definitions ---------------------------------------------------- */
+
+/**
+  * @brief  Initializes a snapshot.
+  * @param  pSnap - Pointer to the snapshot.
+  * @param  pStorage - Pointer to the storage of the two copies, allocated with SNAPSHOT_STORAGE().
+  * @param  Size - Size of the data in bytes.
+  * @param  pInitial - Pointer to the initial data, or NULL to start with zeros.
+  * @retval None
+  */
+void Snapshot_Init(Snapshot_t *pSnap, void *pStorage, uint32_t Size, const void *pInitial)
+{
+	pSnap->sequence = 0;
+	pSnap->size = Size;
+	pSnap->data[0] = (uint8_t*)pStorage;
+	pSnap->data[1] = (uint8_t*)pStorage + (((Size + 3U) / 4U) * 4U);
+
+	if(pInitial != NULL)
+	{
+		memcpy(pSnap->data[0], pInitial, Size);
+		memcpy(pSnap->data[1], pInitial, Size);
+	}
+	else
+	{
+		memset(pSnap->data[0], 0, Size);
+		memset(pSnap->data[1], 0, Size);
+	}
+}
+
+/**
+  * @brief  Publishes new data. Never waits.
+  * @note   A snapshot has a single writer. Writes from several contexts must be serialized by the
+  * 		caller.
+  * @param  pSnap - Pointer to the snapshot.
+  * @param  pData - Pointer to the new data, of the snapshot's size.
+  * @retval None
+  */
+void Snapshot_Write(Snapshot_t *pSnap, const void *pData)
+{
+	/* Odd sequence number: the readers move to copy 1 while copy 0 is updated. The fences order
+	 * the previous update before the sequence number, and the sequence number before the update */
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	pSnap->sequence++;
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	memcpy(pSnap->data[0], pData, pSnap->size);
+
+	/* Even sequence number: the readers move back to copy 0 while copy 1 is updated */
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	pSnap->sequence++;
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	memcpy(pSnap->data[1], pData, pSnap->size);
+}
+
+/**
+  * @brief  Copies the latest consistent data. Retries while the writer publishes meanwhile.
+  * @note   Can be called from tasks and from ISRs, including ISRs that preempt the writer.
+  * @param  pSnap - Pointer to the snapshot.
+  * @param  pData - Pointer to the destination buffer, of the snapshot's size.
+  * @retval Number of retries.
+  */
+uint32_t Snapshot_Read(Snapshot_t *pSnap, void *pData)
+{
+	uint32_t Sequence;
+	uint32_t Retries = 0;
+
+	while(1)
+	{
+		Sequence = __atomic_load_n(&(pSnap->sequence), __ATOMIC_ACQUIRE);
+		memcpy(pData, pSnap->data[Sequence & 1U], pSnap->size);
+
+		/* Order the copy before the sequence number check */
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		if(pSnap->sequence == Sequence)
+		{
+			return Retries;
+		}
+		Retries++;
+	}
+}
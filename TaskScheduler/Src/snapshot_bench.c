@@ -0,0 +1,217 @@
+/**
+ ******************************************************************************
+ * @file           : snapshot_bench.c
+ * @author         : Noam Yakar
+ * @brief          : This file contains the cycle-cost benchmark of the snapshots
+ *                   against critical sections. TIM4 fires a 10KHz interrupt that
+ *                   publishes a sensor state both ways, and the benchmark task
+ *                   reads it both ways, measuring each read and each write with
+ *                   DWT CYCCNT.
+ *                   Enabled by SNAPSHOT_BENCHMARK in task_config.h.
+ ******************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------- */
+
+#include <string.h>
+#include "snapshot.h"
+#include "idle.h"
+#include "irq.h"
+
+#if (SNAPSHOT_BENCHMARK == 1)
+
+/* Macros ------------------------------------------------------------------- */
+
+/* RCC APB1 clock enable register */
+#define RCC_APB1ENR              ( (RCC_AHB1_BASE) + 0x40U )
+
+/* TIM4 registers */
+#define TIM4_BASE                0x40000800U
+#define TIM4_CR1                 ( (TIM4_BASE) + 0x00U )
+#define TIM4_DIER                ( (TIM4_BASE) + 0x0CU )
+#define TIM4_SR                  ( (TIM4_BASE) + 0x10U )
+#define TIM4_PSC                 ( (TIM4_BASE) + 0x28U )
+#define TIM4_ARR                 ( (TIM4_BASE) + 0x2CU )
+#define TIM4_IRQ_NUMBER          30U
+
+/* TIM4 period, in timer clocks (100us at 16MHz) */
+#define BENCH_TIMER_PERIOD       1600U
+
+/* Words of the sensor state */
+#define BENCH_STATE_WORDS        16U
+
+/* Types -------------------------------------------------------------------- */
+
+/* The sensor state published by the ISR */
+typedef struct
+{
+	uint32_t words[BENCH_STATE_WORDS];
+} BenchState_t;
+
+/* Cycle statistics */
+typedef struct
+{
+	uint32_t min;
+	uint32_t max;
+	uint32_t sum;
+	uint32_t count;
+} BenchStats_t;
+
+/* Global variables --------------------------------------------------------- */
+
+SNAPSHOT_STORAGE(gBenchSnapshotStorage, sizeof(BenchState_t));
+static Snapshot_t gBenchSnapshot;
+static BenchState_t gBenchLockedState;
+static uint32_t gBenchSequence = 0;
+static uint32_t gBenchRetries = 0;
+
+BenchStats_t gSnapshotReadStats = {0xFFFFFFFFU, 0, 0, 0};
+BenchStats_t gLockedReadStats = {0xFFFFFFFFU, 0, 0, 0};
+BenchStats_t gSnapshotWriteStats = {0xFFFFFFFFU, 0, 0, 0};
+BenchStats_t gLockedWriteStats = {0xFFFFFFFFU, 0, 0, 0};
+
+/* Functions definitions ---------------------------------------------------- */
+
+/**
+  * @brief  Adds a sample to the statistics.
+  * @param  pStats - Pointer to the statistics.
+  * @param  Cycles - Duration in core clock cycles.
+  * @retval None
+  */
+static void Bench_Record(BenchStats_t *pStats, uint32_t Cycles)
+{
+	if(Cycles < pStats->min)
+	{
+		pStats->min = Cycles;
+	}
+	if(Cycles > pStats->max)
+	{
+		pStats->max = Cycles;
+	}
+	pStats->sum += Cycles;
+	pStats->count++;
+}
+
+/**
+  * @brief  Prints min/avg/max cycles of a statistics.
+  * @param  pName - The statistics' name.
+  * @param  pStats - Pointer to the statistics.
+  * @retval None
+  */
+static void Bench_Print(const char *pName, const BenchStats_t *pStats)
+{
+	printf("%s min %lu avg %lu max %lu\n", pName, (unsigned long)pStats->min,
+	       (unsigned long)(pStats->sum / pStats->count), (unsigned long)pStats->max);
+}
+
+/**
+  * @brief  Handler for the TIM4 interrupt. Publishes a new sensor state to the snapshot and to the
+  * 		critical-section protected copy, measuring both writes.
+  * @param  None
+  * @retval None
+  */
+void TIM4_IRQHandler(void)
+{
+	uint32_t *pTIM4_SR = (uint32_t*)TIM4_SR;
+	volatile uint32_t *pCYCCNT = (volatile uint32_t*)DWT_CYCCNT;
+	BenchState_t State;
+	uint32_t PrimaskState;
+	uint32_t Start;
+
+	/* Clear the update interrupt flag */
+	*pTIM4_SR &= ~( 1 << 0);
+
+	gBenchSequence++;
+	for(uint32_t i = 0 ; i < BENCH_STATE_WORDS ; i++)
+	{
+		State.words[i] = gBenchSequence;
+	}
+
+	Start = *pCYCCNT;
+	Snapshot_Write(&gBenchSnapshot, &State);
+	Bench_Record(&gSnapshotWriteStats, *pCYCCNT - Start);
+
+	/* A kernel-aware ISR of higher priority may read the copy too */
+	Start = *pCYCCNT;
+	INTERRUPT_SAVE_AND_DISABLE(PrimaskState);
+	gBenchLockedState = State;
+	INTERRUPT_RESTORE(PrimaskState);
+	Bench_Record(&gLockedWriteStats, *pCYCCNT - Start);
+}
+
+/**
+  * @brief  Handler of the benchmark task. Reads the sensor state SNAPSHOT_BENCHMARK_ROUNDS times
+  * 		with each method, checks every copy and prints min/avg/max cycles of the reads and of
+  * 		the ISR's writes.
+  * @param  None
+  * @retval None
+  */
+void Snapshot_Benchmark_Task_Handler(void)
+{
+	uint32_t *pRCC_APB1ENR = (uint32_t*)RCC_APB1ENR;
+	uint32_t *pTIM4_CR1 = (uint32_t*)TIM4_CR1;
+	uint32_t *pTIM4_DIER = (uint32_t*)TIM4_DIER;
+	uint32_t *pTIM4_PSC = (uint32_t*)TIM4_PSC;
+	uint32_t *pTIM4_ARR = (uint32_t*)TIM4_ARR;
+	volatile uint32_t *pCYCCNT = (volatile uint32_t*)DWT_CYCCNT;
+	BenchState_t State;
+	uint32_t PrimaskState;
+	uint32_t Start;
+	uint32_t Torn = 0;
+
+	Snapshot_Init(&gBenchSnapshot, gBenchSnapshotStorage, sizeof(BenchState_t), NULL);
+	Cycle_Counter_Init();
+
+	/* TIM4 is halted in Stop mode */
+	Idle_Stop_Inhibit();
+
+	/* Configure TIM4 as a periodic timer with an update interrupt */
+	*pRCC_APB1ENR |= ( 1 << 2);   /* Enable the peripheral clock of TIM4 */
+	*pTIM4_PSC = 0;
+	*pTIM4_ARR = BENCH_TIMER_PERIOD - 1U;
+	*pTIM4_DIER |= ( 1 << 0);     /* UIE - update interrupt enable */
+	Irq_Enable(TIM4_IRQ_NUMBER);
+	*pTIM4_CR1 |= ( 1 << 0);      /* CEN - enable the counter */
+
+	for(uint32_t i = 0 ; i < SNAPSHOT_BENCHMARK_ROUNDS ; i++)
+	{
+		/* Snapshot read */
+		Start = *pCYCCNT;
+		gBenchRetries += Snapshot_Read(&gBenchSnapshot, &State);
+		Bench_Record(&gSnapshotReadStats, *pCYCCNT - Start);
+		if(State.words[0] != State.words[BENCH_STATE_WORDS - 1U])
+		{
+			Torn++;
+		}
+
+		/* Critical section read */
+		Start = *pCYCCNT;
+		INTERRUPT_SAVE_AND_DISABLE(PrimaskState);
+		State = gBenchLockedState;
+		INTERRUPT_RESTORE(PrimaskState);
+		Bench_Record(&gLockedReadStats, *pCYCCNT - Start);
+		if(State.words[0] != State.words[BENCH_STATE_WORDS - 1U])
+		{
+			Torn++;
+		}
+
+		/* Spread the reads over the TIM4 period */
+		for(volatile uint32_t Spin = 0 ; Spin < (i % 64U) ; Spin++);
+	}
+
+	*pTIM4_CR1 &= ~( 1 << 0);
+	Irq_Disable(TIM4_IRQ_NUMBER);
+
+	Bench_Print("Read cycles, snapshot:          ", &gSnapshotReadStats);
+	Bench_Print("Read cycles, critical section:  ", &gLockedReadStats);
+	Bench_Print("Write cycles, snapshot:         ", &gSnapshotWriteStats);
+	Bench_Print("Write cycles, critical section: ", &gLockedWriteStats);
+	printf("Snapshot retries %lu, torn reads %lu\n", (unsigned long)gBenchRetries, (unsigned long)Torn);
+
+	while(1)
+	{
+		Task_Delay(DELAY_1S);
+	}
+}
+
+#endif /* SNAPSHOT_BENCHMARK */
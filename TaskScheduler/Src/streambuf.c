@@ -0,0 +1,353 @@
+/**
+ ******************************************************************************
+ * @file           : streambuf.c
+ * @author         : Noam Yakar
+ * @brief          : This file contains function definitions of the byte stream
+ *                   buffers. The buffer is a ring indexed by free-running
+ *                   head/tail counters, so a producer and a consumer that run
+ *                   concurrently (a task and an ISR or a DMA stream) need no
+ *                   lock. Tasks on the same side are serialized with the
+ *                   scheduler lock, and wait for data or space in the waiters
+ *                   lists of the buffer, like semaphores.
+ ******************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------- */
+
+#include <string.h>
+#include "streambuf.h"
+#include "sched.h"
+#include "queueset.h"
+
+/* Global variables --------------------------------------------------------- */
+
+/* Kernel objects, allocated in main.c */
+extern TaskControlBlock_t *gpCurrentRunningTask;
+extern uint32_t gTickCount;
+
+/* Functions definitions ---------------------------------------------------- */
+
+/**
+  * @brief  Unblocks all the tasks of a waiters list, they check the buffer again.
+  * @note   Can be called from ISRs.
+  * @param  pList - Pointer to the head of the waiters list.
+  * @retval None
+  */
+static void StreamBuf_Wake_All(TaskControlBlock_t **pList)
+{
+	uint32_t PrimaskState;
+	TaskControlBlock_t *pWaiter;
+
+	/* Disable interrupts */
+	INTERRUPT_SAVE_AND_DISABLE(PrimaskState);
+
+	while(*pList != NULL)
+	{
+		pWaiter = *pList;
+		*pList = pWaiter->wait_next;
+		pWaiter->wait_next = NULL;
+		Task_Unblock(pWaiter);
+	}
+
+	/* Restore interrupts */
+	INTERRUPT_RESTORE(PrimaskState);
+}
+
+/**
+  * @brief  Removes a task from a waiters list, if it's still there after a timeout.
+  * @param  pList - Pointer to the head of the waiters list.
+  * @param  pTask - Pointer to the task.
+  * @retval None
+  */
+static void StreamBuf_Remove_Waiter(TaskControlBlock_t **pList, TaskControlBlock_t *pTask)
+{
+	while(*pList != NULL)
+	{
+		if(*pList == pTask)
+		{
+			*pList = pTask->wait_next;
+			pTask->wait_next = NULL;
+			return;
+		}
+		pList = &((*pList)->wait_next);
+	}
+}
+
+/**
+  * @brief  Blocks the current running task until the other side of the buffer makes progress, or
+  * 		until the timeout that started at StartTick expires.
+  * @param  pSb - Pointer to the stream buffer.
+  * @param  ForSpace - 1 to wait for space, 0 to wait for data.
+  * @param  StartTick - Tick count when the operation started.
+  * @param  TimeoutTickCount - Timeout of the operation, or TASK_BLOCK_FOREVER.
+  * @retval 1 if the buffer should be checked again, 0 if the timeout expired.
+  */
+static uint8_t StreamBuf_Wait(StreamBuf_t *pSb, uint8_t ForSpace, uint32_t StartTick, uint32_t TimeoutTickCount)
+{
+	uint32_t PrimaskState;
+	uint32_t Remaining = TASK_BLOCK_FOREVER;
+	TaskControlBlock_t **pList = ForSpace ? &(pSb->writers) : &(pSb->readers);
+
+	if(TimeoutTickCount != TASK_BLOCK_FOREVER)
+	{
+		uint32_t Elapsed = gTickCount - StartTick;
+		if(Elapsed >= TimeoutTickCount)
+		{
+			return 0;
+		}
+		Remaining = TimeoutTickCount - Elapsed;
+	}
+
+	/* Disable interrupts */
+	INTERRUPT_SAVE_AND_DISABLE(PrimaskState);
+
+	/* The other side may have made progress since the buffer was checked */
+	if((ForSpace ? StreamBuf_Space(pSb) : StreamBuf_Available(pSb)) != 0U)
+	{
+		INTERRUPT_RESTORE(PrimaskState);
+		return 1;
+	}
+
+	/* Join the waiters list and block. The context-switch takes place once interrupts are restored */
+	gpCurrentRunningTask->wait_next = *pList;
+	*pList = gpCurrentRunningTask;
+	Task_Block(Remaining);
+	INTERRUPT_RESTORE(PrimaskState);
+
+	/* A task that is still in the list was woken up by the timeout */
+	INTERRUPT_SAVE_AND_DISABLE(PrimaskState);
+	StreamBuf_Remove_Waiter(pList, gpCurrentRunningTask);
+	INTERRUPT_RESTORE(PrimaskState);
+
+	return 1;
+}
+
+/**
+  * @brief  Copies bytes into the free space of the buffer and publishes them.
+  * @param  pSb - Pointer to the stream buffer.
+  * @param  pData - Pointer to the bytes.
+  * @param  Length - Number of bytes.
+  * @retval Number of bytes copied, limited by the free space.
+  */
+static uint32_t StreamBuf_Write_Bytes(StreamBuf_t *pSb, const uint8_t *pData, uint32_t Length)
+{
+	uint32_t Head = pSb->head;
+	uint32_t Space = pSb->size - (Head - __atomic_load_n(&(pSb->tail), __ATOMIC_ACQUIRE));
+	uint32_t Offset = Head & (pSb->size - 1U);
+	uint32_t First;
+
+	if(Length > Space)
+	{
+		Length = Space;
+	}
+
+	First = ((pSb->size - Offset) < Length) ? (pSb->size - Offset) : Length;
+	memcpy(&(pSb->buffer[Offset]), pData, First);
+	memcpy(pSb->buffer, &pData[First], Length - First);
+
+	/* The bytes are visible to the consumer before the new head */
+	__atomic_store_n(&(pSb->head), Head + Length, __ATOMIC_RELEASE);
+
+	return Length;
+}
+
+/**
+  * @brief  Initializes a stream buffer.
+  * @param  pSb - Pointer to the stream buffer.
+  * @param  pStorage - Pointer to the storage.
+  * @param  Size - Size of the storage in bytes, a power of 2.
+  * @param  SendHook - Called after bytes were written to the buffer, NULL for a task consumer.
+  * @retval STREAMBUF_OK, or STREAMBUF_INVALID if the size isn't a power of 2.
+  */
+uint8_t StreamBuf_Init(StreamBuf_t *pSb, uint8_t *pStorage, uint32_t Size, StreamBufHook_t SendHook)
+{
+	if((pStorage == NULL) || (Size == 0U) || ((Size & (Size - 1U)) != 0U))
+	{
+		return STREAMBUF_INVALID;
+	}
+
+	pSb->buffer = pStorage;
+	pSb->size = Size;
+	pSb->head = 0;
+	pSb->tail = 0;
+	pSb->readers = NULL;
+	pSb->writers = NULL;
+	pSb->send_hook = SendHook;
+	pSb->dropped = 0;
+	pSb->set = NULL;
+
+	return STREAMBUF_OK;
+}
+
+/**
+  * @brief  Writes bytes to a stream buffer, blocking the current running task while the buffer is
+  * 		full until all the bytes are written or the timeout expires.
+  * @note   Must be called from a task. A write that blocks may be interleaved with the writes of
+  * 		other tasks.
+  * @param  pSb - Pointer to the stream buffer.
+  * @param  pData - Pointer to the bytes.
+  * @param  Length - Number of bytes.
+  * @param  TimeoutTickCount - Maximum duration in terms of SysTick ticks to wait, or TASK_BLOCK_FOREVER.
+  * @retval Number of bytes written, less than Length if the timeout expired.
+  */
+uint32_t StreamBuf_Send(StreamBuf_t *pSb, const void *pData, uint32_t Length, uint32_t TimeoutTickCount)
+{
+	const uint8_t *pBytes = pData;
+	uint32_t StartTick = gTickCount;
+	uint32_t Sent = 0;
+	uint32_t Written;
+
+	/* One writing task at a time, interrupts keep running */
+	Sched_Lock();
+
+	while(1)
+	{
+		Written = StreamBuf_Write_Bytes(pSb, &pBytes[Sent], Length - Sent);
+		Sent += Written;
+
+		if(Written != 0U)
+		{
+			if(pSb->send_hook != NULL)
+			{
+				pSb->send_hook(pSb);
+			}
+			StreamBuf_Wake_All(&(pSb->readers));
+			if(pSb->set != NULL)
+			{
+				QueueSet_Post(pSb->set);
+			}
+		}
+
+		if((Sent == Length) || !StreamBuf_Wait(pSb, 1, StartTick, TimeoutTickCount))
+		{
+			break;
+		}
+	}
+
+	Sched_Unlock();
+
+	return Sent;
+}
+
+/**
+  * @brief  Reads bytes from a stream buffer, blocking the current running task while the buffer is
+  * 		empty until some bytes arrive or the timeout expires.
+  * @note   Must be called from a task.
+  * @param  pSb - Pointer to the stream buffer.
+  * @param  pData - Pointer to the destination.
+  * @param  Length - Maximum number of bytes to read.
+  * @param  TimeoutTickCount - Maximum duration in terms of SysTick ticks to wait, or TASK_BLOCK_FOREVER.
+  * @retval Number of bytes read, 0 if the timeout expired.
+  */
+uint32_t StreamBuf_Receive(StreamBuf_t *pSb, void *pData, uint32_t Length, uint32_t TimeoutTickCount)
+{
+	uint8_t *pBytes = pData;
+	uint32_t StartTick = gTickCount;
+	uint32_t Received = 0;
+	uint32_t Chunk;
+	uint8_t *pChunk;
+
+	/* One reading task at a time, interrupts keep running */
+	Sched_Lock();
+
+	while((StreamBuf_Available(pSb) == 0U) && StreamBuf_Wait(pSb, 0, StartTick, TimeoutTickCount));
+
+	/* At most two chunks, before and after the end of the storage */
+	while((Received < Length) && ((Chunk = StreamBuf_Read_Pointer(pSb, &pChunk)) != 0U))
+	{
+		if(Chunk > (Length - Received))
+		{
+			Chunk = Length - Received;
+		}
+		memcpy(&pBytes[Received], pChunk, Chunk);
+		StreamBuf_Consume(pSb, Chunk);
+		Received += Chunk;
+	}
+
+	Sched_Unlock();
+
+	return Received;
+}
+
+/**
+  * @brief  Writes bytes to a stream buffer without blocking. Bytes that don't fit are dropped.
+  * @note   Can be called from ISRs.
+  * @param  pSb - Pointer to the stream buffer.
+  * @param  pData - Pointer to the bytes.
+  * @param  Length - Number of bytes.
+  * @retval Number of bytes written.
+  */
+uint32_t StreamBuf_Send_From_Isr(StreamBuf_t *pSb, const void *pData, uint32_t Length)
+{
+	uint32_t Written = StreamBuf_Write_Bytes(pSb, pData, Length);
+
+	pSb->dropped += Length - Written;
+
+	if(Written != 0U)
+	{
+		if(pSb->send_hook != NULL)
+		{
+			pSb->send_hook(pSb);
+		}
+		StreamBuf_Wake_All(&(pSb->readers));
+		if(pSb->set != NULL)
+		{
+			QueueSet_Post(pSb->set);
+		}
+	}
+
+	return Written;
+}
+
+/**
+  * @brief  Gets the contiguous readable bytes at the tail of a stream buffer, without consuming
+  * 		them. Used to read the buffer in place, by a DMA stream for instance.
+  * @param  pSb - Pointer to the stream buffer.
+  * @param  ppData - Receives the pointer to the first readable byte.
+  * @retval Number of contiguous readable bytes.
+  */
+uint32_t StreamBuf_Read_Pointer(StreamBuf_t *pSb, uint8_t **ppData)
+{
+	uint32_t Tail = pSb->tail;
+	uint32_t Available = __atomic_load_n(&(pSb->head), __ATOMIC_ACQUIRE) - Tail;
+	uint32_t Offset = Tail & (pSb->size - 1U);
+
+	*ppData = &(pSb->buffer[Offset]);
+
+	return ((pSb->size - Offset) < Available) ? (pSb->size - Offset) : Available;
+}
+
+/**
+  * @brief  Releases bytes read in place, and wakes up the tasks waiting for space.
+  * @note   Can be called from ISRs.
+  * @param  pSb - Pointer to the stream buffer.
+  * @param  Length - Number of bytes, not more than returned by StreamBuf_Read_Pointer().
+  * @retval None
+  */
+void StreamBuf_Consume(StreamBuf_t *pSb, uint32_t Length)
+{
+	/* The bytes are read before their space is released to the producer */
+	__atomic_store_n(&(pSb->tail), pSb->tail + Length, __ATOMIC_RELEASE);
+
+	StreamBuf_Wake_All(&(pSb->writers));
+}
+
+/**
+  * @brief  Gets the number of bytes that can be read from a stream buffer.
+  * @param  pSb - Pointer to the stream buffer.
+  * @retval Number of bytes.
+  */
+uint32_t StreamBuf_Available(const StreamBuf_t *pSb)
+{
+	return pSb->head - pSb->tail;
+}
+
+/**
+  * @brief  Gets the number of bytes that can be written to a stream buffer.
+  * @param  pSb - Pointer to the stream buffer.
+  * @retval Number of bytes.
+  */
+uint32_t StreamBuf_Space(const StreamBuf_t *pSb)
+{
+	return pSb->size - (pSb->head - pSb->tail);
+}
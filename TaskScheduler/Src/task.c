@@ -0,0 +1,243 @@
+/**
+ ******************************************************************************
+ * @file           : task.c
+ * @author         : Noam Yakar
+ * @brief          : This file contains function definitions of the tasks
+ *                   lifecycle. A task terminates by calling Task_Exit() or by
+ *                   returning from its handler, whose return address is
+ *                   Task_Exit(). The TCB and the stack of a task created at
+ *                   runtime can't be released by the task itself, it still
+ *                   runs on them, so terminated tasks are reclaimed by the
+ *                   idle task.
+ ******************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------- */
+
+#include <stdlib.h>
+#include "task.h"
+#include "sched.h"
+#include "record.h"
+#include "libc.h"
+
+/* Macros ------------------------------------------------------------------- */
+
+/* The stack follows the TCB in the block allocated by Task_Create(), 8-byte aligned */
+#define TASK_TCB_SIZE            ((sizeof(TaskControlBlock_t) + 7U) & ~7U)
+
+/* Global variables --------------------------------------------------------- */
+
+/* Kernel objects, allocated in main.c */
+extern TaskControlBlock_t *gpCurrentRunningTask;
+
+/* Terminated tasks waiting to be released by the idle task, linked by their next field */
+static TaskControlBlock_t *gpReclaimList = NULL;
+
+/* Tasks created by Task_Create() that didn't terminate yet. With the static tasks they never
+ * exceed SCHED_MAX_TASKS, the capacity of the scheduler's ready structures */
+static uint32_t gDynamicTaskCount = 0;
+
+_Static_assert(NUMBER_OF_STATIC_TASKS <= SCHED_MAX_TASKS, "The static tasks exceed SCHED_MAX_TASKS");
+
+/* Functions definitions ---------------------------------------------------- */
+
+/**
+  * @brief  Hands a terminated task over to the idle task, if its memory was allocated by
+  * 		Task_Create(). Must be called with interrupts disabled.
+  * @param  pTask - Pointer to the terminated task.
+  * @retval None
+  */
+static void Task_Release(TaskControlBlock_t *pTask)
+{
+	if(pTask->flags & TASK_FLAG_DYNAMIC)
+	{
+		pTask->next = gpReclaimList;
+		gpReclaimList = pTask;
+	}
+}
+
+/**
+  * @brief  Creates a task at runtime. The TCB and the stack are allocated from the heap in a
+  * 		single block, and the task is inserted to the ready structure of the scheduling policy.
+  * @note   Must be called from a task, after the scheduler started.
+  * @param  pTaskHandler - Pointer to the task handler function. The task terminates when it
+  * 		returns.
+  * @param  StackSize - Stack size in bytes, a multiple of 8 not smaller than TASK_MIN_STACK_SIZE.
+  * @param  RelativeDeadline - Deadline of each job of the task in ticks, or SCHED_NO_DEADLINE.
+  * @param  Flags - TASK_JOINABLE or TASK_DETACHED.
+  * @retval Pointer to the new task, NULL if the arguments are invalid, SCHED_MAX_TASKS tasks
+  * 		exist already or the heap is exhausted.
+  */
+TaskControlBlock_t *Task_Create(void (*pTaskHandler)(void), uint32_t StackSize, uint32_t RelativeDeadline, uint8_t Flags)
+{
+	TaskControlBlock_t *pTask;
+	uint32_t PrimaskState;
+
+	if((pTaskHandler == NULL) || (StackSize < TASK_MIN_STACK_SIZE) || ((StackSize % 8U) != 0U) ||
+	   (Flags & ~TASK_DETACHED))
+	{
+		return NULL;
+	}
+
+	/* Reserve a place in the ready structure before allocating, a full EDF heap would drop the task */
+	INTERRUPT_SAVE_AND_DISABLE(PrimaskState);
+	if((NUMBER_OF_STATIC_TASKS + gDynamicTaskCount) >= SCHED_MAX_TASKS)
+	{
+		INTERRUPT_RESTORE(PrimaskState);
+		return NULL;
+	}
+	gDynamicTaskCount++;
+	INTERRUPT_RESTORE(PrimaskState);
+
+	pTask = malloc(TASK_TCB_SIZE + StackSize);
+	if(pTask == NULL)
+	{
+		INTERRUPT_SAVE_AND_DISABLE(PrimaskState);
+		gDynamicTaskCount--;
+		INTERRUPT_RESTORE(PrimaskState);
+		return NULL;
+	}
+
+	/* The stack is Full Descending, it starts at the end of the block */
+	Task_Init(pTask, DYNAMIC_TASK, (uint32_t*)((uint8_t*)pTask + TASK_TCB_SIZE + StackSize), pTaskHandler);
+	pTask->relative_deadline = RelativeDeadline;
+	pTask->flags = Flags | TASK_FLAG_DYNAMIC;
+
+	/* Disable interrupts */
+	INTERRUPT_SAVE_AND_DISABLE(PrimaskState);
+
+	/* Insert the new task to the ready structure, it may preempt the creator under EDF */
+	Sched_Ready(pTask, ENQUEUE_WITH_REAR_IDLE_TASK);
+	Pend_PendSV();
+
+	/* Restore interrupts */
+	INTERRUPT_RESTORE(PrimaskState);
+
+	return pTask;
+}
+
+/**
+  * @brief  Terminates the current running task. Wakes up the task that waits for it in
+  * 		Task_Join(), and hands a detached task over to the idle task for reclamation.
+  * @note   This is also the return address of the tasks handlers, set in their initial stack
+  * 		frame, so a handler that returns terminates its task. The idle task never terminates.
+  * @param  None
+  * @retval None
+  */
+void Task_Exit(void)
+{
+	TaskControlBlock_t *pTask;
+
+#if (LIBC_REENT == 1)
+	/* Close the task's C library streams while it can still block on their locks */
+	if(gpCurrentRunningTask->task_id != IDLE_TASK)
+	{
+		Libc_Reent_Reclaim();
+	}
+#endif
+
+	/* Disable interrupts */
+	INTERRUPT_DISABLE();
+
+	pTask = gpCurrentRunningTask;
+	if(pTask->task_id != IDLE_TASK)
+	{
+		RECORD(RECORD_EXIT, pTask->task_id, 0, 0);
+
+		/* Change task state to TERMINATED, the scheduler never inserts it to a ready structure again */
+		pTask->current_state = TASK_TERMINATED_STATE;
+
+		/* The task's last job is done */
+		Sched_Job_Complete(pTask);
+
+		/* A scheduler lock held by the task dies with it */
+		pTask->sched_lock = 0;
+
+		/* The task never enters a ready structure again, its place can be reserved by a new task */
+		if(pTask->flags & TASK_FLAG_DYNAMIC)
+		{
+			gDynamicTaskCount--;
+		}
+
+		if(pTask->joiner != NULL)
+		{
+			Task_Unblock(pTask->joiner);
+		}
+		else if(pTask->flags & TASK_FLAG_DETACHED)
+		{
+			Task_Release(pTask);
+		}
+
+		/* Pend the PendSV exception and initiate a contect-switch */
+		Pend_PendSV();
+	}
+
+	/* Enable interrupts, the context-switch takes place here and the task never runs again */
+	INTERRUPT_ENABLE();
+
+	while(1);
+}
+
+/**
+  * @brief  Blocks the current running task until a task terminates, then hands the terminated
+  * 		task over to the idle task for reclamation. The pointer to the joined task is no longer
+  * 		valid once this function returns.
+  * @param  pTask - Pointer to the task to wait for. Must be joinable, and joined only once.
+  * @retval TASK_OK if the task terminated, TASK_INVALID if it can't be joined.
+  */
+uint8_t Task_Join(TaskControlBlock_t *pTask)
+{
+	/* Disable interrupts */
+	INTERRUPT_DISABLE();
+
+	if((pTask == NULL) || (pTask == gpCurrentRunningTask) || (pTask->flags & TASK_FLAG_DETACHED) ||
+	   (pTask->joiner != NULL))
+	{
+		INTERRUPT_ENABLE();
+		return TASK_INVALID;
+	}
+
+	pTask->joiner = gpCurrentRunningTask;
+
+	/* Task_Exit() unblocks the joiner. Any other wakeup of the joiner is spurious */
+	while(pTask->current_state != TASK_TERMINATED_STATE)
+	{
+		Task_Block(TASK_BLOCK_FOREVER);
+
+		/* Enable interrupts, the context-switch takes place here */
+		INTERRUPT_ENABLE();
+		INTERRUPT_DISABLE();
+	}
+
+	Task_Release(pTask);
+
+	/* Enable interrupts */
+	INTERRUPT_ENABLE();
+
+	return TASK_OK;
+}
+
+/**
+  * @brief  Releases the memory of the terminated tasks. Called by the idle task, which is never
+  * 		running on the stacks being released.
+  * @param  None
+  * @retval None
+  */
+void Task_Reclaim(void)
+{
+	TaskControlBlock_t *pTask;
+
+	while(gpReclaimList != NULL)
+	{
+		/* Disable interrupts */
+		INTERRUPT_DISABLE();
+
+		pTask = gpReclaimList;
+		gpReclaimList = pTask->next;
+
+		/* Enable interrupts */
+		INTERRUPT_ENABLE();
+
+		free(pTask);
+	}
+}
@@ -0,0 +1,541 @@
+/**
+ ******************************************************************************
+ * @file           : tlsf.c
+ * @author         : Noam Yakar
+ * @brief          : This file contains the two-level segregated fit (TLSF)
+ *                   allocator. Free blocks are kept in segregated lists indexed
+ *                   by a first level (power of 2 range) and a second level
+ *                   (linear subdivision of the range), found through two
+ *                   bitmaps. Allocation and release take constant time.
+ *                   With TLSF_MALLOC set, it also serves newlib's malloc family
+ *                   from the RAM between the end of .bss and the MSP stack.
+ ******************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------- */
+
+#include <string.h>
+#include <errno.h>
+#include "tlsf.h"
+
+/* Macros ------------------------------------------------------------------- */
+
+/* Block header fields */
+#define TLSF_BLOCK_FREE          ((size_t)0x1U)          /* The block is free */
+#define TLSF_PREV_FREE           ((size_t)0x2U)          /* The previous block in memory is free */
+#define TLSF_SIZE_MASK           (~((size_t)0x3U))
+
+/* Bytes of the block header in front of the payload */
+#define TLSF_OVERHEAD            (offsetof(TlsfBlock_t, next_free))
+
+/* Smallest payload, holds the free-list links */
+#define TLSF_BLOCK_SIZE_MIN      (sizeof(TlsfBlock_t) - (TLSF_OVERHEAD))
+
+/* Largest payload */
+#define TLSF_BLOCK_SIZE_MAX      (((size_t)1U << ((TLSF_FL_INDEX_MAX) + 1U)) - (TLSF_ALIGN))
+
+/* Private functions definitions -------------------------------------------- */
+
+/**
+  * @brief  Returns the index of the most significant set bit.
+  * @param  Value - A non-zero value.
+  * @retval Bit index.
+  */
+static inline uint32_t Tlsf_Fls(size_t Value)
+{
+	return 31U - (uint32_t)__builtin_clz((uint32_t)Value);
+}
+
+/**
+  * @brief  Returns the index of the least significant set bit.
+  * @param  Value - A non-zero value.
+  * @retval Bit index.
+  */
+static inline uint32_t Tlsf_Ffs(uint32_t Value)
+{
+	return (uint32_t)__builtin_ctz(Value);
+}
+
+static inline size_t Tlsf_Size(const TlsfBlock_t *pBlock)
+{
+	return pBlock->size & TLSF_SIZE_MASK;
+}
+
+static inline void *Tlsf_Payload(TlsfBlock_t *pBlock)
+{
+	return (uint8_t*)pBlock + TLSF_OVERHEAD;
+}
+
+static inline TlsfBlock_t *Tlsf_From_Payload(void *pMemory)
+{
+	return (TlsfBlock_t*)((uint8_t*)pMemory - TLSF_OVERHEAD);
+}
+
+static inline TlsfBlock_t *Tlsf_Next_Phys(TlsfBlock_t *pBlock)
+{
+	return (TlsfBlock_t*)((uint8_t*)Tlsf_Payload(pBlock) + Tlsf_Size(pBlock));
+}
+
+/**
+  * @brief  Computes the free list indexes of a block size.
+  * @param  Size - Payload size.
+  * @param  pFl - Receives the first level index.
+  * @param  pSl - Receives the second level index.
+  * @retval None
+  */
+static void Tlsf_Mapping_Insert(size_t Size, uint32_t *pFl, uint32_t *pSl)
+{
+	uint32_t Fl;
+
+	if(Size < ((size_t)1U << TLSF_FL_INDEX_SHIFT))
+	{
+		*pFl = 0;
+		*pSl = (uint32_t)(Size >> TLSF_ALIGN_LOG2);
+	}
+	else
+	{
+		Fl = Tlsf_Fls(Size);
+		*pSl = (uint32_t)(Size >> (Fl - TLSF_SL_INDEX_COUNT_LOG2)) ^ TLSF_SL_INDEX_COUNT;
+		*pFl = Fl - (TLSF_FL_INDEX_SHIFT - 1U);
+	}
+}
+
+/**
+  * @brief  Computes the indexes of the first free list whose blocks are all large enough for
+  * 		a request, by rounding the request up to the next list.
+  * @param  Size - Requested payload size.
+  * @param  pFl - Receives the first level index.
+  * @param  pSl - Receives the second level index.
+  * @retval None
+  */
+static void Tlsf_Mapping_Search(size_t Size, uint32_t *pFl, uint32_t *pSl)
+{
+	if(Size >= ((size_t)1U << TLSF_FL_INDEX_SHIFT))
+	{
+		Size += ((size_t)1U << (Tlsf_Fls(Size) - TLSF_SL_INDEX_COUNT_LOG2)) - 1U;
+	}
+	Tlsf_Mapping_Insert(Size, pFl, pSl);
+}
+
+/**
+  * @brief  Finds a non-empty free list at or above the given indexes.
+  * @param  pTlsf - Pointer to the allocator.
+  * @param  pFl - First level index, updated to the list found.
+  * @param  pSl - Second level index, updated to the list found.
+  * @retval The first block of the list, or NULL if there is none.
+  */
+static TlsfBlock_t *Tlsf_Search_Suitable_Block(Tlsf_t *pTlsf, uint32_t *pFl, uint32_t *pSl)
+{
+	uint32_t Fl = *pFl;
+	uint32_t SlMap = pTlsf->sl_bitmap[Fl] & (~0U << *pSl);
+	uint32_t FlMap;
+
+	if(SlMap == 0U)
+	{
+		/* No block in this range, take the smallest list of a larger range */
+		FlMap = pTlsf->fl_bitmap & (~0U << (Fl + 1U));
+		if(FlMap == 0U)
+		{
+			return NULL;
+		}
+		Fl = Tlsf_Ffs(FlMap);
+		SlMap = pTlsf->sl_bitmap[Fl];
+	}
+
+	*pFl = Fl;
+	*pSl = Tlsf_Ffs(SlMap);
+
+	return pTlsf->blocks[Fl][*pSl];
+}
+
+static void Tlsf_Remove_Free_Block(Tlsf_t *pTlsf, TlsfBlock_t *pBlock, uint32_t Fl, uint32_t Sl)
+{
+	if(pBlock->prev_free != NULL)
+	{
+		pBlock->prev_free->next_free = pBlock->next_free;
+	}
+	else
+	{
+		pTlsf->blocks[Fl][Sl] = pBlock->next_free;
+		if(pBlock->next_free == NULL)
+		{
+			pTlsf->sl_bitmap[Fl] &= ~(1U << Sl);
+			if(pTlsf->sl_bitmap[Fl] == 0U)
+			{
+				pTlsf->fl_bitmap &= ~(1U << Fl);
+			}
+		}
+	}
+	if(pBlock->next_free != NULL)
+	{
+		pBlock->next_free->prev_free = pBlock->prev_free;
+	}
+}
+
+static void Tlsf_Insert_Free_Block(Tlsf_t *pTlsf, TlsfBlock_t *pBlock)
+{
+	uint32_t Fl;
+	uint32_t Sl;
+
+	Tlsf_Mapping_Insert(Tlsf_Size(pBlock), &Fl, &Sl);
+
+	pBlock->prev_free = NULL;
+	pBlock->next_free = pTlsf->blocks[Fl][Sl];
+	if(pBlock->next_free != NULL)
+	{
+		pBlock->next_free->prev_free = pBlock;
+	}
+	pTlsf->blocks[Fl][Sl] = pBlock;
+	pTlsf->fl_bitmap |= (1U << Fl);
+	pTlsf->sl_bitmap[Fl] |= (1U << Sl);
+}
+
+/**
+  * @brief  Marks a block free, and tells the next block in memory about it.
+  * @param  pBlock - Pointer to the block.
+  * @retval None
+  */
+static void Tlsf_Mark_Free(TlsfBlock_t *pBlock)
+{
+	TlsfBlock_t *pNext = Tlsf_Next_Phys(pBlock);
+
+	pBlock->size |= TLSF_BLOCK_FREE;
+	pNext->prev_phys = pBlock;
+	pNext->size |= TLSF_PREV_FREE;
+}
+
+/**
+  * @brief  Marks a block used, and tells the next block in memory about it.
+  * @param  pBlock - Pointer to the block.
+  * @retval None
+  */
+static void Tlsf_Mark_Used(TlsfBlock_t *pBlock)
+{
+	pBlock->size &= ~TLSF_BLOCK_FREE;
+	Tlsf_Next_Phys(pBlock)->size &= ~TLSF_PREV_FREE;
+}
+
+/**
+  * @brief  Removes a block from its free list.
+  * @param  pTlsf - Pointer to the allocator.
+  * @param  pBlock - Pointer to the free block.
+  * @retval None
+  */
+static void Tlsf_Take_Free_Block(Tlsf_t *pTlsf, TlsfBlock_t *pBlock)
+{
+	uint32_t Fl;
+	uint32_t Sl;
+
+	Tlsf_Mapping_Insert(Tlsf_Size(pBlock), &Fl, &Sl);
+	Tlsf_Remove_Free_Block(pTlsf, pBlock, Fl, Sl);
+}
+
+/* Functions definitions ---------------------------------------------------- */
+
+/**
+  * @brief  Initializes the allocator over a memory region. The region is used for a single
+  * 		free block followed by a zero-size sentinel block.
+  * @param  pTlsf - Pointer to the allocator.
+  * @param  pMemory - Start of the region.
+  * @param  Size - Size of the region in bytes.
+  * @retval None
+  */
+void Tlsf_Init(Tlsf_t *pTlsf, void *pMemory, size_t Size)
+{
+	uintptr_t Start = ((uintptr_t)pMemory + TLSF_ALIGN - 1U) & ~((uintptr_t)TLSF_ALIGN - 1U);
+	size_t BlockSize;
+	TlsfBlock_t *pBlock;
+	TlsfBlock_t *pSentinel;
+
+	memset(pTlsf, 0, sizeof(Tlsf_t));
+
+	Size -= (size_t)(Start - (uintptr_t)pMemory);
+	if(Size < ((2U * TLSF_OVERHEAD) + TLSF_BLOCK_SIZE_MIN))
+	{
+		return;
+	}
+
+	BlockSize = (Size - (2U * TLSF_OVERHEAD)) & ~((size_t)TLSF_ALIGN - 1U);
+	if(BlockSize > TLSF_BLOCK_SIZE_MAX)
+	{
+		BlockSize = TLSF_BLOCK_SIZE_MAX;
+	}
+
+	pBlock = (TlsfBlock_t*)Start;
+	pBlock->prev_phys = NULL;
+	pBlock->size = BlockSize;
+
+	pSentinel = Tlsf_Next_Phys(pBlock);
+	pSentinel->size = 0;
+
+	Tlsf_Mark_Free(pBlock);
+	Tlsf_Insert_Free_Block(pTlsf, pBlock);
+	pTlsf->total = BlockSize;
+}
+
+/**
+  * @brief  Allocates a block.
+  * @param  pTlsf - Pointer to the allocator.
+  * @param  Size - Requested size in bytes.
+  * @retval Pointer to the block, aligned to TLSF_ALIGN, or NULL if there is no free block large enough.
+  */
+void *Tlsf_Malloc(Tlsf_t *pTlsf, size_t Size)
+{
+	TlsfBlock_t *pBlock;
+	TlsfBlock_t *pRemain;
+	uint32_t Fl;
+	uint32_t Sl;
+
+	if((Size == 0U) || (Size > TLSF_BLOCK_SIZE_MAX))
+	{
+		pTlsf->failures++;
+		return NULL;
+	}
+
+	Size = (Size + TLSF_ALIGN - 1U) & ~((size_t)TLSF_ALIGN - 1U);
+	if(Size < TLSF_BLOCK_SIZE_MIN)
+	{
+		Size = TLSF_BLOCK_SIZE_MIN;
+	}
+
+	Tlsf_Mapping_Search(Size, &Fl, &Sl);
+	pBlock = (Fl < TLSF_FL_INDEX_COUNT) ? Tlsf_Search_Suitable_Block(pTlsf, &Fl, &Sl) : NULL;
+	if(pBlock == NULL)
+	{
+		pTlsf->failures++;
+		return NULL;
+	}
+	Tlsf_Remove_Free_Block(pTlsf, pBlock, Fl, Sl);
+
+	/* Return the tail of the block to the free lists if it can hold a block of its own */
+	if(Tlsf_Size(pBlock) >= (Size + sizeof(TlsfBlock_t)))
+	{
+		pRemain = (TlsfBlock_t*)((uint8_t*)Tlsf_Payload(pBlock) + Size);
+		pRemain->size = Tlsf_Size(pBlock) - Size - TLSF_OVERHEAD;
+		pBlock->size = Size | (pBlock->size & ~TLSF_SIZE_MASK);
+		Tlsf_Mark_Free(pRemain);
+		Tlsf_Insert_Free_Block(pTlsf, pRemain);
+	}
+	Tlsf_Mark_Used(pBlock);
+
+	pTlsf->used += Tlsf_Size(pBlock) + TLSF_OVERHEAD;
+	if(pTlsf->used > pTlsf->peak)
+	{
+		pTlsf->peak = pTlsf->used;
+	}
+
+	return Tlsf_Payload(pBlock);
+}
+
+/**
+  * @brief  Releases a block and merges it with its free neighbours in memory.
+  * @param  pTlsf - Pointer to the allocator.
+  * @param  pMemory - Pointer returned by Tlsf_Malloc() or Tlsf_Realloc(), or NULL.
+  * @retval None
+  */
+void Tlsf_Free(Tlsf_t *pTlsf, void *pMemory)
+{
+	TlsfBlock_t *pBlock;
+	TlsfBlock_t *pPrev;
+	TlsfBlock_t *pNext;
+
+	if(pMemory == NULL)
+	{
+		return;
+	}
+
+	pBlock = Tlsf_From_Payload(pMemory);
+	pTlsf->used -= Tlsf_Size(pBlock) + TLSF_OVERHEAD;
+
+	/* Merge with the previous block */
+	if(pBlock->size & TLSF_PREV_FREE)
+	{
+		pPrev = pBlock->prev_phys;
+		Tlsf_Take_Free_Block(pTlsf, pPrev);
+		pPrev->size += Tlsf_Size(pBlock) + TLSF_OVERHEAD;
+		pBlock = pPrev;
+	}
+
+	/* Merge with the next block */
+	pNext = Tlsf_Next_Phys(pBlock);
+	if(pNext->size & TLSF_BLOCK_FREE)
+	{
+		Tlsf_Take_Free_Block(pTlsf, pNext);
+		pBlock->size += Tlsf_Size(pNext) + TLSF_OVERHEAD;
+	}
+
+	Tlsf_Mark_Free(pBlock);
+	Tlsf_Insert_Free_Block(pTlsf, pBlock);
+}
+
+/**
+  * @brief  Changes the size of a block. The block is kept if it is already large enough,
+  * 		otherwise its contents are moved to a new block.
+  * @param  pTlsf - Pointer to the allocator.
+  * @param  pMemory - Pointer to the block, or NULL to allocate a new one.
+  * @param  Size - New size in bytes, 0 releases the block.
+  * @retval Pointer to the block, or NULL if there is no free block large enough. The original block
+  * 		is left untouched on failure.
+  */
+void *Tlsf_Realloc(Tlsf_t *pTlsf, void *pMemory, size_t Size)
+{
+	void *pNew;
+
+	if(pMemory == NULL)
+	{
+		return Tlsf_Malloc(pTlsf, Size);
+	}
+	if(Size == 0U)
+	{
+		Tlsf_Free(pTlsf, pMemory);
+		return NULL;
+	}
+	if(Tlsf_Block_Size(pMemory) >= Size)
+	{
+		return pMemory;
+	}
+
+	pNew = Tlsf_Malloc(pTlsf, Size);
+	if(pNew != NULL)
+	{
+		memcpy(pNew, pMemory, Tlsf_Block_Size(pMemory));
+		Tlsf_Free(pTlsf, pMemory);
+	}
+
+	return pNew;
+}
+
+/**
+  * @brief  Returns the usable size of an allocated block.
+  * @param  pMemory - Pointer to the block.
+  * @retval Size in bytes.
+  */
+size_t Tlsf_Block_Size(void *pMemory)
+{
+	return Tlsf_Size(Tlsf_From_Payload(pMemory));
+}
+
+#if (TLSF_MALLOC == 1)
+
+/* newlib's malloc family --------------------------------------------------- */
+
+struct _reent;
+
+/* The heap of the malloc family */
+Tlsf_t gHeap;
+static uint8_t gHeapReady = 0;
+
+/**
+  * @brief  Initializes the heap over the RAM between the end of .bss and the MSP stack, on the
+  * 		first allocation. Must be called with interrupts disabled.
+  * @param  None
+  * @retval None
+  */
+static void Heap_Init(void)
+{
+	extern uint8_t _end; /* Symbol defined in the linker script */
+	extern uint8_t _estack; /* Symbol defined in the linker script */
+	extern uint32_t _Min_Stack_Size; /* Symbol defined in the linker script */
+	const uint32_t stack_limit = (uint32_t)&_estack - (uint32_t)&_Min_Stack_Size;
+
+	Tlsf_Init(&gHeap, &_end, stack_limit - (uint32_t)&_end);
+	gHeapReady = 1;
+}
+
+void *_malloc_r(struct _reent *pReent, size_t Size)
+{
+	uint32_t State;
+	void *pMemory;
+
+	(void)pReent;
+
+	INTERRUPT_SAVE_AND_DISABLE(State);
+	if(!gHeapReady)
+	{
+		Heap_Init();
+	}
+	pMemory = Tlsf_Malloc(&gHeap, Size);
+	INTERRUPT_RESTORE(State);
+
+	if(pMemory == NULL)
+	{
+		errno = ENOMEM;
+	}
+
+	return pMemory;
+}
+
+void _free_r(struct _reent *pReent, void *pMemory)
+{
+	uint32_t State;
+
+	(void)pReent;
+
+	INTERRUPT_SAVE_AND_DISABLE(State);
+	Tlsf_Free(&gHeap, pMemory);
+	INTERRUPT_RESTORE(State);
+}
+
+void *_realloc_r(struct _reent *pReent, void *pMemory, size_t Size)
+{
+	uint32_t State;
+	void *pNew;
+
+	(void)pReent;
+
+	INTERRUPT_SAVE_AND_DISABLE(State);
+	if(!gHeapReady)
+	{
+		Heap_Init();
+	}
+	pNew = Tlsf_Realloc(&gHeap, pMemory, Size);
+	INTERRUPT_RESTORE(State);
+
+	if((pNew == NULL) && (Size != 0U))
+	{
+		errno = ENOMEM;
+	}
+
+	return pNew;
+}
+
+void *_calloc_r(struct _reent *pReent, size_t Count, size_t Size)
+{
+	void *pMemory;
+
+	if((Size != 0U) && (Count > (SIZE_MAX / Size)))
+	{
+		errno = ENOMEM;
+		return NULL;
+	}
+
+	pMemory = _malloc_r(pReent, Count * Size);
+	if(pMemory != NULL)
+	{
+		memset(pMemory, 0, Count * Size);
+	}
+
+	return pMemory;
+}
+
+void *malloc(size_t Size)
+{
+	return _malloc_r(NULL, Size);
+}
+
+void free(void *pMemory)
+{
+	_free_r(NULL, pMemory);
+}
+
+void *realloc(void *pMemory, size_t Size)
+{
+	return _realloc_r(NULL, pMemory, Size);
+}
+
+void *calloc(size_t Count, size_t Size)
+{
+	return _calloc_r(NULL, Count, Size);
+}
+
+#endif /* TLSF_MALLOC */
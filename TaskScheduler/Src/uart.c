@@ -0,0 +1,422 @@
+/**
+ ******************************************************************************
+ * @file           : uart.c
+ * @author         : Noam Yakar
+ * @brief          : This file contains function definitions of the USART2
+ *                   driver (PA2 TX, PA3 RX). Transmission is done by DMA1
+ *                   stream 6 straight from the TX stream buffer. Reception
+ *                   runs DMA1 stream 5 in circular mode, and the received
+ *                   bytes are moved to the RX stream buffer at half and full
+ *                   transfer and when the line goes idle, so the CPU handles
+ *                   blocks instead of bytes.
+ ******************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------- */
+
+#include "uart.h"
+#include "streambuf.h"
+#include "irq.h"
+#include "idle.h"
+#include "dvfs.h"
+
+/* Macros ------------------------------------------------------------------- */
+
+/* RCC clock enable registers */
+#define RCC_AHB1ENR_REG          ( (RCC_AHB1_BASE) + 0x30U )
+#define RCC_APB1ENR              ( (RCC_AHB1_BASE) + 0x40U )
+
+/* GPIOA registers */
+#define GPIOA_BASE               0x40020000U
+#define GPIOA_MODER              ( (GPIOA_BASE) + 0x00U )
+#define GPIOA_PUPDR              ( (GPIOA_BASE) + 0x0CU )
+#define GPIOA_AFRL               ( (GPIOA_BASE) + 0x20U )
+#define UART_TX_PIN              2U
+#define UART_RX_PIN              3U
+#define UART_PIN_AF              7U          /* AF7 - USART1..3 */
+
+/* USART2 registers */
+#define USART2_BASE              0x40004400U
+#define USART2_SR                ( (USART2_BASE) + 0x00U )
+#define USART2_DR                ( (USART2_BASE) + 0x04U )
+#define USART2_BRR               ( (USART2_BASE) + 0x08U )
+#define USART2_CR1               ( (USART2_BASE) + 0x0CU )
+#define USART2_CR3               ( (USART2_BASE) + 0x14U )
+#define USART2_IRQ_NUMBER        38U
+
+/* DMA1 registers. USART2 RX is stream 5 and TX is stream 6, both on channel 4 */
+#define DMA1_BASE                0x40026000U
+#define DMA1_HIFCR               ( (DMA1_BASE) + 0x0CU )
+#define DMA1_SxCR(Stream)        ( (DMA1_BASE) + 0x10U + (0x18U * (Stream)) )
+#define DMA1_SxNDTR(Stream)      ( (DMA1_BASE) + 0x14U + (0x18U * (Stream)) )
+#define DMA1_SxPAR(Stream)       ( (DMA1_BASE) + 0x18U + (0x18U * (Stream)) )
+#define DMA1_SxM0AR(Stream)      ( (DMA1_BASE) + 0x1CU + (0x18U * (Stream)) )
+#define UART_RX_STREAM           5U
+#define UART_TX_STREAM           6U
+#define UART_DMA_CHANNEL         4U
+#define DMA1_STREAM5_IRQ_NUMBER  16U
+#define DMA1_STREAM6_IRQ_NUMBER  17U
+
+/* DMA1_HIFCR flags of streams 5 and 6: FEIF, DMEIF, TEIF, HTIF, TCIF */
+#define DMA_STREAM5_FLAGS        ( (1U << 6) | (0xFU << 8) )
+#define DMA_STREAM6_FLAGS        ( (1U << 16) | (0xFU << 18) )
+
+/* Global variables --------------------------------------------------------- */
+
+static uint8_t gUartTxStorage[UART_TX_BUFFER_SIZE];
+static uint8_t gUartRxStorage[UART_RX_BUFFER_SIZE];
+static uint8_t gUartRxDma[UART_RX_DMA_SIZE];
+
+static StreamBuf_t gUartTx;
+static StreamBuf_t gUartRx;
+
+/* Bytes of the TX stream buffer being transmitted by DMA, 0 if the TX stream is idle */
+static volatile uint32_t gUartTxLength = 0;
+
+/* Stop mode is inhibited from the start of a transmission until its last byte left the line */
+static volatile uint8_t gUartTxStopInhibit = 0;
+
+/* Position in the RX DMA buffer up to which the received bytes were moved to the RX stream buffer */
+static uint32_t gUartRxPosition = 0;
+
+/* Functions definitions ---------------------------------------------------- */
+
+/**
+  * @brief  Starts a DMA transfer of the contiguous bytes at the tail of the TX stream buffer, if
+  * 		the TX stream is idle. Send hook of the TX stream buffer, also called when a transfer
+  * 		completes.
+  * @param  pSb - Pointer to the TX stream buffer.
+  * @retval None
+  */
+static void Uart_Tx_Start(StreamBuf_t *pSb)
+{
+	uint32_t *pDMA_CR = (uint32_t*)DMA1_SxCR(UART_TX_STREAM);
+	uint32_t *pDMA_NDTR = (uint32_t*)DMA1_SxNDTR(UART_TX_STREAM);
+	uint32_t *pDMA_M0AR = (uint32_t*)DMA1_SxM0AR(UART_TX_STREAM);
+	uint32_t *pDMA1_HIFCR = (uint32_t*)DMA1_HIFCR;
+	uint32_t PrimaskState;
+	uint8_t *pData;
+	uint32_t Length;
+
+	/* Disable interrupts, the transfer complete interrupt also starts transfers */
+	INTERRUPT_SAVE_AND_DISABLE(PrimaskState);
+
+	if(gUartTxLength == 0U)
+	{
+		Length = StreamBuf_Read_Pointer(pSb, &pData);
+		if(Length != 0U)
+		{
+			/* The USART doesn't transmit in Stop mode */
+			if(!gUartTxStopInhibit)
+			{
+				gUartTxStopInhibit = 1;
+				Idle_Stop_Inhibit();
+			}
+
+			gUartTxLength = Length;
+			*(uint32_t*)USART2_SR = ~( 1U << 6);  /* Clear TC */
+			*pDMA1_HIFCR = DMA_STREAM6_FLAGS;
+			*pDMA_M0AR = (uint32_t)pData;
+			*pDMA_NDTR = Length;
+			*pDMA_CR |= ( 1 << 0);  /* EN */
+		}
+	}
+
+	/* Restore interrupts */
+	INTERRUPT_RESTORE(PrimaskState);
+}
+
+/**
+  * @brief  Moves the bytes the RX DMA stream wrote since the last call to the RX stream buffer.
+  * 		Called from the USART2 and DMA1 stream 5 interrupts, which have the same priority.
+  * @param  None
+  * @retval None
+  */
+static void Uart_Rx_Drain(void)
+{
+	uint32_t Position = UART_RX_DMA_SIZE - *((volatile uint32_t*)DMA1_SxNDTR(UART_RX_STREAM));
+
+	if(Position >= UART_RX_DMA_SIZE)
+	{
+		Position = 0;
+	}
+
+	if(Position > gUartRxPosition)
+	{
+		StreamBuf_Send_From_Isr(&gUartRx, &gUartRxDma[gUartRxPosition], Position - gUartRxPosition);
+	}
+	else if(Position < gUartRxPosition)
+	{
+		/* The DMA stream wrapped around */
+		StreamBuf_Send_From_Isr(&gUartRx, &gUartRxDma[gUartRxPosition], UART_RX_DMA_SIZE - gUartRxPosition);
+		StreamBuf_Send_From_Isr(&gUartRx, gUartRxDma, Position);
+	}
+
+	gUartRxPosition = Position;
+}
+
+/**
+  * @brief  Tells whether the caller runs in a task, on the PSP, and may block.
+  * @param  None
+  * @retval 1 in a task, 0 in a handler or before the scheduler started.
+  */
+static uint8_t Uart_In_Task(void)
+{
+	uint32_t Ipsr;
+	uint32_t Control;
+
+	__asm volatile ("MRS %0,IPSR" : "=r" (Ipsr));
+	__asm volatile ("MRS %0,CONTROL" : "=r" (Control));
+
+	return (Ipsr == 0U) && (Control & ( 1 << 1));
+}
+
+/**
+  * @brief  Reprograms the baud rate for the APB1 clock of a new operating point. Registered as a
+  * 		clock change hook, runs with interrupts disabled. A byte on the line during the switch
+  * 		may be corrupted.
+  * @param  pPoint - Pointer to the operating point.
+  * @retval None
+  */
+static void Uart_Clock_Changed(const DvfsPoint_t *pPoint)
+{
+	uint32_t *pUSART2_BRR = (uint32_t*)USART2_BRR;
+
+	/* 16x oversampling */
+	*pUSART2_BRR = (pPoint->apb1_hz + (UART_BAUD_RATE / 2U)) / UART_BAUD_RATE;
+}
+
+/**
+  * @brief  Initializes USART2 at UART_BAUD_RATE with its TX and RX DMA streams and interrupts.
+  * @note   The USART neither transmits nor receives in Stop mode, so Stop mode is inhibited while
+  * 		a transmission is in progress and while a task waits in Uart_Read(). Bytes arriving
+  * 		while no task reads may be lost in Stop mode.
+  * @param  None
+  * @retval None
+  */
+void Uart_Init(void)
+{
+	uint32_t *pRCC_AHB1ENR = (uint32_t*)RCC_AHB1ENR_REG;
+	uint32_t *pRCC_APB1ENR = (uint32_t*)RCC_APB1ENR;
+	uint32_t *pGPIOA_MODER = (uint32_t*)GPIOA_MODER;
+	uint32_t *pGPIOA_PUPDR = (uint32_t*)GPIOA_PUPDR;
+	uint32_t *pGPIOA_AFRL = (uint32_t*)GPIOA_AFRL;
+	uint32_t *pUSART2_CR1 = (uint32_t*)USART2_CR1;
+	uint32_t *pUSART2_CR3 = (uint32_t*)USART2_CR3;
+	uint32_t *pRxCR = (uint32_t*)DMA1_SxCR(UART_RX_STREAM);
+	uint32_t *pTxCR = (uint32_t*)DMA1_SxCR(UART_TX_STREAM);
+
+	StreamBuf_Init(&gUartTx, gUartTxStorage, UART_TX_BUFFER_SIZE, Uart_Tx_Start);
+	StreamBuf_Init(&gUartRx, gUartRxStorage, UART_RX_BUFFER_SIZE, NULL);
+
+	/* Enable the peripheral clocks of GPIOA, DMA1 and USART2 */
+	*pRCC_AHB1ENR |= ( 1 << 0) | ( 1 << 21);
+	*pRCC_APB1ENR |= ( 1 << 17);
+
+	/* PA2 and PA3 in alternate function mode, pull-up on RX */
+	*pGPIOA_MODER &= ~(( 3U << (2 * UART_TX_PIN)) | ( 3U << (2 * UART_RX_PIN)));
+	*pGPIOA_MODER |= ( 2U << (2 * UART_TX_PIN)) | ( 2U << (2 * UART_RX_PIN));
+	*pGPIOA_PUPDR |= ( 1U << (2 * UART_RX_PIN));
+	*pGPIOA_AFRL &= ~(( 0xFU << (4 * UART_TX_PIN)) | ( 0xFU << (4 * UART_RX_PIN)));
+	*pGPIOA_AFRL |= ( UART_PIN_AF << (4 * UART_TX_PIN)) | ( UART_PIN_AF << (4 * UART_RX_PIN));
+
+	/* RX stream: peripheral to memory, circular, half and full transfer interrupts */
+	*(uint32_t*)DMA1_SxPAR(UART_RX_STREAM) = USART2_DR;
+	*(uint32_t*)DMA1_SxM0AR(UART_RX_STREAM) = (uint32_t)gUartRxDma;
+	*(uint32_t*)DMA1_SxNDTR(UART_RX_STREAM) = UART_RX_DMA_SIZE;
+	*pRxCR = (UART_DMA_CHANNEL << 25) | ( 1 << 10) | ( 1 << 8) | ( 1 << 4) | ( 1 << 3); /* CHSEL, MINC, CIRC, TCIE, HTIE */
+	*pRxCR |= ( 1 << 0);           /* EN */
+
+	/* TX stream: memory to peripheral, transfer complete interrupt. Enabled by Uart_Tx_Start() */
+	*(uint32_t*)DMA1_SxPAR(UART_TX_STREAM) = USART2_DR;
+	*pTxCR = (UART_DMA_CHANNEL << 25) | ( 1 << 10) | ( 1 << 6) | ( 1 << 4); /* CHSEL, MINC, DIR = memory to peripheral, TCIE */
+
+	/* USART2: baud rate for the current APB1 clock, DMA requests, idle line interrupt */
+	Uart_Clock_Changed(Dvfs_Get_Point());
+	Dvfs_Register_Hook(Uart_Clock_Changed);
+	*pUSART2_CR3 |= ( 1 << 7) | ( 1 << 6);                       /* DMAT, DMAR */
+	*pUSART2_CR1 |= ( 1 << 13) | ( 1 << 4) | ( 1 << 3) | ( 1 << 2); /* UE, IDLEIE, TE, RE */
+
+	Irq_Set_Priority(USART2_IRQ_NUMBER, UART_IRQ_PRIORITY);
+	Irq_Set_Priority(DMA1_STREAM5_IRQ_NUMBER, UART_IRQ_PRIORITY);
+	Irq_Set_Priority(DMA1_STREAM6_IRQ_NUMBER, UART_IRQ_PRIORITY);
+	Irq_Enable(USART2_IRQ_NUMBER);
+	Irq_Enable(DMA1_STREAM5_IRQ_NUMBER);
+	Irq_Enable(DMA1_STREAM6_IRQ_NUMBER);
+}
+
+/**
+  * @brief  Queues bytes for transmission, blocking the current running task while the TX stream
+  * 		buffer is full.
+  * @param  pData - Pointer to the bytes.
+  * @param  Length - Number of bytes.
+  * @param  TimeoutTickCount - Maximum duration in terms of SysTick ticks to wait, or TASK_BLOCK_FOREVER.
+  * @retval Number of bytes queued.
+  */
+uint32_t Uart_Write(const void *pData, uint32_t Length, uint32_t TimeoutTickCount)
+{
+	return StreamBuf_Send(&gUartTx, pData, Length, TimeoutTickCount);
+}
+
+/**
+  * @brief  Reads received bytes, blocking the current running task until some bytes are received.
+  * 		Stop mode is inhibited while the task waits, the USART doesn't receive in Stop mode.
+  * @param  pData - Pointer to the destination.
+  * @param  Length - Maximum number of bytes to read.
+  * @param  TimeoutTickCount - Maximum duration in terms of SysTick ticks to wait, or TASK_BLOCK_FOREVER.
+  * @retval Number of bytes read, 0 if the timeout expired.
+  */
+uint32_t Uart_Read(void *pData, uint32_t Length, uint32_t TimeoutTickCount)
+{
+	uint32_t Received;
+
+	Idle_Stop_Inhibit();
+	Received = StreamBuf_Receive(&gUartRx, pData, Length, TimeoutTickCount);
+	Idle_Stop_Allow();
+
+	return Received;
+}
+
+/**
+  * @brief  Transmits bytes by polling, bypassing the TX stream buffer. For fault handlers and for
+  * 		output before the scheduler starts.
+  * @param  pData - Pointer to the bytes.
+  * @param  Length - Number of bytes.
+  * @retval None
+  */
+void Uart_Write_Polled(const void *pData, uint32_t Length)
+{
+	volatile uint32_t *pUSART2_SR = (uint32_t*)USART2_SR;
+	volatile uint32_t *pUSART2_DR = (uint32_t*)USART2_DR;
+	const uint8_t *pBytes = pData;
+
+	/* Nothing to do before Uart_Init() */
+	if(!(*(volatile uint32_t*)USART2_CR1 & ( 1 << 13)))  /* UE */
+	{
+		return;
+	}
+
+	for(uint32_t i = 0 ; i < Length ; i++)
+	{
+		while(!(*pUSART2_SR & ( 1 << 7)));  /* TXE */
+		*pUSART2_DR = pBytes[i];
+	}
+}
+
+/**
+  * @brief  Gets the number of received bytes dropped because the RX stream buffer was full.
+  * @param  None
+  * @retval Number of bytes.
+  */
+uint32_t Uart_Rx_Dropped(void)
+{
+	return gUartRx.dropped;
+}
+
+/**
+  * @brief  Handler for the USART2 interrupt. The line went idle: moves the received bytes to the
+  * 		RX stream buffer without waiting for the DMA half or full transfer. The last byte of a
+  * 		transmission left the line: allows Stop mode again.
+  * @param  None
+  * @retval None
+  */
+void USART2_IRQHandler(void)
+{
+	volatile uint32_t *pUSART2_SR = (uint32_t*)USART2_SR;
+	volatile uint32_t *pUSART2_DR = (uint32_t*)USART2_DR;
+	volatile uint32_t *pUSART2_CR1 = (uint32_t*)USART2_CR1;
+
+	if(*pUSART2_SR & ( 1 << 4))    /* IDLE */
+	{
+		/* Cleared by reading SR then DR */
+		(void)*pUSART2_DR;
+		Uart_Rx_Drain();
+	}
+
+	if((*pUSART2_CR1 & ( 1 << 6)) && (*pUSART2_SR & ( 1 << 6)))  /* TCIE, TC */
+	{
+		*pUSART2_CR1 &= ~( 1U << 6);
+
+		/* No transfer was started since the last one completed */
+		if((gUartTxLength == 0U) && gUartTxStopInhibit)
+		{
+			gUartTxStopInhibit = 0;
+			Idle_Stop_Allow();
+		}
+	}
+}
+
+/**
+  * @brief  Handler for the DMA1 stream 5 interrupt (USART2 RX), at half and full transfer.
+  * @param  None
+  * @retval None
+  */
+void DMA1_Stream5_IRQHandler(void)
+{
+	*(uint32_t*)DMA1_HIFCR = DMA_STREAM5_FLAGS;
+	Uart_Rx_Drain();
+}
+
+/**
+  * @brief  Handler for the DMA1 stream 6 interrupt (USART2 TX). Releases the transmitted bytes and
+  * 		starts the next transfer. If there is none, waits for the last byte to leave the line
+  * 		(USART2 TC) before allowing Stop mode.
+  * @param  None
+  * @retval None
+  */
+void DMA1_Stream6_IRQHandler(void)
+{
+	*(uint32_t*)DMA1_HIFCR = DMA_STREAM6_FLAGS;
+
+	StreamBuf_Consume(&gUartTx, gUartTxLength);
+	gUartTxLength = 0;
+	Uart_Tx_Start(&gUartTx);
+
+	if(gUartTxLength == 0U)
+	{
+		*(volatile uint32_t*)USART2_CR1 |= ( 1 << 6);  /* TCIE */
+	}
+}
+
+#if (UART_CONSOLE == 1)
+/**
+  * @brief  Retargets the C library output to the UART. Tasks queue the bytes and block while the
+  * 		TX stream buffer is full, handlers and code running before the scheduler poll.
+  * @param  File - Not used.
+  * @param  pData - Pointer to the bytes.
+  * @param  Length - Number of bytes.
+  * @retval Number of bytes written.
+  */
+int _write(int File, char *pData, int Length)
+{
+	(void)File;
+
+	if(Uart_In_Task())
+	{
+		return (int)Uart_Write(pData, (uint32_t)Length, TASK_BLOCK_FOREVER);
+	}
+
+	Uart_Write_Polled(pData, (uint32_t)Length);
+	return Length;
+}
+
+/**
+  * @brief  Retargets the C library input to the UART. Blocks the current running task until some
+  * 		bytes are received.
+  * @param  File - Not used.
+  * @param  pData - Pointer to the destination.
+  * @param  Length - Maximum number of bytes to read.
+  * @retval Number of bytes read, 0 outside of a task.
+  */
+int _read(int File, char *pData, int Length)
+{
+	(void)File;
+
+	if(!Uart_In_Task())
+	{
+		return 0;
+	}
+
+	return (int)Uart_Read(pData, (uint32_t)Length, TASK_BLOCK_FOREVER);
+}
+#endif
@@ -0,0 +1,171 @@
+/**
+ ******************************************************************************
+ * @file           : workqueue.c
+ * @author         : Noam Yakar
+ * @brief          : This file contains function definitions for the deferred
+ *                   interrupt work queue. ISRs post a function and an argument,
+ *                   and the work task executes them in batches.
+ ******************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------- */
+
+#include "workqueue.h"
+#include "sched.h"
+
+/* Global variables --------------------------------------------------------- */
+
+/* The work task object, allocated in main.c */
+extern TaskControlBlock_t *pWorkQueueTask;
+
+/* The deferred work queue */
+WorkQueue_t gWorkQueue;
+
+/* Functions definitions ---------------------------------------------------- */
+
+/**
+  * @brief  Initializes the work queue slots. Must be called before interrupts that post work are
+  * 		enabled.
+  * @param  None
+  * @retval None
+  */
+void WorkQueue_Init(void)
+{
+	/* Each slot starts free for the position it will be reserved at */
+	for(uint32_t i = 0 ; i < WORKQUEUE_SIZE ; i++)
+	{
+		gWorkQueue.items[i].sequence = i;
+	}
+
+	gWorkQueue.head = 0;
+	gWorkQueue.tail = 0;
+	gWorkQueue.dropped = 0;
+	gWorkQueue.processed = 0;
+	gWorkQueue.batches = 0;
+}
+
+/**
+  * @brief  Posts a work item to the work queue and wakes up the work task.
+  * @note   Intended to be called from ISRs. The slot is reserved with a LDREX/STREX based
+  * 		compare-and-swap, so ISRs of different priorities may post concurrently without
+  * 		disabling interrupts.
+  * @param  Handler - Pointer to the deferred work function.
+  * @param  Arg - Argument passed to the deferred work function.
+  * @retval WORKQUEUE_OK if the work item was posted, WORKQUEUE_FULL if it was dropped.
+  */
+WorkQueueStatus_e WorkQueue_Post(WorkHandler_t Handler, uint32_t Arg)
+{
+	uint32_t Position = gWorkQueue.head;
+	WorkItem_t *pItem;
+
+	/* Reserve a slot */
+	while(1)
+	{
+		pItem = &(gWorkQueue.items[Position & WORKQUEUE_MASK]);
+
+		/* The slot still holds an item that wasn't consumed, the queue is full */
+		if(pItem->sequence != Position)
+		{
+			if((int32_t)(pItem->sequence - Position) < 0)
+			{
+				/* ISRs of different priorities may drop concurrently */
+				__atomic_fetch_add(&(gWorkQueue.dropped), 1U, __ATOMIC_RELAXED);
+				return WORKQUEUE_FULL;
+			}
+
+			/* Another producer took this position, retry with the updated head */
+			Position = gWorkQueue.head;
+		}
+
+		/* The slot is free, try to take it. On failure Position is updated to the current head */
+		else if(__atomic_compare_exchange_n(&(gWorkQueue.head), &Position, Position + 1U, 0,
+		                                    __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+		{
+			break;
+		}
+	}
+
+	/* Fill the slot and commit it to the work task */
+	pItem->handler = Handler;
+	pItem->arg = Arg;
+	__atomic_store_n(&(pItem->sequence), Position + 1U, __ATOMIC_RELEASE);
+
+	/* Wake up the work task, it is placed at the front of the ready queue */
+	Task_Unblock(pWorkQueueTask);
+
+	return WORKQUEUE_OK;
+}
+
+/**
+  * @brief  Pops a committed work item from the work queue.
+  * @param  pItem - Pointer to a WorkItem_t structure the work item is copied to.
+  * @retval 1 if a work item was popped, 0 if the queue is empty.
+  */
+static uint8_t WorkQueue_Pop(WorkItem_t *pItem)
+{
+	WorkItem_t *pSlot = &(gWorkQueue.items[gWorkQueue.tail & WORKQUEUE_MASK]);
+
+	/* The slot at the tail wasn't committed yet */
+	if(__atomic_load_n(&(pSlot->sequence), __ATOMIC_ACQUIRE) != (gWorkQueue.tail + 1U))
+	{
+		return 0;
+	}
+
+	pItem->handler = pSlot->handler;
+	pItem->arg = pSlot->arg;
+
+	/* Free the slot for the producers that reach it on the next round */
+	__atomic_store_n(&(pSlot->sequence), gWorkQueue.tail + WORKQUEUE_SIZE, __ATOMIC_RELEASE);
+	gWorkQueue.tail++;
+
+	return 1;
+}
+
+/**
+  * @brief  Handler of the work task. Executes posted work items in batches of up to
+  * 		WORKQUEUE_BATCH_SIZE, yields between full batches so the other ready tasks get to run,
+  * 		and blocks once the queue is empty.
+  * @param  None
+  * @retval None
+  */
+void WorkQueue_Task_Handler(void)
+{
+	WorkItem_t Item;
+	uint32_t Count;
+
+	while(1)
+	{
+		/* Execute a batch of work items */
+		Count = 0;
+		while((Count < WORKQUEUE_BATCH_SIZE) && WorkQueue_Pop(&Item))
+		{
+			Item.handler(Item.arg);
+			Count++;
+		}
+
+		if(Count != 0)
+		{
+			gWorkQueue.processed += Count;
+			gWorkQueue.batches++;
+		}
+
+		/* The batch is full, more work items may be pending. Let the other ready tasks run first */
+		if(Count == WORKQUEUE_BATCH_SIZE)
+		{
+			Task_Yield();
+			continue;
+		}
+
+		/* Check the queue and block with interrupts disabled, so a work item posted in between
+		 * isn't missed */
+		INTERRUPT_DISABLE();
+		if(__atomic_load_n(&(gWorkQueue.items[gWorkQueue.tail & WORKQUEUE_MASK].sequence), __ATOMIC_ACQUIRE)
+				!= (gWorkQueue.tail + 1U))
+		{
+			/* The queue is drained, the next work item releases a new job */
+			Sched_Job_Complete(pWorkQueueTask);
+			Task_Block(TASK_BLOCK_FOREVER);
+		}
+		INTERRUPT_ENABLE();
+	}
+}
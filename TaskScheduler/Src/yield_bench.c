@@ -0,0 +1,133 @@
+/**
+ ******************************************************************************
+ * @file           : yield_bench.c
+ * @author         : Noam Yakar
+ * @brief          : This file contains the context-switch benchmark of the
+ *                   cooperative mode against the preemptive one. Two tasks
+ *                   yield to each other: the benchmark task measures round
+ *                   trips with DWT CYCCNT, then counts the yields completed in
+ *                   one second, the tick interrupts included. Build it with
+ *                   SCHED_COOPERATIVE set to 0 and to 1 and compare.
+ *                   Enabled by YIELD_BENCHMARK in task_config.h.
+ ******************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------- */
+
+#include "sched.h"
+
+#if (YIELD_BENCHMARK == 1)
+
+/* EDF doesn't switch between two tasks that yield to each other */
+_Static_assert(SCHED_POLICY == SCHED_POLICY_ROUND_ROBIN, "YIELD_BENCHMARK needs the round-robin policy");
+
+/* Types -------------------------------------------------------------------- */
+
+/* Round trip statistics */
+typedef struct
+{
+	uint32_t min;
+	uint32_t max;
+	uint32_t sum;
+	uint32_t count;
+} BenchStats_t;
+
+/* Global variables --------------------------------------------------------- */
+
+extern uint32_t gTickCount;
+
+/* The partner task yields back until the benchmark is done */
+static volatile uint8_t gYieldBenchRunning = 1;
+
+BenchStats_t gYieldRoundTripStats = {0xFFFFFFFFU, 0, 0, 0};
+uint32_t gYieldsPerSecond = 0;
+
+/* Functions definitions ---------------------------------------------------- */
+
+/**
+  * @brief  Adds a round trip sample to the statistics.
+  * @param  pStats - Pointer to the statistics.
+  * @param  Cycles - Round trip in core clock cycles.
+  * @retval None
+  */
+static void Bench_Record(BenchStats_t *pStats, uint32_t Cycles)
+{
+	if(Cycles < pStats->min)
+	{
+		pStats->min = Cycles;
+	}
+	if(Cycles > pStats->max)
+	{
+		pStats->max = Cycles;
+	}
+	pStats->sum += Cycles;
+	pStats->count++;
+}
+
+/**
+  * @brief  Handler of the benchmark task. Measures YIELD_BENCHMARK_ROUNDS round trips to the
+  * 		partner task, two context-switches each, then the yields completed in one second.
+  * 		Prints min/avg/max cycles per switch and the throughput.
+  * @note   The minimum is the bare switch cost. Rounds in which a third task ran or an interrupt
+  * 		fired make up the average and the maximum.
+  * @param  None
+  * @retval None
+  */
+void Yield_Benchmark_Task_Handler(void)
+{
+	uint32_t Start;
+	uint32_t End;
+	uint32_t Yields = 0;
+
+	Cycle_Counter_Init();
+
+	/* Switch cost */
+	for(uint32_t i = 0 ; i < YIELD_BENCHMARK_ROUNDS ; i++)
+	{
+		Start = *((volatile uint32_t*)DWT_CYCCNT);
+		Task_Yield();
+		Bench_Record(&gYieldRoundTripStats, *((volatile uint32_t*)DWT_CYCCNT) - Start);
+	}
+
+	/* Throughput, from a tick boundary */
+	Task_Delay(1);
+	End = gTickCount + TICK_HZ;
+	while((int32_t)(gTickCount - End) < 0)
+	{
+		Task_Yield();
+		Yields++;
+	}
+	gYieldsPerSecond = Yields;
+	gYieldBenchRunning = 0;
+
+	printf("%s mode, cycles per switch: min %lu avg %lu max %lu\n", (SCHED_COOPERATIVE == 1) ? "Cooperative" : "Preemptive",
+	       (unsigned long)(gYieldRoundTripStats.min / 2U),
+	       (unsigned long)(gYieldRoundTripStats.sum / (2U * gYieldRoundTripStats.count)),
+	       (unsigned long)(gYieldRoundTripStats.max / 2U));
+	printf("Yields per second: %lu, %lu switches\n", (unsigned long)gYieldsPerSecond, (unsigned long)(2U * gYieldsPerSecond));
+
+	while(1)
+	{
+		Task_Delay(DELAY_1S);
+	}
+}
+
+/**
+  * @brief  Handler of the partner task. Yields back to the benchmark task until it's done.
+  * @param  None
+  * @retval None
+  */
+void Yield_Partner_Task_Handler(void)
+{
+	while(gYieldBenchRunning)
+	{
+		Task_Yield();
+	}
+
+	while(1)
+	{
+		Task_Delay(DELAY_1S);
+	}
+}
+
+#endif /* YIELD_BENCHMARK */
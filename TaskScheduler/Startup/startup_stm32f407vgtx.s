@@ -27,6 +27,8 @@
 .fpu softvfp
 .thumb
 
+#include "boot.h"
+
 .global g_pfnVectors
 .global Default_Handler
 
@@ -42,6 +44,17 @@ defined in linker script */
 /* end address for the .bss section. defined in linker script */
 .word _ebss
 
+/* Stores the DWT cycle count at the end of a boot phase in gBootProfile, which is in .noinit and
+   isn't cleared by the .bss zeroing. Clobbers r0 and r1 */
+.macro BOOT_TIMESTAMP Phase
+#if (BOOT_PROFILE == 1)
+  ldr   r0, =0xE0001004 /* DWT_CYCCNT */
+  ldr   r0, [r0]
+  ldr   r1, =gBootProfile
+  str   r0, [r1, #(4 * \Phase)]
+#endif
+.endm
+
 /**
  * @brief  This is the code that gets called when the processor first
  *          starts execution following a reset event. Only the absolutely
@@ -57,9 +70,91 @@ defined in linker script */
 Reset_Handler:
   ldr   r0, =_estack
   mov   sp, r0          /* set stack pointer */
+#if defined(__ARM_FP)
+/* Enable full access to the FPU coprocessors CP10 and CP11 before any FP instruction */
+  ldr   r0, =0xE000ED88 /* CPACR */
+  ldr   r1, [r0]
+  orr   r1, r1, #(0xF << 20)
+  str   r1, [r0]
+  dsb
+  isb
+#endif
+#if (BOOT_PROFILE == 1)
+/* Start the DWT cycle counter, the boot phases are timestamped from here */
+  ldr   r0, =0xE000EDFC /* DEMCR */
+  ldr   r1, [r0]
+  orr   r1, r1, #(1 << 24) /* TRCENA */
+  str   r1, [r0]
+  ldr   r0, =0xE0001000 /* DWT_CTRL */
+  movs  r1, #0
+  str   r1, [r0, #4]    /* DWT_CYCCNT */
+  ldr   r1, [r0]
+  orr   r1, r1, #1      /* CYCCNTENA */
+  str   r1, [r0]
+#endif
 /* Call the clock system initialization function.*/
   bl  SystemInit
+  BOOT_TIMESTAMP BOOT_PHASE_SYSTEM_INIT
 
+#if (BOOT_FAST_START == 1)
+/* Copy the data segment initializers from flash to SRAM, 16 bytes at a time, then the remaining
+   words. The tasks' stacks are in .noinit, not in .data */
+  ldr r0, =_sdata
+  ldr r1, =_edata
+  ldr r2, =_sidata
+  subs r7, r1, r0
+  subs r7, r7, #16
+  blo CopyDataWords
+
+CopyDataBlock:
+  ldmia r2!, {r3, r4, r5, r6}
+  stmia r0!, {r3, r4, r5, r6}
+  subs r7, r7, #16
+  bhs CopyDataBlock
+
+CopyDataWords:
+  adds r7, r7, #16
+  b LoopCopyDataWords
+
+CopyDataWord:
+  ldr r3, [r2], #4
+  str r3, [r0], #4
+  subs r7, r7, #4
+
+LoopCopyDataWords:
+  cmp r7, #0
+  bne CopyDataWord
+  BOOT_TIMESTAMP BOOT_PHASE_DATA
+
+/* Zero fill the bss segment, 16 bytes at a time, then the remaining words */
+  ldr r2, =_sbss
+  ldr r7, =_ebss
+  subs r7, r7, r2
+  movs r3, #0
+  movs r4, #0
+  movs r5, #0
+  movs r6, #0
+  subs r7, r7, #16
+  blo FillZerobssWords
+
+FillZerobssBlock:
+  stmia r2!, {r3, r4, r5, r6}
+  subs r7, r7, #16
+  bhs FillZerobssBlock
+
+FillZerobssWords:
+  adds r7, r7, #16
+  b LoopFillZerobssWords
+
+FillZerobssWord:
+  str r3, [r2], #4
+  subs r7, r7, #4
+
+LoopFillZerobssWords:
+  cmp r7, #0
+  bne FillZerobssWord
+  BOOT_TIMESTAMP BOOT_PHASE_BSS
+#else
 /* Copy the data segment initializers from flash to SRAM */
   ldr r0, =_sdata
   ldr r1, =_edata
@@ -76,6 +171,7 @@ LoopCopyDataInit:
   adds r4, r0, r3
   cmp r4, r1
   bcc CopyDataInit
+  BOOT_TIMESTAMP BOOT_PHASE_DATA
 
 /* Zero fill the bss segment. */
   ldr r2, =_sbss
@@ -90,9 +186,12 @@ FillZerobss:
 LoopFillZerobss:
   cmp r2, r4
   bcc FillZerobss
+  BOOT_TIMESTAMP BOOT_PHASE_BSS
+#endif /* BOOT_FAST_START */
 
 /* Call static constructors */
   bl __libc_init_array
+  BOOT_TIMESTAMP BOOT_PHASE_LIBC_INIT
 /* Call the application's entry point.*/
   bl main
 
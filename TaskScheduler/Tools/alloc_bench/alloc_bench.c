@@ -0,0 +1,235 @@
+/**
+ ******************************************************************************
+ * @file           : alloc_bench.c
+ * @author         : Noam Yakar
+ * @brief          : Host benchmark of the allocators. Runs the same random
+ *                   allocate/release sequences through the fixed-block pools,
+ *                   the TLSF allocator and the host's malloc, and prints the
+ *                   average, 99th percentile and worst-case time of an
+ *                   operation as CSV. Every block is filled with a pattern that
+ *                   is verified on release, so overlapping blocks are reported.
+ *
+ *                   Build and run on the host, from this directory:
+ *                   gcc -O2 -DTLSF_MALLOC=0 -I../../Inc alloc_bench.c ../../Src/mempool.c ../../Src/tlsf.c -o alloc_bench
+ *                   ./alloc_bench > alloc_times.csv
+ ******************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------- */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "mempool.h"
+#include "tlsf.h"
+
+/* Macros ------------------------------------------------------------------- */
+
+#define BENCH_OPERATIONS         1000000U  /* Allocate/release operations per run */
+#define BENCH_SLOTS              512U      /* Maximum number of live blocks */
+#define BENCH_FIXED_SIZE         64U       /* Block size of the fixed-size workload */
+#define BENCH_MIN_SIZE           8U        /* Smallest block of the variable-size workload */
+#define BENCH_MAX_SIZE           2048U     /* Largest block of the variable-size workload */
+#define BENCH_HEAP_SIZE          (1024U * 1024U)
+#define BENCH_HISTOGRAM_NS       100000U   /* Operations slower than this are counted in the last bucket */
+
+/* Types -------------------------------------------------------------------- */
+
+/* Allocator under test */
+typedef enum
+{
+	BENCH_MEMPOOL,
+	BENCH_TLSF,
+	BENCH_MALLOC
+} BenchAllocator_e;
+
+/* A live block */
+typedef struct
+{
+	uint8_t *block;
+	uint32_t size;
+	uint8_t pattern;
+} BenchSlot_t;
+
+/* Operation time statistics */
+typedef struct
+{
+	uint64_t sum;
+	uint64_t max;
+	uint64_t count;
+	uint32_t failures;
+	uint32_t corruptions;
+} BenchStats_t;
+
+/* Global variables --------------------------------------------------------- */
+
+MEMPOOL_STORAGE(gPoolStorage, BENCH_FIXED_SIZE, BENCH_SLOTS);
+static MemPool_t gPool;
+static Tlsf_t gTlsf;
+static uint64_t gHeapMemory[BENCH_HEAP_SIZE / sizeof(uint64_t)];
+static BenchSlot_t gSlots[BENCH_SLOTS];
+static uint32_t gHistogram[BENCH_HISTOGRAM_NS + 1U];
+static uint32_t gRandomState;
+
+/* Functions definitions ---------------------------------------------------- */
+
+/**
+  * @brief  Xorshift pseudo random generator, so every allocator sees the same sequence.
+  * @param  None
+  * @retval Random number.
+  */
+static uint32_t Bench_Random(void)
+{
+	gRandomState ^= gRandomState << 13;
+	gRandomState ^= gRandomState >> 17;
+	gRandomState ^= gRandomState << 5;
+	return gRandomState;
+}
+
+static uint64_t Bench_Now_Ns(void)
+{
+	struct timespec Now;
+
+	clock_gettime(CLOCK_MONOTONIC, &Now);
+	return ((uint64_t)Now.tv_sec * 1000000000U) + (uint64_t)Now.tv_nsec;
+}
+
+static void Bench_Record(BenchStats_t *pStats, uint64_t Ns)
+{
+	pStats->sum += Ns;
+	pStats->count++;
+	if(Ns > pStats->max)
+	{
+		pStats->max = Ns;
+	}
+	gHistogram[(Ns < BENCH_HISTOGRAM_NS) ? Ns : BENCH_HISTOGRAM_NS]++;
+}
+
+static uint64_t Bench_Percentile(const BenchStats_t *pStats, double Fraction)
+{
+	uint64_t Target = (uint64_t)((double)pStats->count * Fraction);
+	uint64_t Seen = 0;
+
+	for(uint32_t Ns = 0 ; Ns <= BENCH_HISTOGRAM_NS ; Ns++)
+	{
+		Seen += gHistogram[Ns];
+		if(Seen >= Target)
+		{
+			return Ns;
+		}
+	}
+	return BENCH_HISTOGRAM_NS;
+}
+
+static void *Bench_Alloc(BenchAllocator_e Allocator, uint32_t Size)
+{
+	switch(Allocator)
+	{
+		case BENCH_MEMPOOL: return MemPool_Alloc(&gPool);
+		case BENCH_TLSF:    return Tlsf_Malloc(&gTlsf, Size);
+		default:            return malloc(Size);
+	}
+}
+
+static void Bench_Free(BenchAllocator_e Allocator, void *pBlock)
+{
+	switch(Allocator)
+	{
+		case BENCH_MEMPOOL: MemPool_Free(&gPool, pBlock); break;
+		case BENCH_TLSF:    Tlsf_Free(&gTlsf, pBlock); break;
+		default:            free(pBlock); break;
+	}
+}
+
+/**
+  * @brief  Runs BENCH_OPERATIONS random operations: a random slot is released if it holds a
+  * 		block, and allocated otherwise.
+  * @param  Allocator - The allocator under test.
+  * @param  Variable - 1 for random sizes in [BENCH_MIN_SIZE, BENCH_MAX_SIZE], 0 for BENCH_FIXED_SIZE.
+  * @param  pStats - Receives the statistics.
+  * @retval None
+  */
+static void Bench_Run(BenchAllocator_e Allocator, uint8_t Variable, BenchStats_t *pStats)
+{
+	memset(pStats, 0, sizeof(BenchStats_t));
+	memset(gHistogram, 0, sizeof(gHistogram));
+	memset(gSlots, 0, sizeof(gSlots));
+	gRandomState = 0x12345678U;
+	MemPool_Init(&gPool, gPoolStorage, BENCH_FIXED_SIZE, BENCH_SLOTS);
+	Tlsf_Init(&gTlsf, gHeapMemory, sizeof(gHeapMemory));
+
+	for(uint32_t i = 0 ; i < BENCH_OPERATIONS ; i++)
+	{
+		BenchSlot_t *pSlot = &gSlots[Bench_Random() % BENCH_SLOTS];
+		uint64_t Start;
+
+		if(pSlot->block != NULL)
+		{
+			for(uint32_t b = 0 ; b < pSlot->size ; b++)
+			{
+				if(pSlot->block[b] != pSlot->pattern)
+				{
+					pStats->corruptions++;
+					break;
+				}
+			}
+			Start = Bench_Now_Ns();
+			Bench_Free(Allocator, pSlot->block);
+			Bench_Record(pStats, Bench_Now_Ns() - Start);
+			pSlot->block = NULL;
+		}
+		else
+		{
+			uint32_t Size = Variable ? (BENCH_MIN_SIZE + (Bench_Random() % (BENCH_MAX_SIZE - BENCH_MIN_SIZE + 1U))) : BENCH_FIXED_SIZE;
+
+			Start = Bench_Now_Ns();
+			pSlot->block = Bench_Alloc(Allocator, Size);
+			Bench_Record(pStats, Bench_Now_Ns() - Start);
+			if(pSlot->block == NULL)
+			{
+				pStats->failures++;
+				continue;
+			}
+			pSlot->size = Size;
+			pSlot->pattern = (uint8_t)i;
+			memset(pSlot->block, pSlot->pattern, Size);
+		}
+	}
+
+	for(uint32_t s = 0 ; s < BENCH_SLOTS ; s++)
+	{
+		if(gSlots[s].block != NULL)
+		{
+			Bench_Free(Allocator, gSlots[s].block);
+		}
+	}
+}
+
+static void Bench_Print(const char *pAllocator, const char *pWorkload, BenchStats_t *pStats)
+{
+	printf("%s,%s,%llu,%.1f,%llu,%llu,%u,%u\n", pAllocator, pWorkload, (unsigned long long)pStats->count,
+	       (double)pStats->sum / (double)pStats->count, (unsigned long long)Bench_Percentile(pStats, 0.99),
+	       (unsigned long long)pStats->max, pStats->failures, pStats->corruptions);
+}
+
+int main(void)
+{
+	BenchStats_t Stats;
+
+	printf("allocator,workload,operations,avg_ns,p99_ns,max_ns,failures,corruptions\n");
+
+	Bench_Run(BENCH_MEMPOOL, 0, &Stats);
+	Bench_Print("mempool", "fixed", &Stats);
+	Bench_Run(BENCH_TLSF, 0, &Stats);
+	Bench_Print("tlsf", "fixed", &Stats);
+	Bench_Run(BENCH_MALLOC, 0, &Stats);
+	Bench_Print("malloc", "fixed", &Stats);
+
+	Bench_Run(BENCH_TLSF, 1, &Stats);
+	Bench_Print("tlsf", "variable", &Stats);
+	printf("# tlsf heap %zu bytes, peak %zu bytes\n", gTlsf.total, gTlsf.peak);
+	Bench_Run(BENCH_MALLOC, 1, &Stats);
+	Bench_Print("malloc", "variable", &Stats);
+
+	return 0;
+}
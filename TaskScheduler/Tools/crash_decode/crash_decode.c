@@ -0,0 +1,496 @@
+/**
+ ******************************************************************************
+ * @file           : crash_decode.c
+ * @author         : Noam Yakar
+ * @brief          : Host decoder of the crash record captured on the target by
+ *                   crash.c. Reads the record from the console log of the boot
+ *                   that reported it (the CRASH: line), or from a binary dump,
+ *                   checks it, and prints the fault, the decoded fault status
+ *                   registers, the stacked registers with the PC and the LR
+ *                   resolved to functions of the ELF, the task that crashed and
+ *                   the latest scheduler events.
+ *
+ *                   Dump the record with GDB, before it's reported:
+ *                   dump binary value crash.bin gCrashRecord
+ *                   Build and run on the host, from this directory, with the
+ *                   tasks table of the crashed image:
+ *                   gcc -O2 -I../../Inc crash_decode.c -o crash_decode
+ *                   ./crash_decode TaskScheduler.elf console.log|crash.bin
+ ******************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------- */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <elf.h>
+#include "crash.h"
+
+/* Macros ------------------------------------------------------------------- */
+
+#define DECODE_OK                0
+#define DECODE_INVALID           1
+
+/* Maximum length of a console log line */
+#define DECODE_LINE_SIZE         4096U
+
+/* Types -------------------------------------------------------------------- */
+
+/* Function symbol of the ELF */
+typedef struct
+{
+	uint32_t address;
+	uint32_t size;
+	const char *name;
+} Symbol_t;
+
+/* Named bit of a fault status register */
+typedef struct
+{
+	uint32_t bit;
+	const char *name;
+	const char *description;
+} FaultBit_t;
+
+/* Global variables --------------------------------------------------------- */
+
+static CrashRecord_t gRecord;
+
+static Symbol_t *gSymbols = NULL;
+static uint32_t gSymbolCount = 0;
+static char *gStrings = NULL;
+
+/* Static tasks names, from the tasks table */
+#define TASK_NAME(Id, Entry, StackSize, Deadline)  [Id] = #Id,
+static const char *gTaskNames[NUMBER_OF_STATIC_TASKS] =
+{
+	TASK_TABLE(TASK_NAME)
+};
+
+static const char *gExceptionNames[] =
+{
+	[3] = "HardFault",
+	[4] = "MemManage",
+	[5] = "BusFault",
+	[6] = "UsageFault",
+};
+
+static const char *gRecordTypeNames[] =
+{
+	[RECORD_SCHEDULE]            = "schedule",
+	[RECORD_DELAY]               = "delay",
+	[RECORD_BLOCK]               = "block",
+	[RECORD_WAKEUP]              = "wakeup",
+	[RECORD_THROTTLE]            = "throttle",
+	[RECORD_EXIT]                = "exit",
+	[RECORD_CHECKPOINT]          = "checkpoint",
+	[RECORD_CHECKPOINT_TASK]     = "checkpoint task",
+	[RECORD_CHECKPOINT_STATE]    = "checkpoint state",
+	[RECORD_CHECKPOINT_DEADLINE] = "checkpoint deadline",
+};
+
+/* CFSR bits: MMFSR (0-7), BFSR (8-15), UFSR (16-31) */
+static const FaultBit_t gCfsrBits[] =
+{
+	{ 0, "IACCVIOL",    "instruction fetch from a no-execute or protected region"},
+	{ 1, "DACCVIOL",    "data access to a protected region, address in MMFAR"},
+	{ 3, "MUNSTKERR",   "MemManage fault on exception return unstacking"},
+	{ 4, "MSTKERR",     "MemManage fault on exception entry stacking, stack overflow?"},
+	{ 5, "MLSPERR",     "MemManage fault on lazy FPU state preservation"},
+	{ 7, "MMARVALID",   "MMFAR holds the faulting address"},
+	{ 8, "IBUSERR",     "bus error on instruction fetch"},
+	{ 9, "PRECISERR",   "precise data bus error, address in BFAR"},
+	{10, "IMPRECISERR", "imprecise data bus error, the PC is past the faulting store"},
+	{11, "UNSTKERR",    "bus error on exception return unstacking"},
+	{12, "STKERR",      "bus error on exception entry stacking, stack overflow?"},
+	{13, "LSPERR",      "bus error on lazy FPU state preservation"},
+	{15, "BFARVALID",   "BFAR holds the faulting address"},
+	{16, "UNDEFINSTR",  "undefined instruction"},
+	{17, "INVSTATE",    "invalid EPSR state, branch to an even (ARM) address?"},
+	{18, "INVPC",       "invalid EXC_RETURN on exception return, corrupted stack or LR?"},
+	{19, "NOCP",        "coprocessor access, FPU not enabled?"},
+	{24, "UNALIGNED",   "unaligned access"},
+	{25, "DIVBYZERO",   "division by zero"},
+};
+
+static const FaultBit_t gHfsrBits[] =
+{
+	{ 1, "VECTTBL",     "bus error on vector table read"},
+	{30, "FORCED",      "escalated configurable fault, see CFSR"},
+	{31, "DEBUGEVT",    "debug event"},
+};
+
+/* Functions definitions ---------------------------------------------------- */
+
+/**
+  * @brief  Computes the checksum of a crash record, as crash.c does.
+  * @param  pRecord - Pointer to the crash record.
+  * @retval The checksum.
+  */
+static uint32_t Decode_Checksum(const CrashRecord_t *pRecord)
+{
+	const uint32_t *pWord = (const uint32_t*)pRecord;
+	uint32_t Sum = 0;
+
+	for(uint32_t i = 0 ; i < (offsetof(CrashRecord_t, checksum) / sizeof(uint32_t)) ; i++)
+	{
+		Sum += pWord[i];
+	}
+
+	return ~Sum;
+}
+
+/**
+  * @brief  Reads the crash record from a binary dump of gCrashRecord, or from the CRASH: line of a
+  * 		console log.
+  * @param  pPath - Path of the dump or of the log.
+  * @retval 1 if a record was read, 0 otherwise.
+  */
+static int Decode_Read_Record(const char *pPath)
+{
+	FILE *pFile = fopen(pPath, "rb");
+	char *pLine;
+	int Found = 0;
+
+	if(pFile == NULL)
+	{
+		printf("Can't open %s\n", pPath);
+		return 0;
+	}
+
+	/* A binary dump starts with the magic */
+	if((fread(&gRecord, 1, sizeof(gRecord), pFile) == sizeof(gRecord)) && (gRecord.magic == CRASH_MAGIC))
+	{
+		fclose(pFile);
+		return 1;
+	}
+
+	/* The last CRASH: line of the log */
+	rewind(pFile);
+	pLine = malloc(DECODE_LINE_SIZE);
+	while((pLine != NULL) && (fgets(pLine, DECODE_LINE_SIZE, pFile) != NULL))
+	{
+		char *pWords = strstr(pLine, CRASH_LINE_PREFIX);
+		uint32_t *pRecordWords = (uint32_t*)&gRecord;
+		uint32_t Count = 0;
+
+		if(pWords == NULL)
+		{
+			continue;
+		}
+		pWords += strlen(CRASH_LINE_PREFIX);
+
+		while(Count < (sizeof(gRecord) / sizeof(uint32_t)))
+		{
+			char *pEnd;
+			unsigned long Word = strtoul(pWords, &pEnd, 16);
+
+			if(pEnd == pWords)
+			{
+				break;
+			}
+			pRecordWords[Count++] = (uint32_t)Word;
+			pWords = pEnd;
+		}
+		Found = (Count == (sizeof(gRecord) / sizeof(uint32_t)));
+	}
+
+	free(pLine);
+	fclose(pFile);
+
+	if(!Found)
+	{
+		printf("%s holds no crash record\n", pPath);
+	}
+
+	return Found;
+}
+
+/**
+  * @brief  Compares two symbols by address, for qsort().
+  * @param  pA - Pointer to the first symbol.
+  * @param  pB - Pointer to the second symbol.
+  * @retval <0, 0 or >0.
+  */
+static int Decode_Symbol_Compare(const void *pA, const void *pB)
+{
+	uint32_t A = ((const Symbol_t*)pA)->address;
+	uint32_t B = ((const Symbol_t*)pB)->address;
+
+	return (A > B) - (A < B);
+}
+
+/**
+  * @brief  Loads the function symbols of a 32-bit little-endian ELF.
+  * @param  pPath - Path of the ELF.
+  * @retval 1 if the symbols were loaded, 0 otherwise.
+  */
+static int Decode_Load_Symbols(const char *pPath)
+{
+	FILE *pFile = fopen(pPath, "rb");
+	Elf32_Ehdr Header;
+	Elf32_Shdr *pSections = NULL;
+	Elf32_Sym *pSymbols = NULL;
+	int Loaded = 0;
+
+	if(pFile == NULL)
+	{
+		printf("Can't open %s\n", pPath);
+		return 0;
+	}
+
+	if((fread(&Header, 1, sizeof(Header), pFile) != sizeof(Header)) ||
+	   (memcmp(Header.e_ident, ELFMAG, SELFMAG) != 0) || (Header.e_ident[EI_CLASS] != ELFCLASS32) ||
+	   (Header.e_shentsize != sizeof(Elf32_Shdr)))
+	{
+		printf("%s is not a 32-bit ELF\n", pPath);
+		fclose(pFile);
+		return 0;
+	}
+
+	pSections = calloc(Header.e_shnum, sizeof(Elf32_Shdr));
+	if((pSections == NULL) || (fseek(pFile, (long)Header.e_shoff, SEEK_SET) != 0) ||
+	   (fread(pSections, sizeof(Elf32_Shdr), Header.e_shnum, pFile) != Header.e_shnum))
+	{
+		printf("Can't read the sections of %s\n", pPath);
+		goto Done;
+	}
+
+	for(uint32_t i = 0 ; i < Header.e_shnum ; i++)
+	{
+		Elf32_Shdr *pSymtab = &pSections[i];
+		Elf32_Shdr *pStrtab;
+		uint32_t Count;
+
+		if((pSymtab->sh_type != SHT_SYMTAB) || (pSymtab->sh_link >= Header.e_shnum))
+		{
+			continue;
+		}
+		pStrtab = &pSections[pSymtab->sh_link];
+		Count = pSymtab->sh_size / sizeof(Elf32_Sym);
+
+		pSymbols = malloc(pSymtab->sh_size);
+		gStrings = malloc(pStrtab->sh_size);
+		gSymbols = calloc(Count, sizeof(Symbol_t));
+		if((pSymbols == NULL) || (gStrings == NULL) || (gSymbols == NULL) ||
+		   (fseek(pFile, (long)pSymtab->sh_offset, SEEK_SET) != 0) ||
+		   (fread(pSymbols, sizeof(Elf32_Sym), Count, pFile) != Count) ||
+		   (fseek(pFile, (long)pStrtab->sh_offset, SEEK_SET) != 0) ||
+		   (fread(gStrings, 1, pStrtab->sh_size, pFile) != pStrtab->sh_size))
+		{
+			printf("Can't read the symbols of %s\n", pPath);
+			goto Done;
+		}
+
+		for(uint32_t j = 0 ; j < Count ; j++)
+		{
+			if((ELF32_ST_TYPE(pSymbols[j].st_info) == STT_FUNC) && (pSymbols[j].st_name < pStrtab->sh_size))
+			{
+				/* Clear the Thumb bit */
+				gSymbols[gSymbolCount].address = pSymbols[j].st_value & ~1U;
+				gSymbols[gSymbolCount].size = pSymbols[j].st_size;
+				gSymbols[gSymbolCount].name = &gStrings[pSymbols[j].st_name];
+				gSymbolCount++;
+			}
+		}
+		qsort(gSymbols, gSymbolCount, sizeof(Symbol_t), Decode_Symbol_Compare);
+		Loaded = 1;
+		break;
+	}
+
+	if(!Loaded && (gSymbols == NULL))
+	{
+		printf("%s has no symbol table\n", pPath);
+	}
+
+Done:
+	free(pSections);
+	free(pSymbols);
+	fclose(pFile);
+
+	return Loaded;
+}
+
+/**
+  * @brief  Formats an address as function+offset.
+  * @param  Address - The code address.
+  * @param  pBuffer - Pointer to the output buffer.
+  * @param  Size - Size of the output buffer.
+  * @retval pBuffer.
+  */
+static const char* Decode_Symbolize(uint32_t Address, char *pBuffer, size_t Size)
+{
+	uint32_t Code = Address & ~1U;
+	Symbol_t *pFound = NULL;
+
+	for(uint32_t i = 0 ; (i < gSymbolCount) && (gSymbols[i].address <= Code) ; i++)
+	{
+		if(Code < (gSymbols[i].address + ((gSymbols[i].size != 0U) ? gSymbols[i].size : 1U)))
+		{
+			pFound = &gSymbols[i];
+		}
+	}
+
+	if(pFound != NULL)
+	{
+		snprintf(pBuffer, Size, "%s+0x%x", pFound->name, (unsigned)(Code - pFound->address));
+	}
+	else
+	{
+		snprintf(pBuffer, Size, "?");
+	}
+
+	return pBuffer;
+}
+
+/**
+  * @brief  Prints the set bits of a fault status register.
+  * @param  pRegister - The register's name.
+  * @param  Value - The register's value.
+  * @param  pBits - Pointer to the register's named bits.
+  * @param  Count - Number of named bits.
+  * @retval None
+  */
+static void Decode_Print_Bits(const char *pRegister, uint32_t Value, const FaultBit_t *pBits, uint32_t Count)
+{
+	printf("%-6s 0x%08x\n", pRegister, (unsigned)Value);
+	for(uint32_t i = 0 ; i < Count ; i++)
+	{
+		if(Value & (1U << pBits[i].bit))
+		{
+			printf("       %-11s %s\n", pBits[i].name, pBits[i].description);
+		}
+	}
+}
+
+/**
+  * @brief  Returns the name of a task ID.
+  * @param  TaskId - The task ID.
+  * @retval The name.
+  */
+static const char* Decode_Task_Name(uint32_t TaskId)
+{
+	if(TaskId < NUMBER_OF_STATIC_TASKS)
+	{
+		return gTaskNames[TaskId];
+	}
+	if(TaskId == DYNAMIC_TASK)
+	{
+		return "DYNAMIC_TASK";
+	}
+	if(TaskId == RECORD_NO_TASK)
+	{
+		return "none";
+	}
+
+	return "?";
+}
+
+/**
+  * @brief  Prints the decoded crash record.
+  * @param  pElf - Path of the ELF, for the addr2line hint.
+  * @retval None
+  */
+static void Decode_Print(const char *pElf)
+{
+	static const char *pRegisterNames[CRASH_FRAME_WORDS] = {"R0", "R1", "R2", "R3", "R12", "LR", "PC", "xPSR"};
+	const char *pException = "Fault";
+	char Symbol[128];
+
+	if((gRecord.exception < (sizeof(gExceptionNames) / sizeof(gExceptionNames[0]))) &&
+	   (gExceptionNames[gRecord.exception] != NULL))
+	{
+		pException = gExceptionNames[gRecord.exception];
+	}
+
+	printf("%s in %s (task %u) at tick %u\n", pException, Decode_Task_Name(gRecord.task_id),
+	       (unsigned)gRecord.task_id, (unsigned)gRecord.tick);
+	printf("Frame on the %s, SP before the fault 0x%08x, EXC_RETURN 0x%08x%s\n",
+	       (gRecord.exc_return & (1U << 2)) ? "PSP" : "MSP", (unsigned)gRecord.sp, (unsigned)gRecord.exc_return,
+	       (gRecord.exc_return & (1U << 4)) ? "" : ", extended FPU frame");
+	printf("\n");
+
+	if(gRecord.cfsr & CRASH_CFSR_STACKING)
+	{
+		printf("The exception frame couldn't be stacked, no registers\n");
+	}
+	else
+	{
+		for(uint32_t i = 0 ; i < CRASH_FRAME_WORDS ; i++)
+		{
+			printf("%-6s 0x%08x", pRegisterNames[i], (unsigned)gRecord.frame[i]);
+			if((i == CRASH_FRAME_PC) || (i == CRASH_FRAME_LR))
+			{
+				printf("  %s", Decode_Symbolize(gRecord.frame[i], Symbol, sizeof(Symbol)));
+			}
+			printf("\n");
+		}
+	}
+	printf("\n");
+
+	Decode_Print_Bits("CFSR", gRecord.cfsr, gCfsrBits, sizeof(gCfsrBits) / sizeof(gCfsrBits[0]));
+	Decode_Print_Bits("HFSR", gRecord.hfsr, gHfsrBits, sizeof(gHfsrBits) / sizeof(gHfsrBits[0]));
+	if(gRecord.cfsr & (1U << 7))
+	{
+		printf("MMFAR  0x%08x\n", (unsigned)gRecord.mmfar);
+	}
+	if(gRecord.cfsr & (1U << 15))
+	{
+		printf("BFAR   0x%08x\n", (unsigned)gRecord.bfar);
+	}
+	printf("\n");
+
+	printf("Latest scheduler events, oldest first:\n");
+	if(gRecord.trace_count == 0U)
+	{
+		printf("  none, the recorder is compiled out (RECORD_ENABLE)\n");
+	}
+	for(uint32_t i = 0 ; (i < gRecord.trace_count) && (i < CRASH_TRACE_SIZE) ; i++)
+	{
+		RecordEntry_t *pEntry = &gRecord.trace[i];
+		const char *pType = "?";
+
+		if((pEntry->type < (sizeof(gRecordTypeNames) / sizeof(gRecordTypeNames[0]))) &&
+		   (gRecordTypeNames[pEntry->type] != NULL))
+		{
+			pType = gRecordTypeNames[pEntry->type];
+		}
+		printf("  tick %8u  %-19s %-14s aux %5u  arg %u\n", (unsigned)pEntry->tick, pType,
+		       Decode_Task_Name(pEntry->task_id), (unsigned)pEntry->aux, (unsigned)pEntry->arg);
+	}
+
+	if(!(gRecord.cfsr & CRASH_CFSR_STACKING))
+	{
+		printf("\nSource lines: addr2line -f -e %s 0x%08x 0x%08x\n", pElf,
+		       (unsigned)(gRecord.frame[CRASH_FRAME_PC] & ~1U), (unsigned)(gRecord.frame[CRASH_FRAME_LR] & ~1U));
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	if(argc < 3)
+	{
+		printf("Usage: %s TaskScheduler.elf console.log|crash.bin\n", argv[0]);
+		return DECODE_INVALID;
+	}
+
+	if(!Decode_Read_Record(argv[2]))
+	{
+		return DECODE_INVALID;
+	}
+
+	if((gRecord.magic != CRASH_MAGIC) || (gRecord.size != sizeof(CrashRecord_t)) ||
+	   (gRecord.checksum != Decode_Checksum(&gRecord)))
+	{
+		printf("The crash record is corrupted, or from an image with a different CrashRecord_t\n");
+		return DECODE_INVALID;
+	}
+
+	/* The record is decoded without symbols if the ELF can't be read */
+	Decode_Load_Symbols(argv[1]);
+
+	Decode_Print(argv[1]);
+
+	return DECODE_OK;
+}
@@ -0,0 +1,159 @@
+/**
+ ******************************************************************************
+ * @file           : sched_host.h
+ * @author         : Noam Yakar
+ * @brief          : Host harness of the scheduler core, shared by the host
+ *                   tools that link Src/sched.c and Src/queue.c: the kernel
+ *                   objects normally allocated in main.c, stubs of the target
+ *                   only functions the core calls, a reproducible random
+ *                   generator, and the random task set generator.
+ *
+ *                   Defines objects and functions, included by one file of
+ *                   each tool, after sched.h and record.h.
+ ******************************************************************************
+*/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+
+#ifndef SCHED_HOST_H_
+#define SCHED_HOST_H_
+
+/* Includes ----------------------------------------------------------------- */
+
+#include <math.h>
+#include "sched.h"
+#include "record.h"
+
+/* Macros ------------------------------------------------------------------- */
+
+/* A generated task set's utilisation, with its WCETs rounded to whole ticks, is within this
+ * distance of the requested one */
+#define HOST_UTILISATION_TOLERANCE 0.005
+
+/* Task sets drawn before the generator gives up on the tolerance and keeps the last one */
+#define HOST_TASK_SET_ATTEMPTS   1000U
+
+/* Global variables --------------------------------------------------------- */
+
+/* Kernel objects, normally allocated in main.c */
+Queue_t gReadyQueue = {READY_QUEUE, NULL, Enqueue, Dequeue};
+Queue_t gBlockedQueue = {BLOCKED_QUEUE, NULL, Enqueue, Dequeue};
+TaskControlBlock_t *gpCurrentRunningTask = NULL;
+uint32_t gTickCount = 0;
+
+/* Set by a context-switch the core pended, a tool that calls Schedule() at every tick may
+ * ignore it */
+static uint8_t gHostSwitchPending = 0;
+
+/* State of the random generator, never 0 */
+static uint32_t gHostRandomState = 0x12345678U;
+
+/* Functions definitions ---------------------------------------------------- */
+
+/**
+  * @brief  A task that delays or blocks itself pends a context-switch, the tool calls Schedule()
+  * 		for it.
+  * @param  None
+  * @retval None
+  */
+void Pend_PendSV(void)
+{
+	gHostSwitchPending = 1;
+}
+
+/**
+  * @brief  The host tools don't record the scheduler's inputs.
+  * @param  Type - Unused.
+  * @param  TaskId - Unused.
+  * @param  Aux - Unused.
+  * @param  Arg - Unused.
+  * @retval None
+  */
+void Record_Event(RecordType_e Type, uint8_t TaskId, uint16_t Aux, uint32_t Arg)
+{
+	(void)Type;
+	(void)TaskId;
+	(void)Aux;
+	(void)Arg;
+}
+
+/**
+  * @brief  Seeds the random generator.
+  * @param  Seed - The seed, 0 is replaced by 1.
+  * @retval None
+  */
+static inline void Host_Seed(uint32_t Seed)
+{
+	gHostRandomState = (Seed != 0U) ? Seed : 1U;
+}
+
+/**
+  * @brief  Xorshift pseudo random generator, so the results are reproducible.
+  * @param  None
+  * @retval Uniform random number in [0,1).
+  */
+static inline double Host_Random(void)
+{
+	gHostRandomState ^= gHostRandomState << 13;
+	gHostRandomState ^= gHostRandomState >> 17;
+	gHostRandomState ^= gHostRandomState << 5;
+	return (double)gHostRandomState / 4294967296.0;
+}
+
+/**
+  * @brief  Generates a random task set with the given total utilisation (UUniFast), with
+  * 		log-uniform periods. The WCETs are rounded to whole ticks, at least 1, so the task set
+  * 		is drawn again until its utilisation is within HOST_UTILISATION_TOLERANCE of the
+  * 		requested one, HOST_TASK_SET_ATTEMPTS times at most.
+  * @param  Utilisation - Requested total utilisation.
+  * @param  Count - Number of tasks.
+  * @param  MinPeriod - Shortest period in ticks.
+  * @param  MaxPeriod - Longest period in ticks.
+  * @param  pPeriods - Pointer to the Count periods generated.
+  * @param  pWcets - Pointer to the Count WCETs generated.
+  * @retval The task set's utilisation, the sum of the WCETs over the periods.
+  */
+static inline double Host_Generate_Task_Set(double Utilisation, uint32_t Count, uint32_t MinPeriod, uint32_t MaxPeriod,
+                                            uint32_t *pPeriods, uint32_t *pWcets)
+{
+	double Realised = 0.0;
+
+	for(uint32_t Attempt = 0 ; Attempt < HOST_TASK_SET_ATTEMPTS ; Attempt++)
+	{
+		double SumU = Utilisation;
+
+		Realised = 0.0;
+		for(uint32_t i = 0 ; i < Count ; i++)
+		{
+			double TaskU;
+			if(i < (Count - 1U))
+			{
+				double NextSumU = SumU * pow(Host_Random(), 1.0 / (double)(Count - 1U - i));
+				TaskU = SumU - NextSumU;
+				SumU = NextSumU;
+			}
+			else
+			{
+				TaskU = SumU;
+			}
+
+			double Period = exp(log(MinPeriod) + (Host_Random() * (log(MaxPeriod) - log(MinPeriod))));
+			pPeriods[i] = (uint32_t)Period;
+			pWcets[i] = (uint32_t)lround(TaskU * pPeriods[i]);
+			if(pWcets[i] == 0U)
+			{
+				pWcets[i] = 1U;
+			}
+			Realised += (double)pWcets[i] / (double)pPeriods[i];
+		}
+
+		if(fabs(Realised - Utilisation) <= HOST_UTILISATION_TOLERANCE)
+		{
+			break;
+		}
+	}
+
+	return Realised;
+}
+
+#endif /* SCHED_HOST_H_ */
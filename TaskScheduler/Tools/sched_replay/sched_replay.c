@@ -0,0 +1,411 @@
+/**
+ ******************************************************************************
+ * @file           : sched_replay.c
+ * @author         : Noam Yakar
+ * @brief          : Host replay of a scheduling log recorded on the target by
+ *                   record.c. Restores the scheduler's state from the oldest
+ *                   complete checkpoint of the dump, then feeds the logged
+ *                   delays, blocks, wakeups, throttles, exits and ticks to the
+ *                   scheduler core (sched.c, queue.c) and checks that every
+ *                   Schedule() call finds the running task the target found,
+ *                   and that every later checkpoint matches the replayed state.
+ *                   Dynamic tasks (Task_Create) can't be replayed.
+ *
+ *                   Dump the log with GDB: dump binary value record.bin gRecordLog
+ *                   Build and run on the host, from this directory, with the
+ *                   SCHED_POLICY and tasks table of the recorded image:
+ *                   gcc -O2 -I../../Inc sched_replay.c ../../Src/sched.c ../../Src/queue.c -o sched_replay
+ *                   ./sched_replay record.bin [-v]
+ ******************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------- */
+
+#include <stdlib.h>
+#include <string.h>
+#include "sched.h"
+#include "record.h"
+#include "../sched_host/sched_host.h"
+
+/* Macros ------------------------------------------------------------------- */
+
+#define REPLAY_OK                0
+#define REPLAY_DIVERGED          1
+#define REPLAY_INVALID           2
+
+/* Global variables --------------------------------------------------------- */
+
+static TaskControlBlock_t gTaskTable[NUMBER_OF_STATIC_TASKS];
+static RecordLog_t gLog;
+static int gVerbose = 0;
+
+/* Functions definitions ---------------------------------------------------- */
+
+/**
+  * @brief  Returns the task a logged task ID refers to.
+  * @param  TaskId - Logged task ID.
+  * @retval Pointer to the task, NULL for RECORD_NO_TASK.
+  */
+static TaskControlBlock_t *Replay_Task(uint8_t TaskId)
+{
+	return (TaskId == RECORD_NO_TASK) ? NULL : &gTaskTable[TaskId];
+}
+
+/**
+  * @brief  Returns the logged task ID of a task.
+  * @param  pTask - Pointer to the task, can be NULL.
+  * @retval Task ID, RECORD_NO_TASK for NULL.
+  */
+static unsigned Replay_Id(const TaskControlBlock_t *pTask)
+{
+	return (pTask == NULL) ? RECORD_NO_TASK : (unsigned)pTask->task_id;
+}
+
+/**
+  * @brief  Returns a log entry.
+  * @param  Index - Index of the entry since boot.
+  * @retval Pointer to the entry.
+  */
+static const RecordEntry_t *Replay_Entry(uint32_t Index)
+{
+	return &(gLog.entries[Index & RECORD_MASK]);
+}
+
+/**
+  * @brief  Restores the scheduler's state from a checkpoint.
+  * @param  Index - Index of the checkpoint's first entry.
+  * @retval REPLAY_OK, or REPLAY_INVALID if the checkpoint has dynamic tasks in the ready
+  * 		structure or in the blocked queue.
+  */
+static int Replay_Restore(uint32_t Index)
+{
+	const RecordEntry_t *pCheckpoint = Replay_Entry(Index);
+	TaskControlBlock_t *pReady[NUMBER_OF_STATIC_TASKS] = {NULL};
+	TaskControlBlock_t *pBlocked[NUMBER_OF_STATIC_TASKS] = {NULL};
+	TaskControlBlock_t **pLink;
+
+	gTickCount = pCheckpoint->tick;
+	gpSchedPolicy = (pCheckpoint->aux == SCHED_POLICY_EDF) ? &gEdfPolicy : &gRoundRobinPolicy;
+	gReadyQueue.head = NULL;
+	gBlockedQueue.head = NULL;
+	gpSchedPolicy->INIT();
+	gpCurrentRunningTask = Replay_Task(pCheckpoint->task_id);
+
+	for(uint32_t i = 0 ; i < NUMBER_OF_STATIC_TASKS ; i++)
+	{
+		const RecordEntry_t *pTaskEntry = Replay_Entry(Index + 1U + (3U * i));
+		const RecordEntry_t *pStateEntry = Replay_Entry(Index + 2U + (3U * i));
+		const RecordEntry_t *pDeadlineEntry = Replay_Entry(Index + 3U + (3U * i));
+		uint8_t ReadyPosition = (uint8_t)(pTaskEntry->aux & 0xFFU);
+		uint8_t BlockedPosition = (uint8_t)(pTaskEntry->aux >> 8);
+		TaskControlBlock_t *pTask = &gTaskTable[i];
+
+		memset(pTask, 0, sizeof(*pTask));
+		pTask->task_id = (TaskID_e)i;
+		pTask->block_count = pTaskEntry->arg;
+		pTask->current_state = (TaskState_e)pStateEntry->aux;
+		pTask->relative_deadline = pStateEntry->arg;
+		pTask->absolute_deadline = pDeadlineEntry->arg;
+		pTask->job_done = (uint8_t)pDeadlineEntry->aux;
+
+		if(ReadyPosition != RECORD_NO_POSITION)
+		{
+			if((ReadyPosition >= NUMBER_OF_STATIC_TASKS) || (pReady[ReadyPosition] != NULL))
+			{
+				return REPLAY_INVALID;
+			}
+			pReady[ReadyPosition] = pTask;
+		}
+		if(BlockedPosition != RECORD_NO_POSITION)
+		{
+			if((BlockedPosition >= NUMBER_OF_STATIC_TASKS) || (pBlocked[BlockedPosition] != NULL))
+			{
+				return REPLAY_INVALID;
+			}
+			pBlocked[BlockedPosition] = pTask;
+		}
+	}
+
+	/* A gap in the positions is a dynamic task */
+	for(uint32_t i = 1 ; i < NUMBER_OF_STATIC_TASKS ; i++)
+	{
+		if(((pReady[i - 1U] == NULL) && (pReady[i] != NULL)) || ((pBlocked[i - 1U] == NULL) && (pBlocked[i] != NULL)))
+		{
+			return REPLAY_INVALID;
+		}
+	}
+
+	/* Rebuild the ready structure and the blocked queue in the logged order */
+	for(uint32_t i = 0 ; (i < NUMBER_OF_STATIC_TASKS) && (pReady[i] != NULL) ; i++)
+	{
+		gpSchedPolicy->READY(pReady[i], REGULAR_ENQUEUE);
+	}
+	pLink = &(gBlockedQueue.head);
+	for(uint32_t i = 0 ; (i < NUMBER_OF_STATIC_TASKS) && (pBlocked[i] != NULL) ; i++)
+	{
+		*pLink = pBlocked[i];
+		pLink = &(pBlocked[i]->next);
+	}
+	*pLink = NULL;
+
+	return REPLAY_OK;
+}
+
+/**
+  * @brief  Compares the replayed state with a checkpoint of the log.
+  * @param  Index - Index of the checkpoint's first entry.
+  * @retval REPLAY_OK, or REPLAY_DIVERGED if the states differ.
+  */
+static int Replay_Verify(uint32_t Index)
+{
+	const RecordEntry_t *pCheckpoint = Replay_Entry(Index);
+	TaskControlBlock_t *pReady[SCHED_MAX_TASKS];
+	uint32_t Count;
+	uint32_t Position;
+	TaskControlBlock_t *pTask;
+
+	if(Replay_Id(gpCurrentRunningTask) != pCheckpoint->task_id)
+	{
+		printf("Checkpoint at tick %u: running task %u, replayed %u\n", (unsigned)pCheckpoint->tick,
+		       (unsigned)pCheckpoint->task_id, Replay_Id(gpCurrentRunningTask));
+		return REPLAY_DIVERGED;
+	}
+
+	Count = Sched_Ready_Tasks(pReady, SCHED_MAX_TASKS);
+	for(uint32_t i = 0 ; i < NUMBER_OF_STATIC_TASKS ; i++)
+	{
+		const RecordEntry_t *pTaskEntry = Replay_Entry(Index + 1U + (3U * i));
+		const RecordEntry_t *pStateEntry = Replay_Entry(Index + 2U + (3U * i));
+		const RecordEntry_t *pDeadlineEntry = Replay_Entry(Index + 3U + (3U * i));
+		uint32_t ReadyPosition = RECORD_NO_POSITION;
+		uint32_t BlockedPosition = RECORD_NO_POSITION;
+
+		pTask = &gTaskTable[i];
+		for(uint32_t j = 0 ; j < Count ; j++)
+		{
+			if(pReady[j] == pTask)
+			{
+				ReadyPosition = j;
+			}
+		}
+		Position = 0;
+		for(TaskControlBlock_t *pIter = gBlockedQueue.head ; pIter != NULL ; pIter = pIter->next, Position++)
+		{
+			if(pIter == pTask)
+			{
+				BlockedPosition = Position;
+			}
+		}
+
+		if((pTask->current_state != (TaskState_e)pStateEntry->aux) ||
+		   (pTask->absolute_deadline != pDeadlineEntry->arg) ||
+		   (pTask->job_done != pDeadlineEntry->aux) ||
+		   (ReadyPosition != (pTaskEntry->aux & 0xFFU)) ||
+		   (BlockedPosition != (uint32_t)(pTaskEntry->aux >> 8)) ||
+		   ((BlockedPosition != RECORD_NO_POSITION) && (pTask->block_count != pTaskEntry->arg)))
+		{
+			printf("Checkpoint at tick %u: task %u differs (state %u/%u, ready position %u/%u, blocked position %u/%u)\n",
+			       (unsigned)pCheckpoint->tick, (unsigned)i, (unsigned)pStateEntry->aux, (unsigned)pTask->current_state,
+			       (unsigned)(pTaskEntry->aux & 0xFFU), (unsigned)ReadyPosition,
+			       (unsigned)(pTaskEntry->aux >> 8), (unsigned)BlockedPosition);
+			return REPLAY_DIVERGED;
+		}
+	}
+
+	return REPLAY_OK;
+}
+
+/**
+  * @brief  Checks that the replayed running task is the one the log entry was recorded in.
+  * @param  Index - Index of the entry.
+  * @param  pEntry - Pointer to the entry.
+  * @retval REPLAY_OK, or REPLAY_DIVERGED.
+  */
+static int Replay_Check_Running(uint32_t Index, const RecordEntry_t *pEntry)
+{
+	if(Replay_Id(gpCurrentRunningTask) != pEntry->task_id)
+	{
+		printf("Entry %u at tick %u (type %u): running task %u, replayed %u\n", (unsigned)Index,
+		       (unsigned)pEntry->tick, (unsigned)pEntry->type, (unsigned)pEntry->task_id,
+		       Replay_Id(gpCurrentRunningTask));
+		return REPLAY_DIVERGED;
+	}
+	return REPLAY_OK;
+}
+
+/**
+  * @brief  Replays the log from its oldest complete checkpoint.
+  * @param  None
+  * @retval REPLAY_OK, REPLAY_DIVERGED or REPLAY_INVALID.
+  */
+static int Replay_Run(void)
+{
+	uint32_t First = (gLog.head > RECORD_SIZE) ? (gLog.head - RECORD_SIZE) : 0U;
+	uint32_t Index;
+	uint32_t Schedules = 0;
+	uint32_t Switches = 0;
+	uint32_t Checkpoints = 0;
+	uint32_t StartTick;
+	TaskControlBlock_t *pPrevious;
+	int Status;
+
+	/* Find the oldest complete checkpoint */
+	for(Index = First ; Index < gLog.head ; Index++)
+	{
+		if((Replay_Entry(Index)->type == RECORD_CHECKPOINT) &&
+		   ((Index + (3U * NUMBER_OF_STATIC_TASKS)) < gLog.head))
+		{
+			break;
+		}
+	}
+	if(Index == gLog.head)
+	{
+		printf("No complete checkpoint in the log\n");
+		return REPLAY_INVALID;
+	}
+	if(Replay_Entry(Index)->arg != NUMBER_OF_STATIC_TASKS)
+	{
+		printf("The log has %u tasks, this build has %u\n", (unsigned)Replay_Entry(Index)->arg, (unsigned)NUMBER_OF_STATIC_TASKS);
+		return REPLAY_INVALID;
+	}
+	if(Replay_Restore(Index) != REPLAY_OK)
+	{
+		printf("The checkpoint at tick %u holds dynamic tasks\n", (unsigned)Replay_Entry(Index)->tick);
+		return REPLAY_INVALID;
+	}
+	StartTick = gTickCount;
+	Index += 1U + (3U * NUMBER_OF_STATIC_TASKS);
+
+	for( ; Index < gLog.head ; Index++)
+	{
+		const RecordEntry_t *pEntry = Replay_Entry(Index);
+
+		/* Run the ticks up to the entry, like SysTick_Handler() */
+		while((int32_t)(pEntry->tick - gTickCount) > 0)
+		{
+			Increment_Global_Tick_Count();
+			Unblock_Tasks();
+		}
+
+		if((pEntry->type < RECORD_CHECKPOINT) && (pEntry->task_id != RECORD_NO_TASK) &&
+		   (pEntry->task_id >= NUMBER_OF_STATIC_TASKS))
+		{
+			printf("Entry %u at tick %u refers to a dynamic task\n", (unsigned)Index, (unsigned)pEntry->tick);
+			return REPLAY_INVALID;
+		}
+
+		Status = REPLAY_OK;
+		switch(pEntry->type)
+		{
+		case RECORD_SCHEDULE:
+			Status = Replay_Check_Running(Index, pEntry);
+			pPrevious = gpCurrentRunningTask;
+			Schedule();
+			Schedules++;
+			if(gpCurrentRunningTask != pPrevious)
+			{
+				Switches++;
+				if(gVerbose)
+				{
+					printf("%u: task %u -> task %u\n", (unsigned)gTickCount, Replay_Id(pPrevious), Replay_Id(gpCurrentRunningTask));
+				}
+			}
+			break;
+
+		case RECORD_DELAY:
+			Status = Replay_Check_Running(Index, pEntry);
+			Task_Delay(pEntry->arg);
+			break;
+
+		case RECORD_BLOCK:
+			Status = Replay_Check_Running(Index, pEntry);
+			if(pEntry->aux != 0U)
+			{
+				Sched_Job_Complete(gpCurrentRunningTask);
+			}
+			Task_Block(pEntry->arg);
+			break;
+
+		case RECORD_WAKEUP:
+			if(gVerbose && (pEntry->aux != 0U))
+			{
+				printf("%u: exception %u wakes task %u\n", (unsigned)gTickCount, (unsigned)pEntry->aux, (unsigned)pEntry->task_id);
+			}
+			Task_Unblock(Replay_Task(pEntry->task_id));
+			break;
+
+		case RECORD_THROTTLE:
+			/* Same as Budget_Charge() */
+			Status = Replay_Check_Running(Index, pEntry);
+			gpCurrentRunningTask->current_state = TASK_THROTTLED_STATE;
+			gpCurrentRunningTask->block_count = pEntry->arg;
+			gBlockedQueue.ENQUEUE(&(gBlockedQueue.head), gpCurrentRunningTask, ENQUEUE_SORTED);
+			break;
+
+		case RECORD_EXIT:
+			/* Same as Task_Exit(), the joiner's wakeup is logged on its own */
+			Status = Replay_Check_Running(Index, pEntry);
+			gpCurrentRunningTask->current_state = TASK_TERMINATED_STATE;
+			Sched_Job_Complete(gpCurrentRunningTask);
+			gpCurrentRunningTask->sched_lock = 0;
+			break;
+
+		case RECORD_CHECKPOINT:
+			Status = Replay_Verify(Index);
+			Checkpoints++;
+			Index += 3U * NUMBER_OF_STATIC_TASKS;
+			break;
+
+		default:
+			printf("Entry %u has an unknown type %u\n", (unsigned)Index, (unsigned)pEntry->type);
+			return REPLAY_INVALID;
+		}
+
+		if(Status != REPLAY_OK)
+		{
+			return Status;
+		}
+	}
+
+	printf("Replayed ticks %u-%u: %u Schedule() calls, %u context switches, %u checkpoints verified\n",
+	       (unsigned)StartTick, (unsigned)gTickCount, (unsigned)Schedules, (unsigned)Switches, (unsigned)Checkpoints);
+
+	return REPLAY_OK;
+}
+
+/**
+  * @brief  Loads a dump of gRecordLog and replays it.
+  * @param  argc - Number of arguments.
+  * @param  argv - The dump file name, and -v to print every context switch.
+  * @retval REPLAY_OK if the replay matched the log, REPLAY_DIVERGED if it didn't, REPLAY_INVALID
+  * 		if the dump can't be replayed.
+  */
+int main(int argc, char *argv[])
+{
+	FILE *pFile;
+	size_t Length;
+
+	if(argc < 2)
+	{
+		printf("Usage: %s record.bin [-v]\n", argv[0]);
+		return REPLAY_INVALID;
+	}
+	gVerbose = (argc > 2) && (strcmp(argv[2], "-v") == 0);
+
+	pFile = fopen(argv[1], "rb");
+	if(pFile == NULL)
+	{
+		printf("Can't open %s\n", argv[1]);
+		return REPLAY_INVALID;
+	}
+	Length = fread(&gLog, 1, sizeof(gLog), pFile);
+	fclose(pFile);
+
+	if((Length != sizeof(gLog)) || (gLog.magic != RECORD_MAGIC) || (gLog.size != RECORD_SIZE))
+	{
+		printf("%s is not a dump of gRecordLog with RECORD_SIZE %u\n", argv[1], (unsigned)RECORD_SIZE);
+		return REPLAY_INVALID;
+	}
+
+	return Replay_Run();
+}
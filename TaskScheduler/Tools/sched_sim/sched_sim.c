@@ -0,0 +1,193 @@
+/**
+ ******************************************************************************
+ * @file           : sched_sim.c
+ * @author         : Noam Yakar
+ * @brief          : Host simulation of the scheduling policies. Runs random
+ *                   periodic task sets through Schedule() and the ready/blocked
+ *                   queues, and prints the deadline-miss ratio against the load
+ *                   for the round-robin and EDF policies as CSV, with the mean
+ *                   utilisation the task sets realise with whole-tick WCETs.
+ *
+ *                   Build and run on the host, from this directory:
+ *                   gcc -O2 -I../../Inc sched_sim.c ../../Src/sched.c ../../Src/queue.c -o sched_sim -lm
+ *                   ./sched_sim > miss_ratio.csv
+ ******************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------- */
+
+#include <stdlib.h>
+#include "sched.h"
+#include "record.h"
+#include "../sched_host/sched_host.h"
+
+/* Macros ------------------------------------------------------------------- */
+
+#define SIM_TASKS                5U       /* Tasks in each task set */
+#define SIM_TASK_SETS            200U     /* Task sets per load point */
+#define SIM_HORIZON              20000U   /* Simulated ticks per task set */
+#define SIM_MIN_PERIOD           10U      /* Shortest period in ticks */
+#define SIM_MAX_PERIOD           1000U    /* Longest period in ticks */
+#define SIM_LOAD_FIRST           50U      /* First load point in percent */
+#define SIM_LOAD_LAST            120U     /* Last load point in percent */
+#define SIM_LOAD_STEP            5U       /* Load step in percent */
+
+/* Types -------------------------------------------------------------------- */
+
+/* Simulated periodic task */
+typedef struct
+{
+	TaskControlBlock_t tcb;         /*!< The kernel's view of the task */
+	uint32_t period;                /*!< Period in ticks, also used as the relative deadline */
+	uint32_t wcet;                  /*!< Execution time of each job in ticks */
+	uint32_t remaining;             /*!< Execution time left for the current job */
+	uint32_t release;               /*!< Release tick of the current job */
+	uint32_t jobs;                  /*!< Number of completed jobs */
+} SimTask_t;
+
+/* Global variables --------------------------------------------------------- */
+
+static TaskControlBlock_t gSimIdleTask;
+static SimTask_t gSimTasks[SIM_TASKS];
+
+/* Functions definitions ---------------------------------------------------- */
+
+/**
+  * @brief  Generates a random task set with the given total utilisation.
+  * @param  Utilisation - Requested total utilisation of the task set.
+  * @retval The task set's utilisation with its WCETs in whole ticks.
+  */
+static double Sim_Generate_Task_Set(double Utilisation)
+{
+	uint32_t Periods[SIM_TASKS];
+	uint32_t Wcets[SIM_TASKS];
+	double Realised = Host_Generate_Task_Set(Utilisation, SIM_TASKS, SIM_MIN_PERIOD, SIM_MAX_PERIOD, Periods, Wcets);
+
+	for(uint32_t i = 0 ; i < SIM_TASKS ; i++)
+	{
+		gSimTasks[i].period = Periods[i];
+		gSimTasks[i].wcet = Wcets[i];
+	}
+
+	return Realised;
+}
+
+/**
+  * @brief  Runs the current task set with a scheduling policy for SIM_HORIZON ticks.
+  * @param  pPolicy - Pointer to the scheduling policy.
+  * @param  pJobs - Incremented by the number of completed jobs.
+  * @param  pMisses - Incremented by the number of jobs that missed their deadline.
+  * @retval None
+  */
+static void Sim_Run(SchedPolicy_t *pPolicy, uint64_t *pJobs, uint64_t *pMisses)
+{
+	/* Reset the kernel state */
+	gpSchedPolicy = pPolicy;
+	gReadyQueue.head = NULL;
+	gpSchedPolicy->INIT();
+	gpCurrentRunningTask = NULL;
+	gBlockedQueue.head = NULL;
+	gTickCount = 0;
+
+	/* Release the first job of every task at tick 0 */
+	for(uint32_t i = 0 ; i < SIM_TASKS ; i++)
+	{
+		SimTask_t *pSim = &gSimTasks[i];
+		pSim->tcb.task_id = (TaskID_e)(TASK1 + i);
+		pSim->tcb.current_state = TASK_READY_STATE;
+		pSim->tcb.deadline_misses = 0;
+		pSim->tcb.next = NULL;
+		pSim->remaining = pSim->wcet;
+		pSim->release = 0;
+		pSim->jobs = 0;
+		Sched_Set_Deadline(&(pSim->tcb), pSim->period);
+		Sched_Ready(&(pSim->tcb), REGULAR_ENQUEUE);
+	}
+	gSimIdleTask.task_id = IDLE_TASK;
+	gSimIdleTask.current_state = TASK_READY_STATE;
+	gSimIdleTask.relative_deadline = SCHED_NO_DEADLINE;
+	Sched_Ready(&gSimIdleTask, REGULAR_ENQUEUE);
+	Schedule();
+
+	while(gTickCount < SIM_HORIZON)
+	{
+		/* The running task executes for one tick */
+		SimTask_t *pRunning = NULL;
+		if(gpCurrentRunningTask->task_id != IDLE_TASK)
+		{
+			pRunning = (SimTask_t*)gpCurrentRunningTask;
+			pRunning->remaining--;
+		}
+
+		gTickCount++;
+
+		/* The job completed, the task blocks until its next release */
+		if((pRunning != NULL) && (pRunning->remaining == 0))
+		{
+			Sched_Job_Complete(&(pRunning->tcb));
+			pRunning->jobs++;
+			pRunning->release += pRunning->period;
+			pRunning->remaining = pRunning->wcet;
+
+			if((int32_t)(pRunning->release - gTickCount) > 0)
+			{
+				pRunning->tcb.current_state = TASK_BLOCKED_STATE;
+				pRunning->tcb.block_count = pRunning->release;
+				gBlockedQueue.ENQUEUE(&(gBlockedQueue.head), &(pRunning->tcb), ENQUEUE_SORTED);
+			}
+
+			/* The next job was already released, it keeps running with the deadline of that job */
+			else
+			{
+				pRunning->tcb.absolute_deadline = pRunning->release + pRunning->period;
+				pRunning->tcb.job_done = 0;
+			}
+		}
+
+		/* Same as Unblock_Tasks() */
+		while((gBlockedQueue.head != NULL) && (gBlockedQueue.head->block_count == gTickCount))
+		{
+			TaskControlBlock_t *pTask = gBlockedQueue.DEQUEUE(&(gBlockedQueue.head), REGULAR_DEQUEUE);
+			pTask->current_state = TASK_READY_STATE;
+			Sched_Ready(pTask, ENQUEUE_WITH_REAR_IDLE_TASK);
+		}
+
+		/* Same as SysTick_Handler() pending PendSV */
+		Schedule();
+	}
+
+	for(uint32_t i = 0 ; i < SIM_TASKS ; i++)
+	{
+		*pJobs += gSimTasks[i].jobs;
+		*pMisses += gSimTasks[i].tcb.deadline_misses;
+	}
+}
+
+/**
+  * @brief  Sweeps the load and prints the deadline-miss ratio of both policies as CSV.
+  * @param  None
+  * @retval 0
+  */
+int main(void)
+{
+	printf("load_percent,realised_load_percent,rr_jobs,rr_misses,rr_miss_ratio,edf_jobs,edf_misses,edf_miss_ratio\n");
+
+	for(uint32_t Load = SIM_LOAD_FIRST ; Load <= SIM_LOAD_LAST ; Load += SIM_LOAD_STEP)
+	{
+		uint64_t RrJobs = 0, RrMisses = 0, EdfJobs = 0, EdfMisses = 0;
+		double Realised = 0.0;
+
+		for(uint32_t Set = 0 ; Set < SIM_TASK_SETS ; Set++)
+		{
+			Realised += Sim_Generate_Task_Set((double)Load / 100.0);
+			Sim_Run(&gRoundRobinPolicy, &RrJobs, &RrMisses);
+			Sim_Run(&gEdfPolicy, &EdfJobs, &EdfMisses);
+		}
+
+		printf("%u,%.2f,%llu,%llu,%.4f,%llu,%llu,%.4f\n", (unsigned)Load, (Realised * 100.0) / SIM_TASK_SETS,
+		       (unsigned long long)RrJobs, (unsigned long long)RrMisses, (double)RrMisses / (double)RrJobs,
+		       (unsigned long long)EdfJobs, (unsigned long long)EdfMisses, (double)EdfMisses / (double)EdfJobs);
+	}
+
+	return 0;
+}
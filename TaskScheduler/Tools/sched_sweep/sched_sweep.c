@@ -0,0 +1,461 @@
+/**
+ ******************************************************************************
+ * @file           : sched_sweep.c
+ * @author         : Noam Yakar
+ * @brief          : Parallel host sweep of synthetic task sets through the
+ *                   scheduler core. Every configuration - scheduling policy,
+ *                   utilisation, share of sporadic tasks, execution time
+ *                   distribution and blocking probability - is run with
+ *                   several random task sets through Schedule(),
+ *                   Task_Delay(), Task_Block(), Unblock_Tasks() and the
+ *                   ready/blocked queues. The configurations are spread
+ *                   over worker processes, one per host core, and the
+ *                   results are printed as CSV in the order of the
+ *                   configurations, so the output doesn't depend on the
+ *                   number of workers. The task sets' utilisation with
+ *                   whole-tick WCETs is kept within HOST_UTILISATION_TOLERANCE
+ *                   of the load point, and its mean is printed with the load.
+ *
+ *                   Build and run on the host, from this directory:
+ *                   gcc -O2 -I../../Inc sched_sweep.c ../../Src/sched.c ../../Src/queue.c -o sched_sweep -lm
+ *                   ./sched_sweep [-j workers] > sweep.csv
+ ******************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------- */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "sched.h"
+#include "record.h"
+#include "../sched_host/sched_host.h"
+
+/* Macros ------------------------------------------------------------------- */
+
+#define SWEEP_MIN_TASKS          3U       /* Tasks in a task set, drawn per task set */
+#define SWEEP_MAX_TASKS          6U
+#define SWEEP_SEEDS              10U      /* Task sets per configuration */
+#define SWEEP_HORIZON            20000U   /* Simulated ticks per task set */
+#define SWEEP_MIN_PERIOD         10U      /* Shortest period in ticks */
+#define SWEEP_MAX_PERIOD         1000U    /* Longest period in ticks */
+#define SWEEP_LOAD_FIRST         50U      /* First utilisation point in percent */
+#define SWEEP_LOAD_LAST          100U     /* Last utilisation point in percent */
+#define SWEEP_LOAD_STEP          2U       /* Utilisation step in percent */
+#define SWEEP_MAX_JOBS           65536U   /* Response times kept per task set */
+
+/* Configuration axes */
+#define SWEEP_POLICIES           2U
+#define SWEEP_LOADS              ((((SWEEP_LOAD_LAST) - (SWEEP_LOAD_FIRST)) / (SWEEP_LOAD_STEP)) + 1U)
+#define SWEEP_SPORADIC_SHARES    3U
+#define SWEEP_EXEC_DISTRIBUTIONS 3U
+#define SWEEP_BLOCK_PROBABILITIES 3U
+#define SWEEP_CONFIGS            ((SWEEP_POLICIES) * (SWEEP_LOADS) * (SWEEP_SPORADIC_SHARES) * \
+                                  (SWEEP_EXEC_DISTRIBUTIONS) * (SWEEP_BLOCK_PROBABILITIES))
+
+/* The simulated tasks' IDs must not collide with the idle task's */
+_Static_assert(SWEEP_MAX_TASKS <= IDLE_TASK, "Too many simulated tasks for the task IDs");
+
+/* Types -------------------------------------------------------------------- */
+
+/* Execution time of a job */
+typedef enum
+{
+	EXEC_CONSTANT,                 /*!< Every job runs for the WCET */
+	EXEC_UNIFORM,                  /*!< Uniform between half the WCET and the WCET */
+	EXEC_EXPONENTIAL               /*!< Exponential with a mean of half the WCET, capped at the WCET */
+} SweepExec_e;
+
+/* A configuration of the sweep */
+typedef struct
+{
+	SchedPolicy_t *policy;
+	uint32_t load;                  /*!< Requested utilisation in percent, the task sets' utilisation computed with
+	                                     the WCETs and the periods is within HOST_UTILISATION_TOLERANCE of it */
+	double sporadic_share;          /*!< Probability that a task is sporadic */
+	SweepExec_e exec;
+	double block_probability;       /*!< Probability that a job blocks once, for up to a quarter of its period */
+} SweepConfig_t;
+
+/* Results of a configuration, written by a worker to the shared results array */
+typedef struct
+{
+	uint64_t jobs;
+	uint64_t misses;
+	uint64_t switches;
+	uint64_t ticks;
+	double utilisation;             /*!< Sum of the task sets' utilisations, computed with the WCETs and the periods */
+	uint32_t response_p50;          /*!< Response time percentiles, in percent of the deadline */
+	uint32_t response_p95;
+	uint32_t response_p99;
+	uint32_t response_max;
+} SweepResult_t;
+
+/* Simulated task */
+typedef struct
+{
+	TaskControlBlock_t tcb;         /*!< The kernel's view of the task */
+	uint32_t period;                /*!< Period, or minimum inter-arrival time of a sporadic task, also the relative deadline */
+	uint32_t wcet;                  /*!< Worst-case execution time of a job in ticks */
+	uint8_t sporadic;               /*!< 1 if the releases are spread over up to 1.5 periods */
+	uint32_t release;               /*!< Release tick of the current job */
+	uint32_t remaining;             /*!< Execution time left for the current job */
+	uint32_t block_at;              /*!< The job blocks when remaining reaches this value, 0 for never */
+} SweepTask_t;
+
+/* Global variables --------------------------------------------------------- */
+
+static const double gSporadicShares[SWEEP_SPORADIC_SHARES] = {0.0, 0.5, 1.0};
+static const double gBlockProbabilities[SWEEP_BLOCK_PROBABILITIES] = {0.0, 0.1, 0.3};
+static const char *gExecNames[SWEEP_EXEC_DISTRIBUTIONS] = {"constant", "uniform", "exponential"};
+
+static TaskControlBlock_t gSweepIdleTask;
+static SweepTask_t gSweepTasks[SWEEP_MAX_TASKS];
+static uint32_t gSweepTaskCount;
+static uint32_t gResponses[SWEEP_MAX_JOBS];
+static uint32_t gResponseCount;
+
+/* Functions definitions ---------------------------------------------------- */
+
+/**
+  * @brief  Decodes a configuration from its index.
+  * @param  Index - Index of the configuration.
+  * @param  pConfig - Pointer to the decoded configuration.
+  * @retval None
+  */
+static void Sweep_Config(uint32_t Index, SweepConfig_t *pConfig)
+{
+	pConfig->block_probability = gBlockProbabilities[Index % SWEEP_BLOCK_PROBABILITIES];
+	Index /= SWEEP_BLOCK_PROBABILITIES;
+	pConfig->exec = (SweepExec_e)(Index % SWEEP_EXEC_DISTRIBUTIONS);
+	Index /= SWEEP_EXEC_DISTRIBUTIONS;
+	pConfig->sporadic_share = gSporadicShares[Index % SWEEP_SPORADIC_SHARES];
+	Index /= SWEEP_SPORADIC_SHARES;
+	pConfig->load = SWEEP_LOAD_FIRST + ((Index % SWEEP_LOADS) * SWEEP_LOAD_STEP);
+	Index /= SWEEP_LOADS;
+	pConfig->policy = (Index == 0U) ? &gRoundRobinPolicy : &gEdfPolicy;
+}
+
+/**
+  * @brief  Generates a random task set with the configuration's utilisation.
+  * @param  pConfig - Pointer to the configuration.
+  * @retval The task set's utilisation with its WCETs in whole ticks.
+  */
+static double Sweep_Generate_Task_Set(const SweepConfig_t *pConfig)
+{
+	uint32_t Periods[SWEEP_MAX_TASKS];
+	uint32_t Wcets[SWEEP_MAX_TASKS];
+	double Realised;
+
+	gSweepTaskCount = SWEEP_MIN_TASKS + (uint32_t)(Host_Random() * (SWEEP_MAX_TASKS - SWEEP_MIN_TASKS + 1U));
+	Realised = Host_Generate_Task_Set((double)pConfig->load / 100.0, gSweepTaskCount, SWEEP_MIN_PERIOD, SWEEP_MAX_PERIOD,
+	                                  Periods, Wcets);
+
+	for(uint32_t i = 0 ; i < gSweepTaskCount ; i++)
+	{
+		gSweepTasks[i].period = Periods[i];
+		gSweepTasks[i].wcet = Wcets[i];
+		gSweepTasks[i].sporadic = (Host_Random() < pConfig->sporadic_share);
+	}
+
+	return Realised;
+}
+
+/**
+  * @brief  Draws the execution time and the blocking point of a new job.
+  * @param  pConfig - Pointer to the configuration.
+  * @param  pSweep - Pointer to the task.
+  * @retval None
+  */
+static void Sweep_New_Job(const SweepConfig_t *pConfig, SweepTask_t *pSweep)
+{
+	uint32_t Exec = pSweep->wcet;
+
+	if(pConfig->exec == EXEC_UNIFORM)
+	{
+		Exec = (pSweep->wcet / 2U) + (uint32_t)(Host_Random() * ((pSweep->wcet - (pSweep->wcet / 2U)) + 1U));
+	}
+	else if(pConfig->exec == EXEC_EXPONENTIAL)
+	{
+		Exec = (uint32_t)lround(-log(1.0 - Host_Random()) * ((double)pSweep->wcet / 2.0));
+	}
+	if(Exec > pSweep->wcet)
+	{
+		Exec = pSweep->wcet;
+	}
+	if(Exec == 0U)
+	{
+		Exec = 1U;
+	}
+	pSweep->remaining = Exec;
+
+	/* The job blocks once, after part of its execution */
+	pSweep->block_at = 0;
+	if((Exec > 1U) && (Host_Random() < pConfig->block_probability))
+	{
+		pSweep->block_at = 1U + (uint32_t)(Host_Random() * (Exec - 1U));
+	}
+}
+
+/**
+  * @brief  Tick count of the release that follows the current one.
+  * @param  pSweep - Pointer to the task.
+  * @retval Release tick.
+  */
+static uint32_t Sweep_Next_Release(SweepTask_t *pSweep)
+{
+	uint32_t Gap = pSweep->period;
+
+	if(pSweep->sporadic)
+	{
+		Gap += (uint32_t)(Host_Random() * ((pSweep->period / 2U) + 1U));
+	}
+	return pSweep->release + Gap;
+}
+
+/**
+  * @brief  Runs the context-switch pended by a task or by the tick, counting the switches.
+  * @param  pSwitches - Incremented when another task is scheduled.
+  * @retval None
+  */
+static void Sweep_Schedule(uint64_t *pSwitches)
+{
+	TaskControlBlock_t *pPrevious = gpCurrentRunningTask;
+
+	gHostSwitchPending = 0;
+	Schedule();
+	if(gpCurrentRunningTask != pPrevious)
+	{
+		(*pSwitches)++;
+	}
+}
+
+/**
+  * @brief  Compares two response times, for qsort().
+  * @param  pA - Pointer to the first response time.
+  * @param  pB - Pointer to the second response time.
+  * @retval Negative, zero or positive.
+  */
+static int Sweep_Compare(const void *pA, const void *pB)
+{
+	uint32_t A = *(const uint32_t*)pA;
+	uint32_t B = *(const uint32_t*)pB;
+
+	return (A > B) - (A < B);
+}
+
+/**
+  * @brief  Runs a task set of a configuration for SWEEP_HORIZON ticks.
+  * @param  pConfig - Pointer to the configuration.
+  * @param  pResult - Pointer to the results, the jobs, misses, switches and ticks are added.
+  * @retval None
+  */
+static void Sweep_Run(const SweepConfig_t *pConfig, SweepResult_t *pResult)
+{
+	/* Reset the kernel state */
+	gpSchedPolicy = pConfig->policy;
+	gReadyQueue.head = NULL;
+	gpSchedPolicy->INIT();
+	gpCurrentRunningTask = NULL;
+	gBlockedQueue.head = NULL;
+	gTickCount = 0;
+
+	/* Release the first job of every task at tick 0 */
+	for(uint32_t i = 0 ; i < gSweepTaskCount ; i++)
+	{
+		SweepTask_t *pSweep = &gSweepTasks[i];
+		memset(&(pSweep->tcb), 0, sizeof(pSweep->tcb));
+		pSweep->tcb.task_id = (TaskID_e)(TASK1 + i);
+		pSweep->tcb.current_state = TASK_READY_STATE;
+		pSweep->release = 0;
+		Sweep_New_Job(pConfig, pSweep);
+		Sched_Set_Deadline(&(pSweep->tcb), pSweep->period);
+		Sched_Ready(&(pSweep->tcb), REGULAR_ENQUEUE);
+	}
+	memset(&gSweepIdleTask, 0, sizeof(gSweepIdleTask));
+	gSweepIdleTask.task_id = IDLE_TASK;
+	gSweepIdleTask.current_state = TASK_READY_STATE;
+	gSweepIdleTask.relative_deadline = SCHED_NO_DEADLINE;
+	Sched_Ready(&gSweepIdleTask, REGULAR_ENQUEUE);
+	Sweep_Schedule(&(pResult->switches));
+
+	while(gTickCount < SWEEP_HORIZON)
+	{
+		/* The running task executes for one tick */
+		SweepTask_t *pRunning = NULL;
+		if(gpCurrentRunningTask->task_id != IDLE_TASK)
+		{
+			pRunning = (SweepTask_t*)gpCurrentRunningTask;
+			pRunning->remaining--;
+		}
+
+		Increment_Global_Tick_Count();
+
+		if(pRunning != NULL)
+		{
+			/* The job completed, record its response time and delay the task until its next release */
+			if(pRunning->remaining == 0U)
+			{
+				uint32_t Response = gTickCount - pRunning->release;
+
+				pResult->jobs++;
+				if(Response > pRunning->period)
+				{
+					pResult->misses++;
+				}
+				if(gResponseCount < SWEEP_MAX_JOBS)
+				{
+					gResponses[gResponseCount++] = (Response * 100U) / pRunning->period;
+				}
+
+				pRunning->release = Sweep_Next_Release(pRunning);
+				Sweep_New_Job(pConfig, pRunning);
+
+				if((int32_t)(pRunning->release - gTickCount) > 0)
+				{
+					Task_Delay(pRunning->release - gTickCount);
+				}
+
+				/* The next job was already released, it keeps running with the deadline of that job */
+				else
+				{
+					pRunning->tcb.absolute_deadline = pRunning->release + pRunning->period;
+				}
+			}
+
+			/* The job blocks, waiting for I/O, for up to a quarter of its period. It keeps its deadline */
+			else if(pRunning->remaining == pRunning->block_at)
+			{
+				pRunning->block_at = 0;
+				Task_Block(1U + (uint32_t)(Host_Random() * (pRunning->period / 4U)));
+			}
+
+			if(gHostSwitchPending)
+			{
+				Sweep_Schedule(&(pResult->switches));
+			}
+		}
+
+		/* Same as SysTick_Handler() */
+		Unblock_Tasks();
+		Sweep_Schedule(&(pResult->switches));
+	}
+
+	pResult->ticks += SWEEP_HORIZON;
+}
+
+/**
+  * @brief  Runs all the task sets of a configuration.
+  * @param  Index - Index of the configuration.
+  * @param  pResult - Pointer to the configuration's results.
+  * @retval None
+  */
+static void Sweep_Config_Run(uint32_t Index, SweepResult_t *pResult)
+{
+	SweepConfig_t Config;
+
+	Sweep_Config(Index, &Config);
+	memset(pResult, 0, sizeof(*pResult));
+	gResponseCount = 0;
+
+	for(uint32_t Seed = 0 ; Seed < SWEEP_SEEDS ; Seed++)
+	{
+		/* The task sets depend on the load and the seed only, so every policy and workload
+		 * variant of a load point runs the same periods and WCETs */
+		Host_Seed(0x9E3779B9U ^ ((Config.load * 7919U) + (Seed * 104729U) + 1U));
+		pResult->utilisation += Sweep_Generate_Task_Set(&Config);
+		Host_Seed(gHostRandomState ^ ((Index + 1U) * 2654435761U));
+		Sweep_Run(&Config, pResult);
+	}
+
+	qsort(gResponses, gResponseCount, sizeof(gResponses[0]), Sweep_Compare);
+	if(gResponseCount != 0U)
+	{
+		pResult->response_p50 = gResponses[(gResponseCount * 50U) / 100U];
+		pResult->response_p95 = gResponses[(gResponseCount * 95U) / 100U];
+		pResult->response_p99 = gResponses[(gResponseCount * 99U) / 100U];
+		pResult->response_max = gResponses[gResponseCount - 1U];
+	}
+}
+
+/**
+  * @brief  Runs the configurations over worker processes and prints the results as CSV.
+  * @param  argc - Number of arguments.
+  * @param  argv - Optional "-j workers", the default is the number of host cores.
+  * @retval 0 on success, 1 if a worker failed.
+  */
+int main(int argc, char *argv[])
+{
+	long Workers = sysconf(_SC_NPROCESSORS_ONLN);
+	SweepResult_t *pResults;
+	int Status = 0;
+
+	if((argc > 2) && (strcmp(argv[1], "-j") == 0))
+	{
+		Workers = strtol(argv[2], NULL, 0);
+	}
+	if(Workers < 1)
+	{
+		Workers = 1;
+	}
+
+	/* The results array is shared with the workers */
+	pResults = mmap(NULL, sizeof(SweepResult_t) * SWEEP_CONFIGS, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if(pResults == MAP_FAILED)
+	{
+		perror("mmap");
+		return 1;
+	}
+
+	/* Worker w runs the configurations w, w + Workers, ... */
+	for(long w = 0 ; w < Workers ; w++)
+	{
+		pid_t Pid = fork();
+		if(Pid == 0)
+		{
+			for(uint32_t i = (uint32_t)w ; i < SWEEP_CONFIGS ; i += (uint32_t)Workers)
+			{
+				Sweep_Config_Run(i, &pResults[i]);
+			}
+			_exit(0);
+		}
+		if(Pid < 0)
+		{
+			perror("fork");
+			return 1;
+		}
+	}
+	for(long w = 0 ; w < Workers ; w++)
+	{
+		int WorkerStatus;
+		if((wait(&WorkerStatus) < 0) || !WIFEXITED(WorkerStatus) || (WEXITSTATUS(WorkerStatus) != 0))
+		{
+			Status = 1;
+		}
+	}
+
+	printf("policy,load_percent,realised_load_percent,sporadic_share,exec,block_probability,jobs,misses,miss_ratio,"
+	       "response_p50,response_p95,response_p99,response_max,switches,switches_per_1000_ticks\n");
+	for(uint32_t i = 0 ; i < SWEEP_CONFIGS ; i++)
+	{
+		SweepConfig_t Config;
+		SweepResult_t *pResult = &pResults[i];
+
+		Sweep_Config(i, &Config);
+		printf("%s,%u,%.2f,%.2f,%s,%.2f,%llu,%llu,%.4f,%u,%u,%u,%u,%llu,%.1f\n",
+		       (Config.policy == &gEdfPolicy) ? "edf" : "rr", (unsigned)Config.load,
+		       (pResult->utilisation * 100.0) / SWEEP_SEEDS, Config.sporadic_share,
+		       gExecNames[Config.exec], Config.block_probability, (unsigned long long)pResult->jobs,
+		       (unsigned long long)pResult->misses,
+		       (pResult->jobs != 0U) ? ((double)pResult->misses / (double)pResult->jobs) : 0.0,
+		       (unsigned)pResult->response_p50, (unsigned)pResult->response_p95, (unsigned)pResult->response_p99,
+		       (unsigned)pResult->response_max, (unsigned long long)pResult->switches,
+		       (pResult->ticks != 0U) ? (((double)pResult->switches * 1000.0) / (double)pResult->ticks) : 0.0);
+	}
+
+	munmap(pResults, sizeof(SweepResult_t) * SWEEP_CONFIGS);
+	return Status;
+}
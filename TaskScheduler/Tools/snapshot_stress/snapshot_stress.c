@@ -0,0 +1,257 @@
+/**
+ ******************************************************************************
+ * @file           : snapshot_stress.c
+ * @author         : Noam Yakar
+ * @brief          : Host stress test of the seqlock-protected snapshots. A
+ *                   writer thread publishes records as fast as it can while
+ *                   reader threads copy them and verify that every copy is a
+ *                   record the writer published in one piece. The same run is
+ *                   repeated with a mutex around the copies, the host's
+ *                   counterpart of the critical-section approach, and the
+ *                   average cost of a read is printed for both.
+ *
+ *                   Build and run on the host, from this directory:
+ *                   gcc -O2 -pthread -I../../Inc snapshot_stress.c ../../Src/snapshot.c -o snapshot_stress
+ *                   ./snapshot_stress [readers] [seconds]
+ ******************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------- */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "snapshot.h"
+
+/* Macros ------------------------------------------------------------------- */
+
+#define STRESS_WORDS             64U       /* Words of a record, large enough for copies to be preempted */
+#define STRESS_MAX_READERS       16U
+#define STRESS_DEFAULT_READERS   3U
+#define STRESS_DEFAULT_SECONDS   5U
+
+/* Types -------------------------------------------------------------------- */
+
+/* The published record. Every word is derived from the record's sequence number, so a record
+ * mixing two updates is detected */
+typedef struct
+{
+	uint32_t words[STRESS_WORDS];
+} StressRecord_t;
+
+/* Protection of the shared record */
+typedef enum
+{
+	STRESS_SNAPSHOT,
+	STRESS_MUTEX
+} StressMode_e;
+
+/* Statistics of a reader thread */
+typedef struct
+{
+	pthread_t thread;
+	uint64_t reads;
+	uint64_t retries;
+	uint64_t torn;
+	uint64_t nanoseconds;
+} StressReader_t;
+
+/* Global variables --------------------------------------------------------- */
+
+SNAPSHOT_STORAGE(gSnapshotStorage, sizeof(StressRecord_t));
+static Snapshot_t gSnapshot;
+static StressRecord_t gMutexRecord;
+static pthread_mutex_t gMutex = PTHREAD_MUTEX_INITIALIZER;
+static StressMode_e gMode;
+static volatile int gStop;
+static uint64_t gWrites;
+
+/* Functions definitions ---------------------------------------------------- */
+
+/**
+  * @brief  Reads the monotonic clock.
+  * @param  None
+  * @retval Time in nanoseconds.
+  */
+static uint64_t Stress_Now(void)
+{
+	struct timespec Now;
+
+	clock_gettime(CLOCK_MONOTONIC, &Now);
+	return ((uint64_t)Now.tv_sec * 1000000000ULL) + (uint64_t)Now.tv_nsec;
+}
+
+/**
+  * @brief  Builds the record of a sequence number.
+  * @param  pRecord - Pointer to the record.
+  * @param  Sequence - The record's sequence number.
+  * @retval None
+  */
+static void Stress_Fill(StressRecord_t *pRecord, uint32_t Sequence)
+{
+	for(uint32_t i = 0 ; i < STRESS_WORDS ; i++)
+	{
+		pRecord->words[i] = (Sequence * 2654435761U) ^ (i * 0x9E3779B9U);
+	}
+}
+
+/**
+  * @brief  Checks that a record was published in one piece.
+  * @param  pRecord - Pointer to the record.
+  * @retval 1 if the record is consistent, 0 if it's torn.
+  */
+static int Stress_Check(const StressRecord_t *pRecord)
+{
+	StressRecord_t Expected;
+
+	Stress_Fill(&Expected, pRecord->words[0] * 244002641U);  /* 244002641 * 2654435761 == 1 mod 2^32 */
+	return memcmp(&Expected, pRecord, sizeof(Expected)) == 0;
+}
+
+/**
+  * @brief  Writer thread. Publishes records with increasing sequence numbers until stopped.
+  * @param  pArg - Unused.
+  * @retval NULL
+  */
+static void *Stress_Writer(void *pArg)
+{
+	StressRecord_t Record;
+	uint32_t Sequence = 0;
+
+	(void)pArg;
+	while(!gStop)
+	{
+		Stress_Fill(&Record, ++Sequence);
+		if(gMode == STRESS_SNAPSHOT)
+		{
+			Snapshot_Write(&gSnapshot, &Record);
+		}
+		else
+		{
+			pthread_mutex_lock(&gMutex);
+			gMutexRecord = Record;
+			pthread_mutex_unlock(&gMutex);
+		}
+	}
+	gWrites = Sequence;
+	return NULL;
+}
+
+/**
+  * @brief  Reader thread. Copies and verifies records until stopped.
+  * @param  pArg - Pointer to the reader's statistics.
+  * @retval NULL
+  */
+static void *Stress_Reader(void *pArg)
+{
+	StressReader_t *pReader = (StressReader_t*)pArg;
+	StressRecord_t Record;
+	uint64_t Start;
+
+	while(!gStop)
+	{
+		Start = Stress_Now();
+		if(gMode == STRESS_SNAPSHOT)
+		{
+			pReader->retries += Snapshot_Read(&gSnapshot, &Record);
+		}
+		else
+		{
+			pthread_mutex_lock(&gMutex);
+			Record = gMutexRecord;
+			pthread_mutex_unlock(&gMutex);
+		}
+		pReader->nanoseconds += Stress_Now() - Start;
+		pReader->reads++;
+
+		if(!Stress_Check(&Record))
+		{
+			pReader->torn++;
+		}
+	}
+	return NULL;
+}
+
+/**
+  * @brief  Runs the writer and the readers for a number of seconds and prints the results.
+  * @param  Mode - Protection of the shared record.
+  * @param  Readers - Number of reader threads.
+  * @param  Seconds - Duration of the run.
+  * @retval Number of torn reads.
+  */
+static uint64_t Stress_Run(StressMode_e Mode, uint32_t Readers, uint32_t Seconds)
+{
+	static StressReader_t Reader[STRESS_MAX_READERS];
+	StressRecord_t Initial;
+	pthread_t Writer;
+	uint64_t Reads = 0;
+	uint64_t Retries = 0;
+	uint64_t Torn = 0;
+	uint64_t Nanoseconds = 0;
+
+	Stress_Fill(&Initial, 0);
+	Snapshot_Init(&gSnapshot, gSnapshotStorage, sizeof(StressRecord_t), &Initial);
+	gMutexRecord = Initial;
+	gMode = Mode;
+	gStop = 0;
+	memset(Reader, 0, sizeof(Reader));
+
+	pthread_create(&Writer, NULL, Stress_Writer, NULL);
+	for(uint32_t i = 0 ; i < Readers ; i++)
+	{
+		pthread_create(&Reader[i].thread, NULL, Stress_Reader, &Reader[i]);
+	}
+
+	struct timespec Duration = {(time_t)Seconds, 0};
+	nanosleep(&Duration, NULL);
+	gStop = 1;
+
+	pthread_join(Writer, NULL);
+	for(uint32_t i = 0 ; i < Readers ; i++)
+	{
+		pthread_join(Reader[i].thread, NULL);
+		Reads += Reader[i].reads;
+		Retries += Reader[i].retries;
+		Torn += Reader[i].torn;
+		Nanoseconds += Reader[i].nanoseconds;
+	}
+
+	printf("%-8s writes %llu reads %llu retries %llu torn %llu avg read %.1f ns\n",
+	       (Mode == STRESS_SNAPSHOT) ? "snapshot" : "mutex", (unsigned long long)gWrites,
+	       (unsigned long long)Reads, (unsigned long long)Retries, (unsigned long long)Torn,
+	       (Reads != 0) ? ((double)Nanoseconds / (double)Reads) : 0.0);
+
+	return Torn;
+}
+
+/**
+  * @brief  Program entry point.
+  * @param  argc - Number of arguments.
+  * @param  argv - Optional number of readers and duration in seconds.
+  * @retval 0 if no torn read was seen, 1 otherwise.
+  */
+int main(int argc, char *argv[])
+{
+	uint32_t Readers = STRESS_DEFAULT_READERS;
+	uint32_t Seconds = STRESS_DEFAULT_SECONDS;
+	uint64_t Torn;
+
+	if(argc > 1)
+	{
+		Readers = (uint32_t)strtoul(argv[1], NULL, 0);
+	}
+	if(argc > 2)
+	{
+		Seconds = (uint32_t)strtoul(argv[2], NULL, 0);
+	}
+	if((Readers == 0U) || (Readers > STRESS_MAX_READERS))
+	{
+		Readers = STRESS_DEFAULT_READERS;
+	}
+
+	Torn = Stress_Run(STRESS_SNAPSHOT, Readers, Seconds);
+	Torn += Stress_Run(STRESS_MUTEX, Readers, Seconds);
+
+	return (Torn == 0U) ? 0 : 1;
+}
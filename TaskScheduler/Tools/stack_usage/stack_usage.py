@@ -0,0 +1,427 @@
+#!/usr/bin/env python3
+"""
+******************************************************************************
+ @file           : stack_usage.py
+ @author         : Noam Yakar
+ @brief          : Worst-case stack sizing tool. Combines the -fstack-usage
+                   (.su) outputs with the call graph disassembled in
+                   TaskScheduler.list, computes the worst-case stack depth of
+                   each task entry point including the exception frame and the
+                   R4-R11 frame stacked by PendSV_Handler, and generates
+                   Inc/stack_sizes.h, or checks the sizes in it.
+
+                   The tasks' entry points and stack size macros are read from
+                   the TASK_TABLE of Inc/task_config.h, with its benchmark
+                   substitutions resolved for the build's -D options.
+
+                   Used by the stack-sizes and stack-check targets in
+                   makefile.targets, from the Debug directory:
+                   python3 ../Tools/stack_usage/stack_usage.py --list TaskScheduler.list
+                       --su-dir . --config ../Tools/stack_usage/stack_config.txt
+                       --tasks ../Inc/task_config.h [-D NAME=VALUE ...]
+                       --header ../Inc/stack_sizes.h (--generate | --check)
+******************************************************************************
+"""
+
+import argparse
+import glob
+import os
+import re
+import sys
+
+# Cortex-M4 exception entry: basic frame of R0-R3, R12, LR, PC, xPSR plus up to 4 bytes of
+# alignment padding. With the FPU enabled the extended frame adds S0-S15 and FPSCR (+ reserved).
+EXC_FRAME_BASIC = 8 * 4 + 4
+EXC_FRAME_FPU_EXTRA = 18 * 4
+
+# PendSV_Handler stores R4-R11 on the task's stack (software frame, SF2). With the FPU enabled
+# it also stores the task's EXC_RETURN and S16-S31.
+PENDSV_SW_FRAME = 8 * 4
+PENDSV_SW_FRAME_FPU_EXTRA = (1 + 16) * 4
+
+# Stacks are 8-byte aligned (AAPCS)
+STACK_ALIGN = 8
+
+FUNC_RE = re.compile(r'^([0-9a-f]{8}) <([^>]+)>:$')
+INSN_RE = re.compile(r'^\s*([0-9a-f]+):\t[0-9a-f ]+\t(\S+)\s*(.*)$')
+TARGET_RE = re.compile(r'^[0-9a-f]+ <([^>+]+)(\+0x[0-9a-f]+)?>')
+PUSH_RE = re.compile(r'^\{([^}]*)\}')
+SUB_SP_RE = re.compile(r'^sp, (?:sp, )?#(\d+)')
+DIRECTIVE_RE = re.compile(r'^\s*#\s*(\w+)\s*(.*)$')
+TASK_RE = re.compile(r'\bTASK\(\s*(\w+)\s*,\s*(\w+)\s*,\s*(\w+)\s*,')
+
+
+def parse_su(su_dir):
+	"""Returns {function: stack bytes} from all the .su files under su_dir."""
+	usage = {}
+	for path in glob.glob(os.path.join(su_dir, '**', '*.su'), recursive=True):
+		with open(path) as su_file:
+			for line in su_file:
+				fields = line.rstrip('\n').split('\t')
+				if len(fields) < 2:
+					continue
+				name = fields[0].split(':')[-1]
+				usage[name] = max(usage.get(name, 0), int(fields[1]))
+	return usage
+
+
+def count_registers(register_list):
+	"""Counts the registers of a push/vpush list such as 'r4, r5, r7, lr' or 'd8-d9'."""
+	count = 0
+	for item in register_list.split(','):
+		item = item.strip()
+		if '-' in item:
+			first, last = item.split('-')
+			count += int(last[1:]) - int(first[1:]) + 1
+		elif item:
+			count += 1
+	return count
+
+
+def parse_list(list_path):
+	"""Returns the call graph, indirect callers and prologue-estimated frames from the .list file."""
+	calls = {}
+	indirect = set()
+	estimated = {}
+	current = None
+	with open(list_path, errors='replace') as list_file:
+		for line in list_file:
+			line = line.rstrip('\n')
+			match = FUNC_RE.match(line)
+			if match:
+				current = match.group(2)
+				calls.setdefault(current, set())
+				estimated[current] = 0
+				continue
+			match = INSN_RE.match(line)
+			if not match or current is None:
+				continue
+			mnemonic, operands = match.group(2), match.group(3)
+
+			# Estimate the frame of functions without a .su entry (C library) from their prologue
+			if mnemonic in ('push', 'push.w', 'stmdb') and (mnemonic != 'stmdb' or operands.startswith('sp!')):
+				regs = PUSH_RE.search(operands.replace('sp!, ', ''))
+				if regs:
+					estimated[current] += 4 * count_registers(regs.group(1))
+			elif mnemonic == 'vpush':
+				regs = PUSH_RE.search(operands)
+				if regs:
+					size = 8 if regs.group(1).strip().startswith('d') else 4
+					estimated[current] += size * count_registers(regs.group(1))
+			elif mnemonic in ('sub', 'sub.w', 'subw'):
+				sub = SUB_SP_RE.match(operands)
+				if sub:
+					estimated[current] += int(sub.group(1))
+
+			# Direct calls, and tail calls to the start of another function
+			if mnemonic in ('bl', 'blx', 'b.w', 'b.n', 'b'):
+				target = TARGET_RE.match(operands)
+				if target:
+					if mnemonic in ('bl', 'blx') or (target.group(2) is None and target.group(1) != current):
+						calls[current].add(target.group(1))
+				elif mnemonic == 'blx':
+					indirect.add(current)
+
+			# Indirect calls through a register
+			elif mnemonic == 'bx' and not operands.startswith('lr'):
+				indirect.add(current)
+	return calls, indirect, estimated
+
+
+def eval_condition(expression, macros):
+	"""Evaluates the expression of a #if or #elif with the macros defined so far, undefined
+	identifiers are 0 like in C."""
+	expression = re.sub(r'defined\s*\(\s*(\w+)\s*\)|defined\s+(\w+)',
+	                    lambda match: '1' if (match.group(1) or match.group(2)) in macros else '0', expression)
+	for _ in range(16):
+		expanded = re.sub(r'\b[A-Za-z_]\w*\b', lambda match: macros.get(match.group(0), '0'), expression)
+		if expanded == expression:
+			break
+		expression = expanded
+	expression = re.sub(r'\b(\d+)[uUlL]+\b', r'\1', expression)
+	expression = expression.replace('&&', ' and ').replace('||', ' or ')
+	expression = re.sub(r'!(?!=)', ' not ', expression)
+	return bool(eval(expression, {'__builtins__': {}}))
+
+
+def parse_tasks(header_path, defines):
+	"""Returns [(entry point, stack size macro)] of the TASK_TABLE in header_path. The header's
+	object-like macros and conditionals are evaluated, starting from the -D defines, so the
+	benchmark substitutions of the entry points are resolved."""
+	macros = dict(defines)
+	stack = []
+	active = True
+	table = ''
+	with open(header_path) as header_file:
+		lines = header_file.read().replace('\\\n', ' ').split('\n')
+	for line in lines:
+		match = DIRECTIVE_RE.match(line)
+		if not match:
+			continue
+		directive, rest = match.group(1), re.sub(r'/\*.*?\*/', '', match.group(2)).strip()
+		if directive in ('if', 'ifdef', 'ifndef'):
+			if directive == 'ifdef':
+				taken = rest.split()[0] in macros
+			elif directive == 'ifndef':
+				taken = rest.split()[0] not in macros
+			else:
+				taken = active and eval_condition(rest, macros)
+			stack.append((active, taken))
+			active = active and taken
+		elif directive == 'elif':
+			outer, done = stack[-1]
+			taken = outer and not done and eval_condition(rest, macros)
+			stack[-1] = (outer, done or taken)
+			active = taken
+		elif directive == 'else':
+			outer, done = stack[-1]
+			stack[-1] = (outer, True)
+			active = outer and not done
+		elif directive == 'endif':
+			active = stack.pop()[0]
+		elif active and directive == 'error':
+			raise RuntimeError('%s: #error %s' % (header_path, rest))
+		elif active and directive == 'define':
+			fields = rest.split(None, 1)
+			if fields[0].startswith('TASK_TABLE('):
+				table = rest
+			elif '(' not in fields[0]:
+				macros[fields[0]] = fields[1] if len(fields) > 1 else '1'
+
+	tasks = []
+	for match in TASK_RE.finditer(table):
+		entry, size_macro = match.group(2), match.group(3)
+		for _ in range(16):
+			entry = macros.get(entry, entry)
+		tasks.append((entry, size_macro))
+	if not tasks:
+		raise RuntimeError('%s: no TASK_TABLE found' % header_path)
+	return tasks
+
+
+def parse_config(config_path):
+	"""Reads the task entry points, indirect call targets and fixed sizes from the config file."""
+	config = {'tasks': [], 'msp': [], 'handlers': {}, 'indirect': {}, 'fixed': {}, 'margin': 0, 'minimum': 0, 'fpu': 0, 'unknown': 256}
+	with open(config_path) as config_file:
+		for line in config_file:
+			fields = line.split('#')[0].split()
+			if not fields:
+				continue
+			keyword = fields[0]
+			if keyword == 'task':
+				config['tasks'].append((fields[1], fields[2]))
+			elif keyword == 'msp':
+				config['msp'].extend(fields[1:])
+			elif keyword == 'handler':
+				config['handlers'].setdefault(int(fields[1]), []).extend(fields[2:])
+			elif keyword == 'indirect':
+				config['indirect'].setdefault(fields[1], set()).update(fields[2:])
+			elif keyword == 'fixed':
+				config['fixed'][fields[1]] = int(fields[2])
+			elif keyword in ('margin', 'minimum', 'fpu', 'unknown'):
+				config[keyword] = int(fields[1])
+	return config
+
+
+class StackAnalyzer:
+	"""Computes the worst-case stack depth of a function over the call graph."""
+
+	def __init__(self, usage, calls, indirect, estimated, config):
+		self.usage = usage
+		self.calls = calls
+		self.indirect = indirect
+		self.estimated = estimated
+		self.config = config
+		self.depth = {}
+		self.warnings = set()
+
+	def frame(self, name):
+		if name in self.config['fixed']:
+			return self.config['fixed'][name]
+		if name in self.usage:
+			return self.usage[name]
+		if name in self.estimated:
+			self.warnings.add('%s: no .su entry, frame estimated from its prologue' % name)
+			return self.estimated[name]
+		self.warnings.add('%s: unknown function, assumed %d bytes' % (name, self.config['unknown']))
+		return self.config['unknown']
+
+	def worst(self, name, path=()):
+		"""Returns (depth, call chain) of the deepest path starting at name."""
+		if name in path:
+			raise RuntimeError('recursion: ' + ' -> '.join(path + (name,)))
+		if name in self.depth:
+			return self.depth[name]
+		if name in self.config['fixed']:
+			result = (self.config['fixed'][name], [name])
+			self.depth[name] = result
+			return result
+
+		callees = set(self.calls.get(name, set()))
+		best = (0, [])
+		if name in self.indirect:
+			if name not in self.config['indirect']:
+				self.warnings.add('%s: indirect call with no targets in the config' % name)
+			elif not self.config['indirect'][name]:
+				# Application functions called through a pointer, assumed to take 'unknown' bytes
+				best = (self.config['unknown'], ['<indirect>'])
+			else:
+				callees |= self.config['indirect'][name]
+
+		for callee in sorted(callees):
+			callee_result = self.worst(callee, path + (name,))
+			if callee_result[0] > best[0]:
+				best = callee_result
+		result = (self.frame(name) + best[0], [name] + best[1])
+		self.depth[name] = result
+		return result
+
+
+def align(size):
+	return (size + STACK_ALIGN - 1) // STACK_ALIGN * STACK_ALIGN
+
+
+def stack_size(worst, config):
+	"""Size of a stack: the worst case plus the margin, at least the configured minimum, aligned."""
+	return align(max(worst + config['margin'], config['minimum']))
+
+
+def exception_overhead(config):
+	return EXC_FRAME_BASIC + (EXC_FRAME_FPU_EXTRA if config['fpu'] else 0)
+
+
+def compute_sizes(analyzer, config):
+	"""Returns [(macro, entry, worst, size, chain)] for every task and for the MSP stack."""
+	results = []
+	for entry, macro in config['tasks']:
+		depth, chain = analyzer.worst(entry)
+		worst = depth + exception_overhead(config) + PENDSV_SW_FRAME
+		if config['fpu']:
+			worst += PENDSV_SW_FRAME_FPU_EXTRA
+		results.append((macro, entry, worst, stack_size(worst, config), chain))
+
+	# The scheduler (MSP) stack holds main(), and the exception handlers that preempt it and each
+	# other. Handlers of equal priority don't nest, a handler preempts only the lower priorities, so
+	# the worst case stacks the deepest handler of every priority level, each with its exception
+	# frame, on top of the deepest thread mode function.
+	msp_depth, msp_chain, msp_entry = 0, [], ''
+	for entry in config['msp']:
+		depth, chain = analyzer.worst(entry)
+		if depth > msp_depth:
+			msp_depth, msp_chain, msp_entry = depth, chain, entry
+	for priority in sorted(config['handlers'], reverse=True):
+		level_depth, level_chain = 0, []
+		for entry in config['handlers'][priority]:
+			# Handlers of the benchmarks and drivers left out of the image
+			if entry not in analyzer.calls and entry not in config['fixed']:
+				continue
+			depth, chain = analyzer.worst(entry)
+			if depth > level_depth:
+				level_depth, level_chain = depth, chain
+		if level_chain:
+			msp_depth += level_depth + exception_overhead(config)
+			msp_chain = msp_chain + ['[%d] %s' % (priority, level_chain[0])] + level_chain[1:]
+	if config['handlers']:
+		msp_entry += ' + handlers'
+	results.append(('STACK_SIZE_SCHEDULER', msp_entry, msp_depth, stack_size(msp_depth, config), msp_chain))
+	return results
+
+
+def read_header(header_path):
+	sizes = {}
+	with open(header_path) as header_file:
+		for line in header_file:
+			match = re.match(r'#define\s+(STACK_SIZE_\w+)\s+(\d+)U?', line)
+			if match:
+				sizes[match.group(1)] = int(match.group(2))
+	return sizes
+
+
+def write_header(header_path, results):
+	lines = [
+		'/**',
+		' ******************************************************************************',
+		' * @file           : stack_sizes.h',
+		' * @author         : Generated by Tools/stack_usage/stack_usage.py',
+		' * @brief          : Worst-case stack sizes of the tasks and of the scheduler',
+		' *                   (MSP) stack. Do not edit, regenerate with "make stack-sizes"',
+		' *                   from the Debug directory.',
+		' ******************************************************************************',
+		'*/',
+		'',
+		'/* Define to prevent recursive inclusion -------------------------------------*/',
+		'',
+		'#ifndef STACK_SIZES_H_',
+		'#define STACK_SIZES_H_',
+		'',
+		'/* Macros ------------------------------------------------------------------- */',
+		'',
+	]
+	for macro, entry, worst, size, chain in results:
+		lines.append('/* %s: worst case %d bytes, %s */' % (entry, worst, ' -> '.join(chain)))
+		lines.append('#define %-28s %dU' % (macro, size))
+		lines.append('')
+	lines.append('#endif /* STACK_SIZES_H_ */')
+	with open(header_path, 'w') as header_file:
+		header_file.write('\n'.join(lines) + '\n')
+
+
+def main():
+	parser = argparse.ArgumentParser(description='Worst-case stack sizing from .su files and the call graph')
+	parser.add_argument('--list', required=True, help='objdump -S listing of the ELF (TaskScheduler.list)')
+	parser.add_argument('--su-dir', required=True, help='directory searched for .su files')
+	parser.add_argument('--config', required=True, help='handlers, indirect call targets and fixed sizes')
+	parser.add_argument('--tasks', help='header of the TASK_TABLE (task_config.h), adds its tasks')
+	parser.add_argument('-D', dest='defines', action='append', default=[], metavar='NAME[=VALUE]',
+	                    help='macro defined on the compiler command line, for the TASK_TABLE substitutions')
+	parser.add_argument('--header', required=True, help='stack sizes header')
+	parser.add_argument('--fpu', type=int, choices=(0, 1), help='overrides the fpu setting of the config')
+	mode = parser.add_mutually_exclusive_group(required=True)
+	mode.add_argument('--generate', action='store_true', help='write the header from the computed sizes')
+	mode.add_argument('--check', action='store_true', help='fail if a size in the header is too small')
+	args = parser.parse_args()
+
+	config = parse_config(args.config)
+	if args.fpu is not None:
+		config['fpu'] = args.fpu
+	if args.tasks:
+		defines = dict((define.split('=', 1) + ['1'])[:2] for define in args.defines)
+		try:
+			config['tasks'].extend(parse_tasks(args.tasks, defines))
+		except RuntimeError as error:
+			print('stack_usage: error: %s' % error, file=sys.stderr)
+			return 2
+	calls, indirect, estimated = parse_list(args.list)
+	analyzer = StackAnalyzer(parse_su(args.su_dir), calls, indirect, estimated, config)
+	try:
+		results = compute_sizes(analyzer, config)
+	except RuntimeError as error:
+		print('stack_usage: error: %s' % error, file=sys.stderr)
+		return 2
+
+	for warning in sorted(analyzer.warnings):
+		print('stack_usage: warning: %s' % warning, file=sys.stderr)
+
+	if args.generate:
+		write_header(args.header, results)
+		for macro, entry, worst, size, chain in results:
+			print('%-28s %6d bytes (worst case %d)' % (macro, size, worst))
+		return 0
+
+	configured = read_header(args.header)
+	failed = False
+	for macro, entry, worst, size, chain in results:
+		if macro not in configured:
+			print('stack_usage: error: %s missing from %s' % (macro, args.header), file=sys.stderr)
+			failed = True
+		elif configured[macro] < worst:
+			print('stack_usage: error: %s is %d bytes, %s needs %d: %s' %
+			      (macro, configured[macro], entry, worst, ' -> '.join(chain)), file=sys.stderr)
+			failed = True
+		else:
+			print('%-28s %6d bytes, worst case %d' % (macro, configured[macro], worst))
+	return 1 if failed else 0
+
+
+if __name__ == '__main__':
+	sys.exit(main())